@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sv/common.hpp"
+#include "sv/image_barriers.hpp"
 #include "sv/immediate_commands.hpp"
 
 namespace sv {
@@ -36,6 +37,10 @@ public:
                                    const Framebuffer& framebuffer,
                                    const Dependencies& deps) -> void = 0;
   virtual auto cmd_end_rendering() -> void = 0;
+  // For work recorded on the raw command buffer outside a pass, e.g.
+  // clears; passes transition their attachments and dependencies themselves.
+  virtual auto cmd_transition_image(TextureHandle, const ImageUsage&)
+    -> void = 0;
 
   virtual auto cmd_bind_viewport(const Viewport& viewport) -> void = 0;
   virtual auto cmd_bind_scissor_rect(const ScissorRect& rect) -> void = 0;
@@ -43,6 +48,15 @@ public:
   virtual auto cmd_bind_graphics_pipeline(GraphicsPipelineHandle) -> void{};
   virtual auto cmd_bind_compute_pipeline(ComputePipelineHandle) -> void{};
   virtual auto cmd_bind_depth_state(const DepthState& state) -> void = 0;
+  // Override the bound pipeline's state; only takes effect when the context
+  // has dynamic pipeline state.
+  virtual auto cmd_set_cull_mode(CullMode) -> void = 0;
+  virtual auto cmd_set_winding(WindingMode) -> void = 0;
+  virtual auto cmd_set_polygon_mode(PolygonMode) -> void = 0;
+  virtual auto cmd_set_blend_state(std::uint32_t attachment,
+                                   const ColourAttachment&) -> void = 0;
+  virtual auto cmd_set_colour_write_mask(std::uint32_t attachment,
+                                         ColourWriteMask) -> void = 0;
   virtual auto cmd_draw(std::uint32_t vertex_count,
                         std::uint32_t instance_count,
                         std::uint32_t first_vertex,
@@ -56,6 +70,21 @@ public:
                                          std::size_t indirect_buffer_offset,
                                          std::uint32_t draw_count,
                                          std::uint32_t stride) -> void = 0;
+  // Draws as many commands as the count buffer holds, up to max_draw_count,
+  // so a GPU culling pass can decide how many without a readback.
+  virtual auto cmd_draw_indexed_indirect_count(BufferHandle indirect_buffer,
+                                               std::size_t indirect_offset,
+                                               BufferHandle count_buffer,
+                                               std::size_t count_offset,
+                                               std::uint32_t max_draw_count,
+                                               std::uint32_t stride)
+    -> void = 0;
+  // One vkCmdDrawMultiIndexedEXT where the device supports it, one
+  // vkCmdDrawIndexed per draw otherwise.
+  virtual auto cmd_draw_multi_indexed(std::span<const MultiDrawIndexed>,
+                                      std::uint32_t instance_count,
+                                      std::uint32_t first_instance)
+    -> void = 0;
   virtual auto cmd_dispatch_thread_groups(const Dimensions&) -> void = 0;
 
   virtual auto cmd_push_constants(std::span<const std::byte>) -> void{};
@@ -98,11 +127,6 @@ public:
                                          std::uint32_t draw_count,
                                          std::uint32_t stride = 0) -> void = 0;
 
-       -> void = 0; virtual auto cmd_draw_indexed_indirect_count( BufferHandle
-          indirect_buffer, std::size_t indirect_buffer_offset, BufferHandle
-          count_buffer, std::size_t count_buffer_offset, std::uint32_t
-         max_draw_count, std::uint32_t stride = 0) -> void = 0;
-
           virtual auto cmd_draw_mesh_tasks(const Dimensions &threadgroup_count)
               -> void = 0;
           virtual auto cmd_draw_mesh_tasks_indirect(BufferHandle
@@ -6,16 +6,54 @@
 #include "sv/abstract_command_buffer.hpp"
 #include "sv/object_handle.hpp"
 #include "sv/object_pool.hpp"
+#include "sv/pipeline_description_cache.hpp"
+#include "sv/sampler_cache.hpp"
+
+#include <string>
 
 namespace sv {
 
 class ImmediateCommands;
+class PipelineCache;
+class IncludeCache;
+class ShaderArchive;
+class ShaderCache;
 class StagingAllocator;
 class VulkanSwapchain;
 
 struct ContextConfiguration
 {
   bool abort_on_validation_error{ false };
+  // Back the bindless set with VK_EXT_descriptor_buffer when the device
+  // supports it; descriptor pools and sets remain the fallback.
+  bool prefer_descriptor_buffer{ true };
+  // Where the VkPipelineCache blob and the compiled SPIR-V (in a shaders/
+  // subdirectory) are persisted; empty disables persistence.
+  std::string pipeline_cache_directory{ "cache" };
+  // Skip draws whose graphics pipeline is still compiling in the background
+  // instead of waiting for the compile to finish.
+  bool skip_draws_on_pending_pipelines{ false };
+  // Build graphics pipelines from cached VK_EXT_graphics_pipeline_library
+  // parts when the device supports it, and relink them with link-time
+  // optimisation in the background once the fast-linked one is in use.
+  bool prefer_graphics_pipeline_library{ true };
+  bool optimise_linked_pipelines{ true };
+  // Render graphics work with VK_EXT_shader_object instead of pipelines when
+  // the device supports it. Compute still goes through pipelines.
+  bool prefer_shader_objects{ false };
+  // Leave blending, culling, winding and polygon mode to the command buffer
+  // via VK_EXT_extended_dynamic_state3, so pipelines that only differ there
+  // share one VkPipeline.
+  bool prefer_extended_dynamic_state3{ true };
+  // Recompile shaders under shaders/ in the background when they or their
+  // includes change on disk, and swap them in at the next frame. Linux only.
+  bool hot_reload_shaders{ false };
+  // Built by the sv_shader_pack target; shaders found in it are not compiled
+  // at startup. Empty disables it.
+  std::string shader_archive{ "shaders/shaders.svpack" };
+  // Name Vulkan objects through VK_EXT_debug_utils for validation messages
+  // and debuggers. Has no effect in builds without SV_DEBUG_NAMES.
+  bool debug_names{ true };
 };
 
 struct IContext
@@ -34,8 +72,10 @@ struct IContext
   [[nodiscard]] virtual auto get_present_queue_family() const
     -> std::uint32_t = 0;
   [[nodiscard]] virtual auto get_surface() const -> VkSurfaceKHR = 0;
+  [[nodiscard]] virtual auto names_objects() const -> bool = 0;
   virtual auto initialise_resources() -> void {};
-  virtual auto update_resources() -> void = 0;
+  virtual auto update_resources(TextureHandle) -> void = 0;
+  virtual auto update_resources(SamplerHandle) -> void = 0;
 
   virtual auto enqueue_destruction(std::function<void(IContext&)>&& f)
     -> void = 0;
@@ -46,17 +86,29 @@ struct IContext
 
   virtual auto get_graphics_pipeline_pool() -> GraphicsPipelinePool& = 0;
   virtual auto destroy(GraphicsPipelineHandle) -> void = 0;
+  virtual auto precompile(GraphicsPipelineHandle) -> void = 0;
+  // True when blend, cull, winding and polygon state are set at bind time
+  // rather than baked into the VkPipeline.
+  [[nodiscard]] virtual auto has_dynamic_pipeline_state() const -> bool = 0;
+  virtual auto get_pipeline_description_cache()
+    -> PipelineDescriptionCache& = 0;
+  virtual auto get_pipeline_cache() -> PipelineCache& = 0;
 
   virtual auto get_compute_pipeline_pool() -> ComputePipelinePool& = 0;
   virtual auto destroy(ComputePipelineHandle) -> void = 0;
 
   virtual auto get_shader_module_pool() -> ShaderModulePool& = 0;
+  virtual auto get_shader_cache() -> ShaderCache& = 0;
+  virtual auto get_include_cache() -> IncludeCache& = 0;
+  // Null when no archive was built or it failed to load.
+  virtual auto get_shader_archive() const -> const ShaderArchive* = 0;
   virtual auto destroy(ShaderModuleHandle) -> void = 0;
 
   virtual auto get_buffer_pool() -> BufferPool& = 0;
   virtual auto destroy(BufferHandle) -> void = 0;
 
   virtual auto get_sampler_pool() -> SamplerPool& = 0;
+  virtual auto get_sampler_cache() -> SamplerCache& = 0;
   virtual auto destroy(SamplerHandle) -> void = 0;
 
   enum class SwapchainRecreateResult : std::uint8_t
@@ -5,7 +5,10 @@
 #include "sv/texture.hpp"
 #include "sv/tracing.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <numeric>
 #include <vector>
 
 namespace sv {
@@ -63,12 +66,18 @@ public:
       2u, VK_DESCRIPTOR_TYPE_SAMPLER, storage_cap, VK_SHADER_STAGE_ALL, nullptr
     };
 
-    VkDescriptorBindingFlags bf[3]{
-      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
-        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
-      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
-        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
-    };
+    // Descriptor buffers have no pools to update after bind; the
+    // UPDATE_AFTER_BIND flags are invalid on their layouts.
+    const auto binding_flags =
+      d.uses_descriptor_buffer()
+        ? VkDescriptorBindingFlags{ VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT }
+        : VkDescriptorBindingFlags{
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+          };
+    VkDescriptorBindingFlags bf[3]{ binding_flags,
+                                    binding_flags,
+                                    binding_flags };
 
     VkDescriptorSetLayoutBindingFlagsCreateInfo flags_ci{
       VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
@@ -80,7 +89,11 @@ public:
     VkDescriptorSetLayoutCreateInfo ci{
       VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
       &flags_ci,
-      VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+      d.uses_descriptor_buffer()
+        ? VkDescriptorSetLayoutCreateFlags{
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT }
+        : VkDescriptorSetLayoutCreateFlags{
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT },
       std::size(b),
       b
     };
@@ -145,113 +158,259 @@ public:
     desc.storage_capacity = storage_cap;
   }
 
-  static auto write_all(Ctx& ctx) -> void
+  // Growth reallocates the buffer and copies every binding's old range to its
+  // new offset; nothing has to be rewritten.
+  static auto allocate_buffer(Ctx& ctx,
+                              std::uint32_t sampled_cap,
+                              std::uint32_t storage_cap) -> void
   {
     using access = BindlessAccess<Ctx>;
-    auto& pool = access::textures(ctx);
-    auto& samplers_pool = access::samplers(ctx);
     auto& desc = access::descriptors(ctx);
+    const auto& props = access::descriptor_buffer_properties(ctx);
+
+    const auto size =
+      get_aligned_size(access::layout_size(ctx, desc.layout),
+                       props.descriptorBufferOffsetAlignment);
+    auto next = access::create_descriptor_buffer(ctx, size);
+    next.binding_sizes = {
+      sampled_cap * props.sampledImageDescriptorSize,
+      storage_cap * props.storageImageDescriptorSize,
+      storage_cap * props.samplerDescriptorSize,
+    };
+    for (auto b = 0u; b < next.binding_offsets.size(); ++b)
+      next.binding_offsets[b] = access::binding_offset(ctx, desc.layout, b);
+
+    if (const auto& old = desc.buffer; old.buffer != VK_NULL_HANDLE) {
+      for (auto b = 0u; b < next.binding_offsets.size(); ++b) {
+        std::memcpy(next.mapped + next.binding_offsets[b],
+                    old.mapped + old.binding_offsets[b],
+                    std::min(old.binding_sizes[b], next.binding_sizes[b]));
+      }
+      access::flush_descriptor_buffer(ctx, next);
+      access::destroy_descriptor_buffer(ctx, old);
+    }
 
-    const auto n = static_cast<std::uint32_t>(pool.size());
+    desc.buffer = next;
+    desc.sampled_capacity = sampled_cap;
+    desc.storage_capacity = storage_cap;
+  }
 
-    if (n < 1)
-      return;
+  static auto put_descriptor(Ctx& ctx,
+                             const VkDescriptorImageInfo& info,
+                             VkDescriptorType type,
+                             std::uint32_t binding,
+                             std::uint32_t slot) -> void
+  {
+    using access = BindlessAccess<Ctx>;
+    const auto& props = access::descriptor_buffer_properties(ctx);
+    auto& buf = access::descriptors(ctx).buffer;
+
+    VkDescriptorGetInfoEXT get_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+      .pNext = nullptr,
+      .type = type,
+      .data = {},
+    };
+    std::size_t size{ 0 };
+    switch (type) {
+      case VK_DESCRIPTOR_TYPE_SAMPLER:
+        get_info.data.pSampler = &info.sampler;
+        size = props.samplerDescriptorSize;
+        break;
+      case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        get_info.data.pSampledImage = &info;
+        size = props.sampledImageDescriptorSize;
+        break;
+      case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        get_info.data.pStorageImage = &info;
+        size = props.storageImageDescriptorSize;
+        break;
+      default:
+        return;
+    }
 
-    std::vector<VkDescriptorImageInfo> sampled_infos(n);
-    std::vector<VkDescriptorImageInfo> storage_infos(n);
-    std::vector<VkDescriptorImageInfo> sampler_infos(n);
-
-    auto* default_image_view = pool.get(0);
-    auto* default_sampler = samplers_pool.get(0);
-
-    pool.for_each_dense([&](std::uint32_t i, const VulkanTextureND& v) {
-      const auto sampled = v.image_view != VK_NULL_HANDLE
-                             ? v.image_view
-                             : default_image_view->image_view;
-      const auto storage = v.storage_image_view != VK_NULL_HANDLE
-                             ? v.storage_image_view
-                             : default_image_view->image_view;
-
-      const auto is_storage = v.usage_flags & VK_IMAGE_USAGE_STORAGE_BIT;
-      const auto is_sampled = v.usage_flags & VK_IMAGE_USAGE_SAMPLED_BIT;
-
-      sampled_infos[i] = { VK_NULL_HANDLE,
-                           is_sampled ? sampled
-                                      : default_image_view->image_view,
-                           VK_IMAGE_LAYOUT_GENERAL };
-      storage_infos[i] = { VK_NULL_HANDLE,
-                           is_storage ? storage
-                                      : default_image_view->image_view,
-                           VK_IMAGE_LAYOUT_GENERAL };
-      sampler_infos[i] = { *default_sampler,
-                           VK_NULL_HANDLE,
-                           VK_IMAGE_LAYOUT_UNDEFINED };
-    });
+    access::get_descriptor(ctx,
+                           get_info,
+                           size,
+                           buf.mapped + buf.binding_offsets[binding] +
+                             slot * size);
+  }
 
-    std::vector<VkWriteDescriptorSet> w{};
-    std::uint32_t num_writes{ 0 };
-    if (!sampled_infos.empty()) {
-      auto& write = w.emplace_back();
-      write = {
+  static auto append_runs(const std::vector<std::uint32_t>& slots,
+                          const std::vector<VkDescriptorImageInfo>& infos,
+                          VkDescriptorSet set,
+                          std::uint32_t binding,
+                          VkDescriptorType type,
+                          std::vector<VkWriteDescriptorSet>& writes) -> void
+  {
+    for (std::size_t i = 0; i < slots.size();) {
+      auto j = i + 1;
+      while (j < slots.size() && slots[j] == slots[j - 1] + 1)
+        ++j;
+      writes.push_back({
         VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
         nullptr,
-        desc.set,
-        BINDING_SAMPLED,
-        0u,
-        n,
-        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-        sampled_infos.data(),
+        set,
+        binding,
+        slots[i],
+        static_cast<std::uint32_t>(j - i),
+        type,
+        infos.data() + i,
         nullptr,
         nullptr,
-      };
-      num_writes++;
+      });
+      i = j;
     }
-    if (!storage_infos.empty()) {
-      auto& write = w.emplace_back();
+  }
 
-      write = {
-        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        nullptr,
-        desc.set,
-        BINDING_STORAGE,
-        0u,
-        n,
-        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-        storage_infos.data(),
-        nullptr,
-        nullptr,
+  static auto prepare_slot_list(std::vector<std::uint32_t>& slots,
+                                bool rewrite_all,
+                                std::size_t slot_count) -> void
+  {
+    if (rewrite_all) {
+      slots.resize(slot_count);
+      std::iota(slots.begin(), slots.end(), 0u);
+      return;
+    }
+    std::ranges::sort(slots);
+    const auto [first, last] = std::ranges::unique(slots);
+    slots.erase(first, last);
+  }
+
+  static auto recycle_retired(Ctx& ctx) -> void
+  {
+    using access = BindlessAccess<Ctx>;
+    auto& slots = access::descriptors(ctx).slots;
+    const auto recycle = [&ctx](auto& pool) {
+      return [&ctx, &pool](const BindlessSlots::Retired& r) {
+        if (r.retired_after.empty() ||
+            !access::is_ready(ctx, r.retired_after))
+          return false;
+        pool.recycle_index(r.slot);
+        return true;
       };
+    };
+    std::erase_if(slots.retired_textures, recycle(access::textures(ctx)));
+    std::erase_if(slots.retired_samplers, recycle(access::samplers(ctx)));
+  }
+
+  static auto write_dirty(Ctx& ctx) -> void
+  {
+    using access = BindlessAccess<Ctx>;
+    auto& pool = access::textures(ctx);
+    auto& samplers_pool = access::samplers(ctx);
+    auto& desc = access::descriptors(ctx);
+    auto& slots = desc.slots;
 
-      num_writes++;
+    // Slot 0 of both pools holds the placeholders that stand in for dead or
+    // incompatible slots; nothing can be written before they exist.
+    auto* default_image_view = pool.get(0u);
+    auto* default_sampler = samplers_pool.get(0u);
+    if (!default_image_view || !default_sampler)
+      return;
+
+    prepare_slot_list(
+      slots.dirty_textures, slots.rewrite_all, pool.slot_count());
+    prepare_slot_list(
+      slots.dirty_samplers, slots.rewrite_all, samplers_pool.slot_count());
+    slots.rewrite_all = false;
+
+    std::vector<VkDescriptorImageInfo> sampled_infos;
+    std::vector<VkDescriptorImageInfo> storage_infos;
+    std::vector<VkDescriptorImageInfo> sampler_infos;
+    sampled_infos.reserve(slots.dirty_textures.size());
+    storage_infos.reserve(slots.dirty_textures.size());
+    sampler_infos.reserve(slots.dirty_samplers.size());
+
+    for (const auto slot : slots.dirty_textures) {
+      const auto* v = pool.get(slot);
+      const auto is_storage =
+        v && (v->usage_flags & VK_IMAGE_USAGE_STORAGE_BIT) &&
+        v->storage_image_view != VK_NULL_HANDLE;
+      const auto is_sampled = v &&
+                              (v->usage_flags & VK_IMAGE_USAGE_SAMPLED_BIT) &&
+                              v->image_view != VK_NULL_HANDLE;
+
+      sampled_infos.push_back({ VK_NULL_HANDLE,
+                                is_sampled ? v->image_view
+                                           : default_image_view->image_view,
+                                VK_IMAGE_LAYOUT_GENERAL });
+      storage_infos.push_back({ VK_NULL_HANDLE,
+                                is_storage ? v->storage_image_view
+                                           : default_image_view->image_view,
+                                VK_IMAGE_LAYOUT_GENERAL });
     }
-    if (!sampler_infos.empty()) {
-      auto& write = w.emplace_back();
 
-      write = {
-        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        nullptr,
-        desc.set,
-        BINDING_SAMPLER,
-        0u,
-        n,
-        VK_DESCRIPTOR_TYPE_SAMPLER,
-        sampler_infos.data(),
-        nullptr,
-        nullptr,
-      };
+    for (const auto slot : slots.dirty_samplers) {
+      const auto* s = samplers_pool.get(slot);
+      sampler_infos.push_back({ s ? *s : *default_sampler,
+                                VK_NULL_HANDLE,
+                                VK_IMAGE_LAYOUT_UNDEFINED });
+    }
 
-      num_writes++;
+    if (desc.uses_descriptor_buffer()) {
+      // The buffer is live memory the GPU reads from, not a set snapshot:
+      // in-flight frames may still sample the slots about to be rewritten
+      // (retired placeholders, recreated textures).
+      if (!slots.dirty_textures.empty() || !slots.dirty_samplers.empty())
+        access::wait_for_latest(ctx);
+      for (std::size_t i = 0; i < slots.dirty_textures.size(); ++i) {
+        const auto slot = slots.dirty_textures[i];
+        put_descriptor(ctx,
+                       sampled_infos[i],
+                       VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                       BINDING_SAMPLED,
+                       slot);
+        put_descriptor(ctx,
+                       storage_infos[i],
+                       VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                       BINDING_STORAGE,
+                       slot);
+      }
+      for (std::size_t i = 0; i < slots.dirty_samplers.size(); ++i) {
+        put_descriptor(ctx,
+                       sampler_infos[i],
+                       VK_DESCRIPTOR_TYPE_SAMPLER,
+                       BINDING_SAMPLER,
+                       slots.dirty_samplers[i]);
+      }
+      slots.dirty_textures.clear();
+      slots.dirty_samplers.clear();
+      access::flush_descriptor_buffer(ctx, desc.buffer);
+      return;
     }
 
-    if (num_writes > 0) {
-#if LVK_VULKAN_PRINT_COMMANDS
-      LLOGL("vkUpdateDescriptorSets()\n");
-#endif // LVK_VULKAN_PRINT_COMMANDS
-      access::wait_for_latest(
-        ctx); // immediate_->wait(immediate_->getLastSubmitHandle());
+    std::vector<VkWriteDescriptorSet> w{};
+    append_runs(slots.dirty_textures,
+                sampled_infos,
+                desc.set,
+                BINDING_SAMPLED,
+                VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                w);
+    append_runs(slots.dirty_textures,
+                storage_infos,
+                desc.set,
+                BINDING_STORAGE,
+                VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                w);
+    append_runs(slots.dirty_samplers,
+                sampler_infos,
+                desc.set,
+                BINDING_SAMPLER,
+                VK_DESCRIPTOR_TYPE_SAMPLER,
+                w);
+
+    slots.dirty_textures.clear();
+    slots.dirty_samplers.clear();
+
+    if (!w.empty()) {
+      access::wait_for_latest(ctx);
       ZoneScopedNC("vkUpdateDescriptorSets()", 0xFF0000);
-      vkUpdateDescriptorSets(
-        BindlessAccess<Ctx>::device(ctx), num_writes, w.data(), 0u, nullptr);
+      vkUpdateDescriptorSets(BindlessAccess<Ctx>::device(ctx),
+                             static_cast<std::uint32_t>(w.size()),
+                             w.data(),
+                             0u,
+                             nullptr);
     }
   }
 
@@ -259,25 +418,33 @@ public:
   {
     using access = BindlessAccess<Ctx>;
     access::process_pre_frame_work(ctx);
-    if (!access::needs_descriptor_update(ctx))
-      return;
+    recycle_retired(ctx);
 
     auto& d = access::descriptors(ctx);
+    if (!d.slots.has_pending_writes())
+      return;
+
     const auto n =
-      std::max(std::max(d.sampled_capacity, d.storage_capacity),
-               static_cast<std::uint32_t>(access::textures(ctx).size()));
+      std::max({ d.sampled_capacity,
+                 d.storage_capacity,
+                 static_cast<std::uint32_t>(access::textures(ctx).slot_count()),
+                 static_cast<std::uint32_t>(
+                   access::samplers(ctx).slot_count()) });
     const auto cap = std::max(next_pow2(n), 1u);
+    const bool grow = !d.is_allocated() || cap > d.sampled_capacity ||
+                      cap > d.storage_capacity;
 
     ensure_layout(ctx, cap, cap);
 
-    if (d.set == VK_NULL_HANDLE || cap > d.sampled_capacity ||
-        cap > d.storage_capacity) {
+    if (grow && d.uses_descriptor_buffer()) {
+      allocate_buffer(ctx, cap, cap);
+    } else if (grow) {
       allocate_set(ctx, cap, cap);
+      d.slots.rewrite_all = true;
     }
 
-    write_all(ctx);
-    access::needs_descriptor_update(ctx) = false;
+    write_dirty(ctx);
   }
 };
 
-}
\ No newline at end of file
+}
@@ -1,21 +1,110 @@
 #pragma once
 
+#include "sv/common.hpp"
+
+#include <array>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <vector>
+#include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
 namespace sv {
 
 struct IContext;
 
+// Descriptor slots are the pools' sparse indices, i.e. exactly what shaders
+// receive through Handle::index(). A destroyed handle keeps its slot out of
+// the pool freelist until the first submission after its destruction has
+// retired, and only slots that changed are rewritten.
+struct BindlessSlots
+{
+  struct Retired
+  {
+    std::uint32_t slot;
+    SubmitHandle retired_after{};
+  };
+
+  std::vector<std::uint32_t> dirty_textures;
+  std::vector<std::uint32_t> dirty_samplers;
+  std::vector<Retired> retired_textures;
+  std::vector<Retired> retired_samplers;
+  bool rewrite_all{ true };
+
+  auto mark_texture(std::uint32_t slot) -> void
+  {
+    dirty_textures.push_back(slot);
+  }
+  auto mark_sampler(std::uint32_t slot) -> void
+  {
+    dirty_samplers.push_back(slot);
+  }
+  auto retire_texture(std::uint32_t slot) -> void
+  {
+    mark_texture(slot);
+    retired_textures.push_back({ .slot = slot });
+  }
+  auto retire_sampler(std::uint32_t slot) -> void
+  {
+    mark_sampler(slot);
+    retired_samplers.push_back({ .slot = slot });
+  }
+
+  // Everything retired so far can be recycled once `handle` completes.
+  auto stamp(SubmitHandle handle) -> void
+  {
+    for (auto* list : { &retired_textures, &retired_samplers })
+      for (auto& r : *list)
+        if (r.retired_after.empty())
+          r.retired_after = handle;
+  }
+
+  [[nodiscard]] auto has_pending_writes() const -> bool
+  {
+    return rewrite_all || !dirty_textures.empty() || !dirty_samplers.empty();
+  }
+};
+
+enum class DescriptorBackend : std::uint8_t
+{
+  DescriptorSets,
+  DescriptorBuffer,
+};
+
+// Host-visible VK_EXT_descriptor_buffer storage for the bindless set layout.
+struct DescriptorBuffer
+{
+  VkBuffer buffer{ VK_NULL_HANDLE };
+  VmaAllocation allocation{ nullptr };
+  std::byte* mapped{ nullptr };
+  VkDeviceAddress address{ 0 };
+  VkDeviceSize size{ 0 };
+  std::array<VkDeviceSize, 3> binding_offsets{};
+  std::array<VkDeviceSize, 3> binding_sizes{};
+};
+
 struct DescriptorArrays
 {
+  DescriptorBackend backend{ DescriptorBackend::DescriptorSets };
   VkDescriptorSetLayout layout{ VK_NULL_HANDLE };
   VkDescriptorPool pool{ VK_NULL_HANDLE };
   VkDescriptorSet set{ VK_NULL_HANDLE };
+  DescriptorBuffer buffer{};
   std::uint32_t sampled_capacity{ 16 };
   std::uint32_t storage_capacity{ 16 };
+  BindlessSlots slots{};
+
+  [[nodiscard]] auto uses_descriptor_buffer() const -> bool
+  {
+    return backend == DescriptorBackend::DescriptorBuffer;
+  }
+  [[nodiscard]] auto is_allocated() const -> bool
+  {
+    return uses_descriptor_buffer() ? buffer.buffer != VK_NULL_HANDLE
+                                    : set != VK_NULL_HANDLE;
+  }
 };
 
 template<typename Ctx>
@@ -23,12 +112,28 @@ struct BindlessAccess
 {
   static auto device(Ctx&) -> VkDevice = delete;
   static auto descriptors(Ctx&) -> DescriptorArrays& = delete;
-  static auto needs_descriptor_update(Ctx&) -> bool& = delete;
+  static auto is_ready(Ctx&, SubmitHandle) -> bool = delete;
   static auto enqueue_destruction(Ctx&,
                                   std::function<void(IContext&)>&&) = delete;
   static auto process_pre_frame_task(Ctx&) = delete;
   static auto defer_task(Ctx&, std::function<void(IContext&)>&&) = delete;
   static auto wait_for_latest(Ctx&) = delete;
+
+  static auto descriptor_buffer_properties(Ctx&)
+    -> const VkPhysicalDeviceDescriptorBufferPropertiesEXT& = delete;
+  static auto create_descriptor_buffer(Ctx&, VkDeviceSize)
+    -> DescriptorBuffer = delete;
+  static auto destroy_descriptor_buffer(Ctx&, const DescriptorBuffer&)
+    -> void = delete;
+  static auto flush_descriptor_buffer(Ctx&, const DescriptorBuffer&)
+    -> void = delete;
+  static auto get_descriptor(Ctx&,
+                             const VkDescriptorGetInfoEXT&,
+                             std::size_t,
+                             void*) -> void = delete;
+  static auto layout_size(Ctx&, VkDescriptorSetLayout) -> VkDeviceSize = delete;
+  static auto binding_offset(Ctx&, VkDescriptorSetLayout, std::uint32_t)
+    -> VkDeviceSize = delete;
 };
 
 }
\ No newline at end of file
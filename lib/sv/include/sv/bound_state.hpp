@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+// vkCmd* calls left out because they would have set what was already bound.
+struct StateFilterTelemetry
+{
+  std::uint64_t pipelines{ 0 };
+  std::uint64_t vertex_buffers{ 0 };
+  std::uint64_t index_buffers{ 0 };
+  std::uint64_t depth_state{ 0 };
+  std::uint64_t viewports{ 0 };
+  std::uint64_t scissors{ 0 };
+  std::uint64_t push_constants{ 0 };
+
+  auto operator+=(const StateFilterTelemetry&) -> StateFilterTelemetry&;
+  [[nodiscard]] auto total() const -> std::uint64_t;
+};
+
+// Shadow of the state recorded into a command buffer. Every setter remembers
+// its value and returns whether the vkCmd* call is needed; an unknown slot
+// always needs it.
+class BoundState final
+{
+public:
+  static constexpr std::uint32_t max_vertex_buffers = 8;
+  static constexpr std::size_t max_push_constant_size = 256;
+
+  // Pipelines and their layouts stay bound across passes; buffers and
+  // dynamic state are recorded again by each pass.
+  auto begin_pass() -> void;
+  // Shader objects bind without a VkPipeline.
+  auto forget_pipeline() -> void { pipeline_bound = VK_NULL_HANDLE; }
+
+  auto pipeline(VkPipeline) -> bool;
+  // A new layout also disturbs the push constants.
+  auto graphics_layout(VkPipelineLayout) -> bool;
+  auto compute_layout(VkPipelineLayout) -> bool;
+  auto vertex_buffer(std::uint32_t index, VkBuffer, VkDeviceSize) -> bool;
+  auto index_buffer(VkBuffer, VkDeviceSize, VkIndexType) -> bool;
+  auto depth_test(VkBool32) -> bool;
+  auto depth_compare(VkCompareOp) -> bool;
+  auto depth_write(VkBool32) -> bool;
+  auto depth_bias(VkBool32) -> bool;
+  auto viewport(const VkViewport&) -> bool;
+  auto scissor(const VkRect2D&) -> bool;
+  auto push_constants(VkPipelineLayout,
+                      VkShaderStageFlags,
+                      std::span<const std::byte>) -> bool;
+
+  [[nodiscard]] auto get_skipped() const -> const StateFilterTelemetry&
+  {
+    return skipped;
+  }
+
+private:
+  struct VertexBinding
+  {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+  };
+  struct IndexBinding
+  {
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkIndexType type;
+  };
+  struct PushConstants
+  {
+    VkPipelineLayout layout;
+    VkShaderStageFlags stages;
+    std::uint32_t size;
+    std::array<std::byte, max_push_constant_size> data;
+  };
+
+  VkPipeline pipeline_bound{ VK_NULL_HANDLE };
+  VkPipelineLayout graphics_layout_bound{ VK_NULL_HANDLE };
+  VkPipelineLayout compute_layout_bound{ VK_NULL_HANDLE };
+
+  std::array<std::optional<VertexBinding>, max_vertex_buffers>
+    vertex_buffers{};
+  std::optional<IndexBinding> index{};
+  std::optional<VkBool32> depth_test_enabled{};
+  std::optional<VkCompareOp> depth_compare_op{};
+  std::optional<VkBool32> depth_write_enabled{};
+  std::optional<VkBool32> depth_bias_enabled{};
+  std::optional<VkViewport> viewport_bound{};
+  std::optional<VkRect2D> scissor_bound{};
+  std::optional<PushConstants> push{};
+
+  StateFilterTelemetry skipped{};
+};
+
+}
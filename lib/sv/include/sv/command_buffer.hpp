@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sv/abstract_command_buffer.hpp"
+#include "sv/bound_state.hpp"
 
 namespace sv {
 
@@ -22,12 +23,20 @@ public:
                            const Framebuffer& framebuffer,
                            const Dependencies& deps) -> void override;
   auto cmd_end_rendering() -> void override;
+  auto cmd_transition_image(TextureHandle, const ImageUsage&) -> void override;
   auto cmd_bind_viewport(const Viewport& viewport) -> void override;
   auto cmd_bind_scissor_rect(const ScissorRect& rect) -> void override;
   auto cmd_bind_graphics_pipeline(GraphicsPipelineHandle handle)
     -> void override;
   auto cmd_bind_compute_pipeline(ComputePipelineHandle handle) -> void override;
   auto cmd_bind_depth_state(const DepthState& state) -> void override;
+  auto cmd_set_cull_mode(CullMode) -> void override;
+  auto cmd_set_winding(WindingMode) -> void override;
+  auto cmd_set_polygon_mode(PolygonMode) -> void override;
+  auto cmd_set_blend_state(std::uint32_t, const ColourAttachment&)
+    -> void override;
+  auto cmd_set_colour_write_mask(std::uint32_t, ColourWriteMask)
+    -> void override;
   auto cmd_draw(std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t)
     -> void override;
   auto cmd_draw_indexed(std::uint32_t,
@@ -39,6 +48,15 @@ public:
                                  std::size_t,
                                  std::uint32_t,
                                  std::uint32_t) -> void override;
+  auto cmd_draw_indexed_indirect_count(BufferHandle,
+                                       std::size_t,
+                                       BufferHandle,
+                                       std::size_t,
+                                       std::uint32_t,
+                                       std::uint32_t) -> void override;
+  auto cmd_draw_multi_indexed(std::span<const MultiDrawIndexed>,
+                              std::uint32_t,
+                              std::uint32_t) -> void override;
   auto cmd_dispatch_thread_groups(const Dimensions&) -> void override;
   auto cmd_push_constants(std::span<const std::byte>) -> void override;
   auto cmd_bind_index_buffer(BufferHandle index_buffer,
@@ -54,11 +72,13 @@ private:
   const CommandBufferWrapper* wrapper{ nullptr };
 
   Framebuffer framebuffer = {};
+  ImageBarrierBatch barriers;
   SubmitHandle last_submit_handle = {};
 
-  VkPipeline last_pipeline_bound = VK_NULL_HANDLE;
+  BoundState bound;
 
   bool is_rendering = false;
+  bool skip_draws = false;
   std::uint32_t view_mask = 0;
 
   GraphicsPipelineHandle current_pipeline_graphics = {};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "sv/abstract_command_buffer.hpp"
+#include "sv/image_barriers.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace sv {
+
+enum class CommandType : std::uint8_t
+{
+  BeginRendering,
+  EndRendering,
+  TransitionImage,
+  BindViewport,
+  BindScissorRect,
+  BindGraphicsPipeline,
+  BindComputePipeline,
+  BindDepthState,
+  SetCullMode,
+  SetWinding,
+  SetPolygonMode,
+  SetBlendState,
+  SetColourWriteMask,
+  Draw,
+  DrawIndexed,
+  DrawIndexedIndirect,
+  DrawIndexedIndirectCount,
+  DrawMultiIndexed,
+  DispatchThreadGroups,
+  PushConstants,
+  BindIndexBuffer,
+  BindVertexBuffer,
+  Count,
+};
+
+struct CommandCounts
+{
+  std::array<std::uint32_t, static_cast<std::size_t>(CommandType::Count)>
+    by_type{};
+  // The image barriers passes and transitions need, merged and batched the
+  // way CommandBuffer does. Textures are tracked from their first use in the
+  // recorder, as if they started out undefined, over the levels and layers
+  // the stream names.
+  std::uint32_t image_barriers{ 0 };
+  std::uint32_t barrier_batches{ 0 };
+
+  [[nodiscard]] auto operator[](CommandType type) const -> std::uint32_t
+  {
+    return by_type[static_cast<std::size_t>(type)];
+  }
+  [[nodiscard]] auto draws() const -> std::uint32_t;
+  [[nodiscard]] auto binds() const -> std::uint32_t;
+
+  auto operator+=(const CommandCounts&) -> CommandCounts&;
+};
+
+// Commands packed back to back as a one byte tag and a fixed layout payload.
+// Handles are stored as is, so replay onto a command buffer whose context
+// owns them.
+class CommandStream final
+{
+public:
+  auto replay(ICommandBuffer&) const -> void;
+  auto clear() -> void;
+
+  [[nodiscard]] auto get_counts() const -> const CommandCounts&
+  {
+    return counts;
+  }
+  [[nodiscard]] auto size_bytes() const -> std::size_t { return bytes.size(); }
+  [[nodiscard]] auto empty() const -> bool { return bytes.empty(); }
+
+private:
+  friend class CommandRecorder;
+  auto write(std::span<const std::byte>) -> void;
+
+  std::vector<std::byte> bytes{};
+  CommandCounts counts{};
+};
+
+// Records into a CommandStream instead of a VkCommandBuffer, so frames can be
+// built and inspected without a device.
+class CommandRecorder final : public ICommandBuffer
+{
+public:
+  [[nodiscard]] auto get_command_buffer() const -> VkCommandBuffer override
+  {
+    return VK_NULL_HANDLE;
+  }
+
+  auto cmd_begin_rendering(const RenderPass&,
+                           const Framebuffer&,
+                           const Dependencies&) -> void override;
+  auto cmd_end_rendering() -> void override;
+  auto cmd_transition_image(TextureHandle, const ImageUsage&) -> void override;
+  auto cmd_bind_viewport(const Viewport&) -> void override;
+  auto cmd_bind_scissor_rect(const ScissorRect&) -> void override;
+  auto cmd_bind_graphics_pipeline(GraphicsPipelineHandle) -> void override;
+  auto cmd_bind_compute_pipeline(ComputePipelineHandle) -> void override;
+  auto cmd_bind_depth_state(const DepthState&) -> void override;
+  auto cmd_set_cull_mode(CullMode) -> void override;
+  auto cmd_set_winding(WindingMode) -> void override;
+  auto cmd_set_polygon_mode(PolygonMode) -> void override;
+  auto cmd_set_blend_state(std::uint32_t, const ColourAttachment&)
+    -> void override;
+  auto cmd_set_colour_write_mask(std::uint32_t, ColourWriteMask)
+    -> void override;
+  auto cmd_draw(std::uint32_t, std::uint32_t, std::uint32_t, std::uint32_t)
+    -> void override;
+  auto cmd_draw_indexed(std::uint32_t,
+                        std::uint32_t,
+                        std::uint32_t,
+                        std::int32_t,
+                        std::uint32_t) -> void override;
+  auto cmd_draw_indexed_indirect(BufferHandle,
+                                 std::size_t,
+                                 std::uint32_t,
+                                 std::uint32_t) -> void override;
+  auto cmd_draw_indexed_indirect_count(BufferHandle,
+                                       std::size_t,
+                                       BufferHandle,
+                                       std::size_t,
+                                       std::uint32_t,
+                                       std::uint32_t) -> void override;
+  auto cmd_draw_multi_indexed(std::span<const MultiDrawIndexed>,
+                              std::uint32_t,
+                              std::uint32_t) -> void override;
+  auto cmd_dispatch_thread_groups(const Dimensions&) -> void override;
+  auto cmd_push_constants(std::span<const std::byte>) -> void override;
+  using ICommandBuffer::cmd_push_constants;
+  auto cmd_bind_index_buffer(BufferHandle, IndexFormat, std::uint64_t)
+    -> void override;
+  auto cmd_bind_vertex_buffer(std::uint32_t, BufferHandle, std::uint64_t)
+    -> void override;
+
+  [[nodiscard]] auto get_stream() const -> const CommandStream&
+  {
+    return stream;
+  }
+  // Hands over what was recorded and starts an empty stream. Image states
+  // carry over, like the textures' own states do between frames.
+  auto take() -> CommandStream;
+
+private:
+  template<typename T>
+  auto record(CommandType, const T& payload) -> void;
+  auto record(CommandType) -> void;
+
+  // Grown to cover `level` and `layer` as they are first used.
+  auto states_for(TextureHandle, std::uint32_t level, std::uint32_t layer)
+    -> ImageStates&;
+  auto count_barriers(const ImageBarrierBatch&) -> void;
+
+  CommandStream stream{};
+  std::map<TextureHandle, ImageStates> image_states;
+};
+
+}
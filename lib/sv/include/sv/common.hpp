@@ -507,6 +507,16 @@ private:
   }
 };
 
+enum class ColourWriteMask : std::uint8_t
+{
+  R = bit(0),
+  G = bit(1),
+  B = bit(2),
+  A = bit(3),
+  All = bit(0) | bit(1) | bit(2) | bit(3),
+};
+BIT_FIELD(ColourWriteMask)
+
 struct ColourAttachment
 {
   Format format = Format::Invalid;
@@ -551,7 +561,7 @@ struct SpecialisationConstantDescription
 
 struct Dependencies
 {
-  static constexpr auto max_dependencies = 4U;
+  static constexpr auto max_dependencies = 8U;
   std::array<TextureHandle, max_dependencies> textures = {};
   std::array<BufferHandle, max_dependencies> buffers = {};
 };
@@ -669,6 +679,15 @@ struct DepthState
   bool is_depth_write_enabled{ false };
 };
 
+// One of several draws sharing instance count and first instance; laid out
+// like VkMultiDrawIndexedInfoEXT.
+struct MultiDrawIndexed
+{
+  std::uint32_t first_index = 0;
+  std::uint32_t index_count = 0;
+  std::int32_t vertex_offset = 0;
+};
+
 struct TextureLayers
 {
   std::uint32_t mip_level = 0;
@@ -817,22 +836,52 @@ storage_type_to_vk_memory_property_flags(StorageType storage)
   return memory_flags;
 }
 
+// Object naming costs a format and a driver call per object, so it is only
+// compiled in with SV_DEBUG_NAMES (on outside Release builds) and only done
+// when the context names objects at runtime.
+#if defined(SV_DEBUG_NAMES)
+inline constexpr bool debug_names_compiled = true;
+#else
+inline constexpr bool debug_names_compiled = false;
+#endif
+
+auto
+names_objects(const IContext&) -> bool;
 auto
-set_name(const IContext&, const std::uint64_t, VkObjectType, std::string_view)
+set_name(const IContext&, const std::uint64_t, VkObjectType, const char*)
   -> void;
 template<typename... Args>
 inline auto
-set_name(const IContext& ctx,
-         const auto vk_object,
-         const VkObjectType type,
-         const std::format_string<Args...> fmt,
-         Args&&... args) -> void
+set_name([[maybe_unused]] const IContext& ctx,
+         [[maybe_unused]] const auto vk_object,
+         [[maybe_unused]] const VkObjectType type,
+         [[maybe_unused]] const std::format_string<Args...> fmt,
+         [[maybe_unused]] Args&&... args) -> void
 {
   static_assert(std::is_pointer_v<decltype(vk_object)>);
-  return set_name(ctx,
-                  reinterpret_cast<std::uint64_t>(vk_object),
-                  type,
-                  std::format(fmt, std::forward<Args>(args)...));
+  if constexpr (debug_names_compiled) {
+    if (!names_objects(ctx))
+      return;
+    const auto name = std::format(fmt, std::forward<Args>(args)...);
+    set_name(ctx,
+             reinterpret_cast<std::uint64_t>(vk_object),
+             type,
+             name.c_str());
+  }
+}
+
+// For the debug_name of a description; empty when objects are not named.
+template<typename... Args>
+inline auto
+format_debug_name([[maybe_unused]] const IContext& ctx,
+                  [[maybe_unused]] const std::format_string<Args...> fmt,
+                  [[maybe_unused]] Args&&... args) -> std::string
+{
+  if constexpr (debug_names_compiled) {
+    if (names_objects(ctx))
+      return std::format(fmt, std::forward<Args>(args)...);
+  }
+  return {};
 }
 
 auto
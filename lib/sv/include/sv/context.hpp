@@ -9,13 +9,24 @@
 #include "sv/immediate_commands.hpp"
 #include "sv/object_handle.hpp"
 #include "sv/object_pool.hpp"
+#include "sv/pipeline_cache.hpp"
+#include "sv/shader/include_cache.hpp"
+#include "sv/shader/shader_archive.hpp"
+#include "sv/shader/shader_cache.hpp"
+#include "sv/shader/shader_watcher.hpp"
+#include "sv/pipeline_layout_cache.hpp"
+#include "sv/pipeline_library.hpp"
 #include "sv/staging_allocator.hpp"
 #include "sv/texture.hpp"
+#include "sv/worker_pool.hpp"
 
 #include <VkBootstrap.h>
+#include <chrono>
 #include <deque>
 #include <expected>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <vk_mem_alloc.h>
@@ -148,6 +159,8 @@ class VulkanContext final : public IContext
     VkPhysicalDeviceVulkan12Properties twelve{};
     VkPhysicalDeviceVulkan13Properties thirteen{};
     VkPhysicalDeviceVulkan14Properties fourteen{};
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer{};
+    VkPhysicalDeviceMultiDrawPropertiesEXT multi_draw{};
   };
   VulkanProperties vulkan_properties{};
   VkSurfaceKHR surface{ nullptr };
@@ -160,6 +173,8 @@ class VulkanContext final : public IContext
 
   TexturePool textures;
   SamplerPool samplers;
+  SamplerCache sampler_cache;
+  PipelineDescriptionCache pipeline_descriptions;
   BufferPool buffers;
   GraphicsPipelinePool graphics_pipelines;
   ComputePipelinePool compute_pipelines;
@@ -167,7 +182,63 @@ class VulkanContext final : public IContext
 
   DescriptorArrays descriptors;
   friend struct BindlessAccess<VulkanContext>;
-  bool needs_descriptor_update{ true };
+
+  std::unique_ptr<PipelineCache> pipeline_cache;
+  // Background pipeline compiles and optimised relinks.
+  std::unique_ptr<WorkerPool> pipeline_workers;
+  std::unique_ptr<ShaderCache> shader_cache;
+  std::unique_ptr<IncludeCache> include_cache;
+  std::optional<ShaderArchive> shader_archive;
+  std::unique_ptr<ShaderWatcher> shader_watcher;
+  PipelineLayoutCache pipeline_layouts;
+  auto acquire_pipeline_layout(VkShaderStageFlags, std::size_t)
+    -> VkPipelineLayout;
+  auto release_pipeline_layout(VkPipelineLayout) -> void;
+
+  PipelineLibraryCache pipeline_libraries;
+  bool has_graphics_pipeline_library{ false };
+  bool has_shader_objects{ false };
+  bool has_extended_dynamic_state3{ false };
+  bool has_multi_draw{ false };
+  bool has_debug_names{ false };
+  using PipelineLibraries =
+    std::array<VkPipeline, PipelineLibraryCache::part_count>;
+
+  struct GraphicsPipelineBuild;
+  struct CompiledPipeline
+  {
+    VkPipeline pipeline{ VK_NULL_HANDLE };
+    std::chrono::nanoseconds elapsed{};
+    // Set when the pipeline was fast-linked and can be relinked optimised.
+    PipelineLibraries libraries{};
+  };
+  std::map<GraphicsPipelineHandle, std::future<CompiledPipeline>>
+    pending_graphics_pipelines;
+  std::map<GraphicsPipelineHandle, std::future<CompiledPipeline>>
+    optimised_graphics_pipelines;
+  auto prepare_graphics_pipeline(VulkanGraphicsPipeline&)
+    -> GraphicsPipelineBuild;
+  static auto compile_graphics_pipeline(VkDevice,
+                                        VkPipelineCache,
+                                        const GraphicsPipelineBuild&)
+    -> CompiledPipeline;
+  static auto compile_pipeline_libraries(VkDevice,
+                                         VkPipelineCache,
+                                         PipelineLibraryCache&,
+                                         const VkGraphicsPipelineCreateInfo&)
+    -> CompiledPipeline;
+  static auto link_pipeline_libraries(VkDevice,
+                                      VkPipelineCache,
+                                      const PipelineLibraries&,
+                                      VkPipelineCreateFlags,
+                                      VkPipelineLayout,
+                                      bool optimise) -> CompiledPipeline;
+  auto evict_pipeline_libraries(std::uint64_t dependency) -> void;
+  auto adopt_graphics_pipeline(GraphicsPipelineHandle,
+                               VulkanGraphicsPipeline&,
+                               const CompiledPipeline&) -> VkPipeline;
+  auto discard_pending_pipeline(GraphicsPipelineHandle) -> void;
+  auto release_shader_objects(VulkanShader&) -> void;
 
   std::unique_ptr<StagingAllocator> staging_allocator;
   friend class StagingAllocator;
@@ -179,6 +250,8 @@ class VulkanContext final : public IContext
   Holder<SamplerHandle> dummy_sampler;
 
   CommandBuffer command_buffer;
+  BarrierTelemetry barrier_telemetry{};
+  StateFilterTelemetry state_filter_telemetry{};
   friend class CommandBuffer;
 
   std::unique_ptr<VulkanSwapchain> swapchain;
@@ -246,6 +319,10 @@ public:
   {
     return surface;
   }
+  [[nodiscard]] auto names_objects() const -> bool override
+  {
+    return has_debug_names;
+  }
   auto enqueue_destruction(std::function<void(IContext&)>&& f) -> void override
   {
     delete_queue.emplace_back(std::forward<std::function<void(IContext&)>>(f));
@@ -255,7 +332,14 @@ public:
     pre_frame_queue.emplace_back(
       std::forward<std::function<void(IContext&)>>(f));
   }
-  auto update_resources() -> void override { needs_descriptor_update = true; }
+  auto update_resources(TextureHandle h) -> void override
+  {
+    descriptors.slots.mark_texture(h.index());
+  }
+  auto update_resources(SamplerHandle h) -> void override
+  {
+    descriptors.slots.mark_sampler(h.index());
+  }
 
   auto get_texture_pool() -> TexturePool& override { return textures; }
   auto get_texture_pool() const -> const TexturePool& { return textures; }
@@ -270,6 +354,11 @@ public:
     return graphics_pipelines;
   }
   auto destroy(GraphicsPipelineHandle) -> void override;
+  auto precompile(GraphicsPipelineHandle) -> void override;
+  auto get_pipeline_description_cache() -> PipelineDescriptionCache& override
+  {
+    return pipeline_descriptions;
+  }
 
   auto get_compute_pipeline_pool() -> ComputePipelinePool& override
   {
@@ -290,6 +379,13 @@ public:
     return shader_modules;
   }
   auto destroy(ShaderModuleHandle) -> void override;
+  // Swaps new modules in under an existing handle; pipelines using it are
+  // rebuilt the next time they are bound.
+  auto replace_shader(ShaderModuleHandle, VulkanShader&&) -> bool;
+  [[nodiscard]] auto get_shader_watcher() -> ShaderWatcher*
+  {
+    return shader_watcher.get();
+  }
 
   auto get_buffer_pool() -> BufferPool& override { return buffers; }
   auto get_buffer_pool() const -> const BufferPool& { return buffers; }
@@ -297,6 +393,7 @@ public:
 
   auto get_sampler_pool() -> SamplerPool& override { return samplers; }
   auto get_sampler_pool() const -> const SamplerPool& { return samplers; }
+  auto get_sampler_cache() -> SamplerCache& override { return sampler_cache; }
   auto destroy(SamplerHandle) -> void override;
 
   auto flush_mapped_memory(BufferHandle, OffsetSize) const -> void override;
@@ -305,6 +402,9 @@ public:
 
   auto acquire_command_buffer() -> ICommandBuffer& override
   {
+    if (shader_watcher) {
+      shader_watcher->apply();
+    }
     command_buffer = CommandBuffer{ *this };
     return command_buffer;
   }
@@ -335,6 +435,25 @@ public:
 
   auto get_pipeline(ComputePipelineHandle) -> VkPipeline;
   auto get_pipeline(GraphicsPipelineHandle) -> VkPipeline;
+  [[nodiscard]] auto get_pipeline_cache() -> PipelineCache& override
+  {
+    return *pipeline_cache;
+  }
+  auto get_shader_cache() -> ShaderCache& override { return *shader_cache; }
+  [[nodiscard]] auto get_barrier_telemetry() const -> const BarrierTelemetry&
+  {
+    return barrier_telemetry;
+  }
+  [[nodiscard]] auto get_state_filter_telemetry() const
+    -> const StateFilterTelemetry&
+  {
+    return state_filter_telemetry;
+  }
+  auto get_include_cache() -> IncludeCache& override { return *include_cache; }
+  [[nodiscard]] auto get_shader_archive() const -> const ShaderArchive* override
+  {
+    return shader_archive ? &*shader_archive : nullptr;
+  }
 
   template<auto Member, class... Args>
   auto dispatch(Args&&... args) const
@@ -346,21 +465,51 @@ public:
                                            std::forward<Args>(args)...);
   }
 
-  auto bind_default_descriptor_sets(const VkCommandBuffer cmd,
-                                    const VkPipelineBindPoint bind_point,
-                                    const VkPipelineLayout layout) const -> void
+  [[nodiscard]] auto uses_shader_objects() const -> bool
+  {
+    return has_shader_objects;
+  }
+  [[nodiscard]] auto has_dynamic_pipeline_state() const -> bool override
   {
-    const std::array dsets{
-      descriptors.set,
-    };
-    vkCmdBindDescriptorSets(cmd,
-                            bind_point,
-                            layout,
-                            0,
-                            static_cast<std::uint32_t>(dsets.size()),
-                            dsets.data(),
-                            0,
-                            nullptr);
+    return has_extended_dynamic_state3 && !has_shader_objects;
+  }
+  // Draws vkCmdDrawMultiIndexedEXT takes at once; 0 without VK_EXT_multi_draw.
+  [[nodiscard]] auto get_max_multi_draw_count() const -> std::uint32_t
+  {
+    return has_multi_draw ? vulkan_properties.multi_draw.maxMultiDrawCount : 0;
+  }
+  // Shader objects leave every piece of state dynamic anyway.
+  [[nodiscard]] auto can_set_dynamic_pipeline_state() const -> bool
+  {
+    return has_extended_dynamic_state3 || has_shader_objects;
+  }
+  // Sets the state has_dynamic_pipeline_state() leaves out of the pipeline.
+  auto apply_dynamic_pipeline_state(VkCommandBuffer,
+                                    const GraphicsPipelineDescription&) const
+    -> void;
+  auto set_cull_mode(VkCommandBuffer, CullMode) const -> void;
+  auto set_winding(VkCommandBuffer, WindingMode) const -> void;
+  auto set_polygon_mode(VkCommandBuffer, PolygonMode) const -> void;
+  auto set_blend_state(VkCommandBuffer,
+                       std::uint32_t first_attachment,
+                       std::span<const ColourAttachment>) const -> void;
+  auto set_colour_write_mask(VkCommandBuffer,
+                             std::uint32_t attachment,
+                             ColourWriteMask) const -> void;
+  auto create_shader_objects(VulkanShader&) -> bool;
+  // Binds the pipeline's shaders and sets all of its state dynamically;
+  // returns the layout to bind descriptors and push constants with.
+  auto bind_shader_objects(VkCommandBuffer, GraphicsPipelineHandle)
+    -> VkPipelineLayout;
+
+  auto bind_default_descriptor_sets(VkCommandBuffer cmd,
+                                    VkPipelineBindPoint bind_point,
+                                    VkPipelineLayout layout) const -> void;
+  [[nodiscard]] auto get_pipeline_create_flags() const -> VkPipelineCreateFlags
+  {
+    return descriptors.uses_descriptor_buffer()
+             ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+             : 0;
   }
 
   auto resize_next_frame() { should_resize = true; }
@@ -391,9 +540,9 @@ struct BindlessAccess<VulkanContext>
   }
   static auto textures(VulkanContext& c) -> TexturePool& { return c.textures; }
   static auto samplers(VulkanContext& c) -> SamplerPool& { return c.samplers; }
-  static auto needs_descriptor_update(VulkanContext& c) -> bool&
+  static auto is_ready(VulkanContext& c, SubmitHandle h) -> bool
   {
-    return c.needs_descriptor_update;
+    return c.get_immediate_commands().is_ready(h);
   }
   static auto enqueue_destruction(VulkanContext& c,
                                   std::function<void(IContext& context)>&& f)
@@ -405,6 +554,26 @@ struct BindlessAccess<VulkanContext>
   {
     c.defer_task(std::move(f));
   }
+  static auto descriptor_buffer_properties(VulkanContext& c)
+    -> const VkPhysicalDeviceDescriptorBufferPropertiesEXT&
+  {
+    return c.vulkan_properties.descriptor_buffer;
+  }
+  static auto create_descriptor_buffer(VulkanContext&, VkDeviceSize)
+    -> DescriptorBuffer;
+  static auto destroy_descriptor_buffer(VulkanContext&, const DescriptorBuffer&)
+    -> void;
+  static auto flush_descriptor_buffer(VulkanContext&, const DescriptorBuffer&)
+    -> void;
+  static auto get_descriptor(VulkanContext&,
+                             const VkDescriptorGetInfoEXT&,
+                             std::size_t,
+                             void*) -> void;
+  static auto layout_size(VulkanContext&, VkDescriptorSetLayout)
+    -> VkDeviceSize;
+  static auto binding_offset(VulkanContext&,
+                             VkDescriptorSetLayout,
+                             std::uint32_t) -> VkDeviceSize;
   static auto wait_for_latest(VulkanContext& c)
   {
     c.get_immediate_commands().wait(
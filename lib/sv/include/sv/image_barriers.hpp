@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+struct BarrierTelemetry
+{
+  std::uint64_t emitted{ 0 };
+  std::uint64_t elided{ 0 };
+  std::uint64_t batches{ 0 };
+};
+
+struct ImageState
+{
+  VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+  // What the next barrier waits for: the stages that last used the
+  // subresource and the writes among them not yet made available.
+  VkPipelineStageFlags2 stage{ VK_PIPELINE_STAGE_2_NONE };
+  VkAccessFlags2 write_access{ VK_ACCESS_2_NONE };
+  // What the last barrier made the subresource visible to.
+  VkPipelineStageFlags2 visible_stage{ VK_PIPELINE_STAGE_2_NONE };
+  VkAccessFlags2 visible_access{ VK_ACCESS_2_NONE };
+};
+
+// How the next command uses a subresource.
+struct ImageUsage
+{
+  VkImageLayout layout{ VK_IMAGE_LAYOUT_GENERAL };
+  VkPipelineStageFlags2 stage{ VK_PIPELINE_STAGE_2_NONE };
+  VkAccessFlags2 access{ VK_ACCESS_2_NONE };
+  // The previous contents are not needed (cleared or overwritten), so a
+  // layout change may start from UNDEFINED.
+  bool discard{ false };
+};
+
+// How passes use their attachments and dependencies. `discard` is set when
+// the pass does not load the attachment's previous contents.
+auto
+colour_attachment_usage(bool discard) -> ImageUsage;
+auto
+depth_attachment_usage(bool discard) -> ImageUsage;
+
+// Colour and depth/stencil resolves both write in the colour output stage.
+inline constexpr ImageUsage resolve_attachment_usage{
+  .layout = VK_IMAGE_LAYOUT_GENERAL,
+  .stage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+  .access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+  .discard = true,
+};
+
+// Dependencies are sampled or loaded by the pass's shaders; the bindless set
+// describes every image as GENERAL.
+inline constexpr ImageUsage dependency_usage{
+  .layout = VK_IMAGE_LAYOUT_GENERAL,
+  .stage = VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+           VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+  .access = VK_ACCESS_2_SHADER_READ_BIT,
+  .discard = false,
+};
+
+// Tracked state of every mip level and array layer of one image.
+class ImageStates final
+{
+public:
+  ImageStates() = default;
+  ImageStates(std::uint32_t level_count, std::uint32_t layer_count);
+
+  [[nodiscard]] auto get_level_count() const { return levels; }
+  [[nodiscard]] auto get_layer_count() const { return layers; }
+  [[nodiscard]] auto get(std::uint32_t level, std::uint32_t layer) const
+    -> const ImageState&
+  {
+    return states[level * layers + layer];
+  }
+  auto get(std::uint32_t level, std::uint32_t layer) -> ImageState&
+  {
+    return states[level * layers + layer];
+  }
+  // For work recorded outside a barrier batch, e.g. staging uploads.
+  auto set(const VkImageSubresourceRange&, const ImageState&) -> void;
+
+private:
+  std::uint32_t levels{ 0 };
+  std::uint32_t layers{ 0 };
+  std::vector<ImageState> states{};
+};
+
+// Collects the image barriers a pass needs and records them with a single
+// vkCmdPipelineBarrier2. A subresource already in the requested layout with
+// its last writes visible to the requested stages gets no barrier.
+class ImageBarrierBatch final
+{
+public:
+  auto require(VkImage,
+               ImageStates&,
+               const VkImageSubresourceRange&,
+               const ImageUsage&) -> void;
+  // Does nothing when no barrier is pending.
+  auto flush(VkCommandBuffer, BarrierTelemetry&) -> void;
+
+  [[nodiscard]] auto pending() const -> std::span<const VkImageMemoryBarrier2>
+  {
+    return barriers;
+  }
+
+  // The barrier (without image and range) taking `state` to `usage`, if one
+  // is needed. Updates `state` either way.
+  static auto transition(ImageState& state, const ImageUsage&)
+    -> std::optional<VkImageMemoryBarrier2>;
+
+private:
+  std::vector<VkImageMemoryBarrier2> barriers;
+  std::uint64_t elided{ 0 };
+};
+
+}
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -42,8 +43,14 @@ struct Mesh
   std::array<std::uint32_t, max_lods + 1> lod_offset{};
 
   [[nodiscard]] auto get_lod_index_count(const std::uint32_t lod) const
+    -> std::uint32_t
   {
-    return lod < lod_count ? lod_offset.at(static_cast<std::uint64_t>(lod) + 1) - lod_offset.at(0) : 0;
+    return lod < lod_count ? lod_offset.at(lod + 1ULL) - lod_offset.at(lod) : 0;
+  }
+  [[nodiscard]] auto get_lod_first_index(const std::uint32_t lod) const
+    -> std::uint32_t
+  {
+    return index_offset + lod_offset.at(lod);
   }
 };
 
@@ -111,6 +118,10 @@ class RenderMesh
   };
   Holder<BufferHandle> transform_buffer;
   Holder<BufferHandle> material_buffer;
+  // One command per submesh for every LOD level, each submesh clamped to its
+  // own coarsest LOD; one instance, first instance 0.
+  std::vector<VkDrawIndexedIndirectCommand> lod_commands;
+  std::uint32_t lod_levels{ 0 };
 
 public:
   static auto create(IContext&, std::string_view)
@@ -119,6 +130,9 @@ public:
   [[nodiscard]] auto get_file() const -> const auto& { return file; }
   [[nodiscard]] auto get_vertex_buffer() const -> const auto& { return vertex_buffer; }
   [[nodiscard]] auto get_index_buffer() const -> const auto& { return index_buffer; }
+  // Indexed like get_file().mesh.meshes.
+  [[nodiscard]] auto get_draw_commands(std::uint32_t lod) const
+    -> std::span<const VkDrawIndexedIndirectCommand>;
 };
 
 auto
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "sv/abstract_context.hpp"
+#include "sv/command_stream.hpp"
+#include "sv/shader/include_cache.hpp"
+
+#include <deque>
+#include <functional>
+#include <utility>
+
+namespace sv {
+
+// An IContext without a device, for tests and benchmarks on machines without
+// a GPU. Frames are recorded into command streams, and submitting one keeps
+// it for inspection. Pools and caches are real, so handles resolve, but
+// anything that has to create Vulkan objects throws.
+class NullContext final : public IContext
+{
+public:
+  explicit NullContext(bool dynamic_pipeline_state = true);
+  ~NullContext() override;
+
+  [[nodiscard]] auto get_instance() const -> VkInstance override
+  {
+    return VK_NULL_HANDLE;
+  }
+  [[nodiscard]] auto get_physical_device() const -> VkPhysicalDevice override
+  {
+    return VK_NULL_HANDLE;
+  }
+  [[nodiscard]] auto get_device() const -> VkDevice override
+  {
+    return VK_NULL_HANDLE;
+  }
+  [[nodiscard]] auto get_device_wrapper() const -> const vkb::Device& override
+  {
+    return device;
+  }
+  [[nodiscard]] auto get_graphics_queue() const -> VkQueue override
+  {
+    return VK_NULL_HANDLE;
+  }
+  [[nodiscard]] auto get_present_queue() const -> VkQueue override
+  {
+    return VK_NULL_HANDLE;
+  }
+  [[nodiscard]] auto get_graphics_queue_family() const -> std::uint32_t override
+  {
+    return 0;
+  }
+  [[nodiscard]] auto get_present_queue_family() const -> std::uint32_t override
+  {
+    return 0;
+  }
+  [[nodiscard]] auto get_surface() const -> VkSurfaceKHR override
+  {
+    return VK_NULL_HANDLE;
+  }
+  [[nodiscard]] auto names_objects() const -> bool override { return false; }
+  auto update_resources(TextureHandle) -> void override {}
+  auto update_resources(SamplerHandle) -> void override {}
+
+  // Nothing is in flight, so both run at the next submit.
+  auto enqueue_destruction(std::function<void(IContext&)>&& f) -> void override
+  {
+    delete_queue.emplace_back(std::move(f));
+  }
+  auto defer_task(std::function<void(IContext&)>&& f) -> void override
+  {
+    delete_queue.emplace_back(std::move(f));
+  }
+
+  auto get_texture_pool() -> TexturePool& override { return textures; }
+  auto destroy(TextureHandle h) -> void override { textures.erase(h); }
+
+  auto get_graphics_pipeline_pool() -> GraphicsPipelinePool& override
+  {
+    return graphics_pipelines;
+  }
+  auto destroy(GraphicsPipelineHandle) -> void override;
+  auto precompile(GraphicsPipelineHandle) -> void override {}
+  [[nodiscard]] auto has_dynamic_pipeline_state() const -> bool override
+  {
+    return dynamic_pipeline_state;
+  }
+  auto get_pipeline_description_cache() -> PipelineDescriptionCache& override
+  {
+    return pipeline_descriptions;
+  }
+  auto get_pipeline_cache() -> PipelineCache& override;
+
+  auto get_compute_pipeline_pool() -> ComputePipelinePool& override
+  {
+    return compute_pipelines;
+  }
+  auto destroy(ComputePipelineHandle h) -> void override
+  {
+    compute_pipelines.erase(h);
+  }
+
+  auto get_shader_module_pool() -> ShaderModulePool& override
+  {
+    return shader_modules;
+  }
+  auto get_shader_cache() -> ShaderCache& override;
+  auto get_include_cache() -> IncludeCache& override { return include_cache; }
+  [[nodiscard]] auto get_shader_archive() const -> const ShaderArchive* override
+  {
+    return nullptr;
+  }
+  auto destroy(ShaderModuleHandle h) -> void override
+  {
+    shader_modules.erase(h);
+  }
+
+  auto get_buffer_pool() -> BufferPool& override { return buffers; }
+  auto destroy(BufferHandle h) -> void override { buffers.erase(h); }
+
+  auto get_sampler_pool() -> SamplerPool& override { return samplers; }
+  auto get_sampler_cache() -> SamplerCache& override { return sampler_cache; }
+  auto destroy(SamplerHandle) -> void override;
+
+  auto recreate_swapchain(std::uint32_t, std::uint32_t)
+    -> SwapchainRecreateResult override
+  {
+    return SwapchainRecreateResult::NoOp;
+  }
+  auto get_current_swapchain_texture() -> TextureHandle override
+  {
+    return {};
+  }
+  auto acquire_command_buffer() -> ICommandBuffer& override;
+  // Takes the recorder's stream; the present texture is ignored.
+  auto submit(ICommandBuffer&, TextureHandle) -> SubmitHandle override;
+
+  auto get_swapchain() -> VulkanSwapchain& override;
+  auto recreate_buffer(const Holder<BufferHandle>&,
+                       VkDeviceSize,
+                       std::span<const std::byte>,
+                       VkDeviceSize,
+                       bool) -> void override;
+
+  auto flush_mapped_memory(BufferHandle, OffsetSize) const -> void override {}
+  auto invalidate_mapped_memory(BufferHandle, OffsetSize) const
+    -> void override
+  {
+  }
+
+  auto get_immediate_commands() -> ImmediateCommands& override;
+  auto get_staging_allocator() -> StagingAllocator& override;
+
+  auto recreate_texture(const Holder<TextureHandle>&,
+                        const TextureDescription&) -> void override;
+
+  [[nodiscard]] auto get_last_submitted() const -> const CommandStream&
+  {
+    return last_submitted;
+  }
+  // Summed over every submit.
+  [[nodiscard]] auto get_submitted_counts() const -> const CommandCounts&
+  {
+    return submitted_counts;
+  }
+  [[nodiscard]] auto get_submit_count() const -> std::uint32_t
+  {
+    return submit_count;
+  }
+
+private:
+  auto run_deferred() -> void;
+
+  vkb::Device device{};
+  bool dynamic_pipeline_state{ true };
+
+  TexturePool textures;
+  SamplerPool samplers;
+  SamplerCache sampler_cache;
+  PipelineDescriptionCache pipeline_descriptions;
+  BufferPool buffers;
+  GraphicsPipelinePool graphics_pipelines;
+  ComputePipelinePool compute_pipelines;
+  ShaderModulePool shader_modules;
+  IncludeCache include_cache{ "shaders/include" };
+
+  CommandRecorder recorder;
+  CommandStream last_submitted;
+  CommandCounts submitted_counts{};
+  std::uint32_t submit_count{ 0 };
+
+  std::deque<std::function<void(IContext&)>> delete_queue;
+};
+
+}
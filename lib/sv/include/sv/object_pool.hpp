@@ -122,6 +122,7 @@ public:
   using value_type = TImpl;
 
   auto size() const -> std::size_t { return dense_storage.size(); }
+  auto slot_count() const -> std::size_t { return generations.size(); }
   auto capacity() const -> std::size_t { return dense_storage.capacity(); }
 
   auto reserved_prefix() -> std::uint32_t& { return reserved; }
@@ -164,6 +165,17 @@ public:
   }
 
   auto erase(handle_type h) -> bool
+  {
+    if (!erase_retained(h))
+      return false;
+    release_index(h.index());
+    return true;
+  }
+
+  // Like erase, but the sparse index stays out of the freelist until
+  // recycle_index is called. Bindless descriptor slots are sparse indices, so
+  // this keeps a slot from being handed out while the GPU may still read it.
+  auto erase_retained(handle_type h) -> bool
   {
     if (!is_valid(h))
       return false;
@@ -183,6 +195,13 @@ public:
     return true;
   }
 
+  auto recycle_index(std::uint32_t idx) -> void
+  {
+    if (idx >= generations.size() || sparse_to_dense[idx] != npos)
+      return;
+    release_index(idx);
+  }
+
   auto replace_in_place(IContext* ctx, handle_type h, TImpl&& v) -> bool
   {
     if (!is_valid(h))
@@ -244,7 +263,7 @@ public:
     for (std::uint32_t i = 0; i < generations.size(); ++i) {
       store_generation(i, detail::bump_generation(load_generation(i)));
       sparse_to_dense[i] = npos;
-      freelist.push(i);
+      release_index(i);
     }
   }
 
@@ -283,6 +302,12 @@ private:
   {
     store_generation(idx, detail::bump_generation(load_generation(idx)));
     sparse_to_dense[idx] = npos;
+  }
+
+  auto release_index(std::uint32_t idx) -> void
+  {
+    if constexpr (LockFree)
+      freelist.ensure_capacity(generations.size());
     freelist.push(idx);
   }
 
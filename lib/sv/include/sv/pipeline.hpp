@@ -71,6 +71,9 @@ struct GraphicsPipelineDescription
   Topology topology{ Topology::Triangle };
   VertexInput vertex_input{};
   ShaderModuleHandle shader;
+  // Selects one of the shader's `#pragma variant` combinations, e.g.
+  // "ALPHA_TEST=1,CASCADES=2"; empty uses the defaults.
+  std::string shader_variant{};
   SpecialisationConstantDescription specialisation_constants{};
   std::array<ColourAttachment, max_colour_attachments> color{};
   Format depth_format = Format::Invalid;
@@ -98,6 +101,21 @@ struct GraphicsPipelineDescription
   {
     return other.vertex_input == vertex_input;
   }
+
+  // The description with everything extended dynamic state 3 covers reset,
+  // i.e. what the VkPipeline itself is keyed on.
+  [[nodiscard]] auto without_dynamic_state() const
+    -> GraphicsPipelineDescription
+  {
+    auto result = *this;
+    for (auto& attachment : result.color) {
+      attachment = ColourAttachment{ .format = attachment.format };
+    }
+    result.cull_mode = CullMode::None;
+    result.winding = WindingMode::CCW;
+    result.polygon_mode = PolygonMode::Fill;
+    return result;
+  }
 };
 
 class VulkanGraphicsPipeline
@@ -116,6 +134,9 @@ class VulkanGraphicsPipeline
   std::uint32_t binding_count{ 0 };
   std::uint32_t attribute_count{ 0 };
   std::uint32_t view_mask{ 0 };
+  // Set when this only differs from another pipeline in dynamic state and
+  // draws with its VkPipeline.
+  GraphicsPipelineHandle variant_of{};
 
 public:
   VulkanGraphicsPipeline() { stage_flags = VK_SHADER_STAGE_ALL_GRAPHICS; }
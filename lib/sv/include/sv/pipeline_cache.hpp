@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+struct PipelineTelemetry
+{
+  std::uint32_t compiled{ 0 };
+  std::uint32_t deduplicated{ 0 };
+  std::chrono::nanoseconds compile_time{ 0 };
+  std::size_t bytes_loaded{ 0 };
+  std::size_t bytes_saved{ 0 };
+};
+
+// One VkPipelineCache shared by every pipeline the context builds. The blob is
+// seeded from, and written back to, a file keyed by vendor, device, driver
+// version and pipeline cache UUID; anything whose header does not match this
+// device is ignored.
+class PipelineCache final
+{
+public:
+  PipelineCache(VkDevice,
+                const VkPhysicalDeviceProperties&,
+                std::filesystem::path directory);
+  ~PipelineCache();
+
+  PipelineCache(const PipelineCache&) = delete;
+  auto operator=(const PipelineCache&) -> PipelineCache& = delete;
+
+  [[nodiscard]] auto get() const -> VkPipelineCache { return cache; }
+  [[nodiscard]] auto get_telemetry() const -> const PipelineTelemetry&
+  {
+    return telemetry;
+  }
+  auto get_telemetry() -> PipelineTelemetry& { return telemetry; }
+
+  auto record_compile(std::chrono::nanoseconds) -> void;
+  auto record_deduplicated() -> void { telemetry.deduplicated++; }
+  // Writes the cache to a temporary file and renames it over the previous one.
+  auto save() -> bool;
+  auto save_if_changed() -> bool;
+
+private:
+  VkDevice device{ VK_NULL_HANDLE };
+  VkPipelineCache cache{ VK_NULL_HANDLE };
+  VkPhysicalDeviceProperties properties{};
+  std::filesystem::path path;
+  PipelineTelemetry telemetry{};
+  std::uint32_t compiled_at_last_save{ 0 };
+};
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "sv/object_handle.hpp"
+#include "sv/pipeline.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace sv {
+
+// Deduplicates graphics pipelines by their full description, so identical
+// create calls share one VkPipeline. Every find/insert hands out one
+// reference; a pipeline is only destroyed once its last reference is
+// released. The debug name is not part of the key.
+class PipelineDescriptionCache final
+{
+public:
+  auto find(const GraphicsPipelineDescription&) -> GraphicsPipelineHandle;
+  auto insert(const GraphicsPipelineDescription&, GraphicsPipelineHandle)
+    -> void;
+  // Returns true when the caller should destroy the underlying pipeline.
+  auto release(GraphicsPipelineHandle) -> bool;
+  auto clear() -> void;
+
+  [[nodiscard]] auto size() const -> std::size_t { return by_slot.size(); }
+
+private:
+  struct Entry
+  {
+    GraphicsPipelineDescription description{};
+    // Owns the bytes description.specialisation_constants.data points at.
+    std::vector<std::byte> specialisation_data{};
+    GraphicsPipelineHandle handle{};
+    std::uint32_t references{ 0 };
+  };
+
+  static auto hash(const GraphicsPipelineDescription&) -> std::size_t;
+  static auto equal(const GraphicsPipelineDescription&,
+                    const GraphicsPipelineDescription&) -> bool;
+
+  std::unordered_map<std::size_t, std::vector<Entry>> buckets;
+  std::unordered_map<std::uint32_t, std::size_t> by_slot;
+};
+
+}
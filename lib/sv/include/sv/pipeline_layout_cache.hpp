@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+// Shares VkPipelineLayouts between pipelines that use the same descriptor set
+// layout and push-constant range. Every find/insert hands out one reference;
+// a layout is only destroyed once its last reference is released.
+class PipelineLayoutCache final
+{
+public:
+  struct Key
+  {
+    VkDescriptorSetLayout set_layout{ VK_NULL_HANDLE };
+    VkShaderStageFlags stages{ 0 };
+    std::uint32_t push_constant_size{ 0 };
+
+    auto operator==(const Key&) const -> bool = default;
+  };
+
+  auto find(const Key&) -> VkPipelineLayout;
+  auto insert(const Key&, VkPipelineLayout) -> void;
+  // Returns true when the caller should destroy the layout.
+  auto release(VkPipelineLayout) -> bool;
+  // Forgets every entry and returns the layouts that were still referenced.
+  auto clear() -> std::vector<VkPipelineLayout>;
+
+  [[nodiscard]] auto size() const -> std::size_t { return entries.size(); }
+
+private:
+  struct Entry
+  {
+    Key key{};
+    VkPipelineLayout layout{ VK_NULL_HANDLE };
+    std::uint32_t references{ 0 };
+  };
+
+  std::vector<Entry> entries;
+};
+
+}
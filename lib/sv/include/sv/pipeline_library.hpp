@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+// Caches the VK_EXT_graphics_pipeline_library parts of graphics pipelines,
+// keyed by the packed state each part was built from. Every entry remembers
+// the shader modules and pipeline layout it was built against so it can be
+// evicted before those handles are destroyed and reused. Compile workers use
+// this concurrently, so all access is locked.
+class PipelineLibraryCache final
+{
+public:
+  enum class Part : std::uint8_t
+  {
+    VertexInput,
+    PreRasterisation,
+    FragmentShader,
+    FragmentOutput,
+  };
+  static constexpr auto part_count = 4U;
+
+  auto find(Part, std::string_view key) -> VkPipeline;
+  // Returns the library now cached for key. When another thread got there
+  // first that is not the one passed in, and the caller should destroy its
+  // own.
+  auto insert(Part,
+              std::string_view key,
+              std::span<const std::uint64_t> dependencies,
+              VkPipeline) -> VkPipeline;
+  // Forgets every library built against the given object.
+  auto evict(std::uint64_t dependency) -> std::vector<VkPipeline>;
+  auto clear() -> std::vector<VkPipeline>;
+
+  [[nodiscard]] auto size() const -> std::size_t;
+
+private:
+  struct Entry
+  {
+    VkPipeline library{ VK_NULL_HANDLE };
+    std::vector<std::uint64_t> dependencies{};
+  };
+
+  mutable std::mutex mutex;
+  std::array<std::unordered_map<std::string, Entry>, part_count> parts;
+};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "sv/abstract_command_buffer.hpp"
+#include "sv/common.hpp"
+#include "sv/object_holder.hpp"
+#include "sv/render_graph_plan.hpp"
+#include "sv/texture.hpp"
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sv {
+
+struct IContext;
+
+// Passes declare the textures they render to and sample, and record their
+// draws in a callback. Compiling culls the passes nothing uses and places
+// transient textures with disjoint lifetimes in shared memory; executing
+// begins each pass with the attachments and dependencies it declared, so
+// cmd_begin_rendering derives the barriers.
+class RenderGraph final
+{
+public:
+  using Record = std::function<void(ICommandBuffer&, const Framebuffer&)>;
+
+  class PassBuilder final
+  {
+  public:
+    // Loading the previous contents makes the pass read the texture too. A
+    // depth attachment that is loaded but not stored is only read.
+    auto colour(GraphResource, const RenderPass::AttachmentDescription&)
+      -> PassBuilder&;
+    auto depth(GraphResource, const RenderPass::AttachmentDescription&)
+      -> PassBuilder&;
+    auto sample(GraphResource) -> PassBuilder&;
+    // Never culled, e.g. because it draws UI straight to an imported target.
+    auto side_effects() -> PassBuilder&;
+    auto record(Record) -> void;
+
+  private:
+    friend class RenderGraph;
+    PassBuilder(RenderGraph& g, std::uint32_t i)
+      : graph(&g)
+      , index(i)
+    {
+    }
+
+    RenderGraph* graph;
+    std::uint32_t index;
+  };
+
+  struct MemoryFootprint
+  {
+    VkDeviceSize aliased{ 0 };
+    VkDeviceSize unaliased{ 0 };
+  };
+
+  explicit RenderGraph(IContext&);
+  ~RenderGraph();
+  RenderGraph(const RenderGraph&) = delete;
+  auto operator=(const RenderGraph&) -> RenderGraph& = delete;
+
+  // Owned by the graph and only valid between compile() and destruction.
+  auto create_texture(const TextureDescription&) -> GraphResource;
+  // Owned elsewhere; bind() the texture before every execute().
+  auto import_texture(std::string_view name) -> GraphResource;
+  auto bind(GraphResource, TextureHandle) -> void;
+  auto add_pass(std::string_view name) -> PassBuilder;
+
+  auto compile() -> Expected<void, std::string>;
+  auto execute(ICommandBuffer&) -> void;
+
+  [[nodiscard]] auto get_texture(GraphResource) const -> TextureHandle;
+  [[nodiscard]] auto get_plan() const -> const RenderGraphPlan& { return plan; }
+  [[nodiscard]] auto get_memory_footprint() const -> MemoryFootprint;
+
+private:
+  struct Resource
+  {
+    std::string name{};
+    bool imported{ false };
+    TextureDescription description{};
+    Holder<TextureHandle> owned{};
+    TextureHandle texture{};
+  };
+
+  struct Pass
+  {
+    std::string name{};
+    RenderPass render_pass{};
+    std::array<GraphResource, max_colour_attachments> colour{};
+    std::uint32_t colour_count{ 0 };
+    std::optional<GraphResource> depth{};
+    std::vector<GraphResource> sampled{};
+    bool has_side_effects{ false };
+    Record record{};
+  };
+
+  auto planned_passes() const -> std::vector<PlannedPass>;
+  auto hand_over_memory(GraphResource) -> void;
+
+  IContext* context{ nullptr };
+  std::vector<Resource> resources{};
+  std::vector<Pass> passes{};
+  std::vector<PlannedResource> planned_resources{};
+  RenderGraphPlan plan{};
+  std::vector<VmaAllocation> memory{};
+  // The transient resource that used each memory slot last.
+  std::vector<std::optional<GraphResource>> slot_users{};
+};
+
+}
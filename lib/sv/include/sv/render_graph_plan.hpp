@@ -0,0 +1,66 @@
+#pragma once
+
+#include "sv/expected.hpp"
+#include "sv/strong.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+struct PlannedPass
+{
+  std::vector<GraphResource> reads{};
+  std::vector<GraphResource> writes{};
+  // Kept even when nothing reads what it writes.
+  bool has_side_effects{ false };
+};
+
+struct PlannedResource
+{
+  // Owned outside the graph, so read after the last pass; gets no memory.
+  bool imported{ false };
+  VkMemoryRequirements requirements{};
+};
+
+// Which passes of a render graph run, and where its transient resources
+// live. Passes run in declaration order. A pass is culled when nothing after
+// it reads what it writes, unless it has side effects or writes an imported
+// resource. Transient resources whose lifetimes do not overlap share memory.
+struct RenderGraphPlan
+{
+  static constexpr std::uint32_t no_slot = ~0U;
+
+  // Positions in `order` of the first and last pass using a resource.
+  struct Lifetime
+  {
+    std::uint32_t first{ 0 };
+    std::uint32_t last{ 0 };
+  };
+  struct MemorySlot
+  {
+    VkDeviceSize size{ 0 };
+    VkDeviceSize alignment{ 1 };
+    std::uint32_t memory_type_bits{ ~0U };
+  };
+
+  std::vector<std::uint32_t> order{};
+  // Per resource; unused and imported resources have no slot.
+  std::vector<Lifetime> lifetimes{};
+  std::vector<std::uint32_t> slots{};
+  std::vector<MemorySlot> memory{};
+
+  [[nodiscard]] static auto build(std::span<const PlannedPass>,
+                                  std::span<const PlannedResource>)
+    -> Expected<RenderGraphPlan, std::string>;
+
+  // Memory the transient resources would need without aliasing, and with.
+  [[nodiscard]] auto unaliased_size(std::span<const PlannedResource>) const
+    -> VkDeviceSize;
+  [[nodiscard]] auto aliased_size() const -> VkDeviceSize;
+};
+
+}
@@ -10,7 +10,10 @@
 #include "sv/mesh_definition.hpp"
 #include "sv/object_handle.hpp"
 #include "sv/object_holder.hpp"
+#include "sv/strong.hpp"
 
+#include <array>
+#include <functional>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -18,6 +21,7 @@ namespace sv {
 
 struct IContext;
 class Camera;
+class RenderGraph;
 
 template<typename T>
 class FrameCountBuffer
@@ -87,41 +91,57 @@ struct DrawKey
   auto operator<=>(const DrawKey&) const = default;
 };
 
-struct DrawKeyHash
-{
-  auto operator()(const DrawKey& k) const noexcept -> std::size_t
-  {
-    std::size_t h = 0xcbf29ce484222325ULL;
-    const auto mix = [&](std::size_t x) {
-      h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
-    };
-    mix(reinterpret_cast<std::size_t>(k.mesh));
-    mix(static_cast<std::size_t>(k.lod));
-    mix(static_cast<std::size_t>(k.material_index));
-    return h;
-  }
-};
-
+// The top three rows of the model matrix, and the columns of its normal
+// matrix packed like vertex normals, so shaders neither read the constant
+// bottom row nor invert anything per vertex.
 struct InstanceData
 {
-  glm::mat4 model;
+  std::array<glm::vec4, 3> model_rows{};
+  std::array<std::uint32_t, 3> normal_columns{};
   std::uint32_t material_index{};
-  std::uint32_t pad0{}, pad1{}, pad2{};
-};
 
-struct MeshBatch
-{
-  std::vector<InstanceData> instances_cpu;
-  std::vector<VkDrawIndexedIndirectCommand> draws_cpu;
-  Holder<BufferHandle> instances_ssbo;
-  Holder<BufferHandle> indirect_buffer;
-  std::uint32_t base_instance{};
+  static auto create(const glm::mat4& model, std::uint32_t material_index)
+    -> InstanceData;
 };
+static_assert(sizeof(InstanceData) == 64);
 
+// Everything submitted for one frame, drawn by every pass from one instance
+// buffer and one indirect buffer. Each indirect command draws one submesh of
+// the instances of one key, found through its firstInstance; every submesh of
+// a key shares that run and adds its own material from draw_materials.
 struct FrameDraws
 {
-  std::unordered_map<DrawKey, MeshBatch, DrawKeyHash> batches;
-  auto clear() { batches.clear(); }
+  struct Submission
+  {
+    DrawKey key{};
+    InstanceData instance{};
+  };
+  // Consecutive indirect commands drawing from one mesh's buffers.
+  struct MeshRange
+  {
+    const RenderMesh* mesh{};
+    std::uint32_t first_command{};
+    std::uint32_t command_count{};
+  };
+
+  std::vector<Submission> submissions;
+  std::vector<InstanceData> instances;
+  std::vector<VkDrawIndexedIndirectCommand> commands;
+  // Per command: the file material index of the submesh it draws.
+  std::vector<std::uint32_t> draw_materials;
+  std::vector<MeshRange> meshes;
+  Holder<BufferHandle> instance_buffer;
+  Holder<BufferHandle> indirect_buffer;
+  Holder<BufferHandle> draw_material_buffer;
+
+  auto clear() -> void
+  {
+    submissions.clear();
+    instances.clear();
+    commands.clear();
+    draw_materials.clear();
+    meshes.clear();
+  }
 };
 
 static constexpr std::uint32_t frames_in_flight = 3;
@@ -148,21 +168,20 @@ private:
   {
     Holder<ShaderModuleHandle> shader;
     Holder<GraphicsPipelineHandle> pipeline;
-    Holder<TextureHandle>
-      oct_normals_extras_tbd{};          // r8g8 normals, b8a8 extras tbd
-    Holder<TextureHandle> material_id{}; // u32 red
-    Holder<TextureHandle> uvs{};         // u32 red
-    Holder<TextureHandle> depth_32{};    // d32 with stencil maybe?
+    GraphResource oct_normals_extras_tbd{}; // r8g8 normals, b8a8 extras tbd
+    GraphResource material_id{};            // u32 red
+    GraphResource uvs{};                    // u32 red
+    GraphResource depth_32{};               // d32 with stencil maybe?
   };
   struct GBufferLighting
   {
-    Holder<TextureHandle> hdr{};
+    GraphResource hdr{};
     Holder<ShaderModuleHandle> shader;
     Holder<GraphicsPipelineHandle> pipeline;
   };
   struct DirectionalShadow
   {
-    Holder<TextureHandle> texture{};
+    GraphResource texture{};
     Holder<SamplerHandle> sampler{};
     Holder<ShaderModuleHandle> shader{};
     Holder<GraphicsPipelineHandle> pipeline{};
@@ -186,6 +205,16 @@ private:
   Tonemap tonemap;                      // Phase 4
   std::unique_ptr<ImGuiRenderer> imgui; // Phase 5
 
+  // Rebuilt on resize; owns every target above.
+  std::unique_ptr<RenderGraph> graph;
+  GraphResource swapchain{};
+  auto add_gbuffer_pass(RenderGraph&) -> void;
+  auto add_shadow_passes(RenderGraph&) -> void;
+  auto add_lighting_pass(RenderGraph&) -> void;
+  auto add_forward_pass(RenderGraph&) -> void;
+  auto add_tonemap_pass(RenderGraph&) -> void;
+  auto add_ui_pass(RenderGraph&) -> void;
+
   struct UBO
   {
     glm::mat4 view;
@@ -233,6 +262,12 @@ private:
 
   auto draw_gbuffer_batches(ICommandBuffer&) -> void;
   auto draw_gbuffer_batches_shadow(ICommandBuffer&, CascadeIndex) -> void;
+  // `before_range` runs before each mesh's multi-draw, e.g. to push the first
+  // command index that gl_DrawID is relative to.
+  auto draw_frame_batches(
+    ICommandBuffer&,
+    const std::function<void(const FrameDraws::MeshRange&)>& before_range = {})
+    -> void;
 
 public:
   Renderer(IContext&, const std::tuple<std::uint32_t, std::uint32_t>& extent);
@@ -241,6 +276,8 @@ public:
   auto record(ICommandBuffer&, TextureHandle) -> void override;
   auto resize(std::uint32_t, std::uint32_t) -> void override;
 
+  // Draws every submesh of the mesh; their file material indices are offset
+  // by material_index.
   auto submit(const RenderMesh&,
               const glm::mat4&,
               std::uint32_t material_index,
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "sv/object_handle.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace sv {
+
+// Deduplicates samplers by their create-info. Every find/insert hands out one
+// reference; a sampler is only destroyed once its last reference is released.
+// Create-infos with a pNext chain are never cached.
+class SamplerCache final
+{
+public:
+  [[nodiscard]] static auto is_cacheable(const VkSamplerCreateInfo&) -> bool;
+
+  auto find(const VkSamplerCreateInfo&) -> SamplerHandle;
+  auto insert(const VkSamplerCreateInfo&, SamplerHandle) -> void;
+  // Returns true when the caller should destroy the underlying sampler.
+  auto release(SamplerHandle) -> bool;
+  auto clear() -> void;
+
+  [[nodiscard]] auto size() const -> std::size_t { return by_slot.size(); }
+
+private:
+  struct Entry
+  {
+    VkSamplerCreateInfo info{};
+    SamplerHandle handle{};
+    std::uint32_t references{ 0 };
+  };
+
+  static auto hash(const VkSamplerCreateInfo&) -> std::size_t;
+  static auto equal(const VkSamplerCreateInfo&, const VkSamplerCreateInfo&)
+    -> bool;
+
+  std::unordered_map<std::size_t, std::vector<Entry>> buckets;
+  std::unordered_map<std::uint32_t, std::size_t> by_slot;
+};
+
+}
@@ -2,6 +2,7 @@
 
 #include "sv/expected.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <expected>
 #include <regex>
@@ -19,7 +20,9 @@ enum class ParseError : std::uint8_t
   unknown_shader_stage,
   duplicate_stage_entry,
   missing_stage_content,
-  invalid_compute_entry_name
+  invalid_compute_entry_name,
+  invalid_variant_declaration,
+  unknown_variant
 };
 enum class ShaderStage : std::uint8_t
 {
@@ -46,10 +49,20 @@ struct ShaderEntry
   std::size_t line_number{ 0 };
 };
 
+// `#pragma variant NAME : a, b, c` declares a compile-time switch. Every
+// compile defines NAME to one of the values; the first is the default.
+struct ShaderVariantDeclaration
+{
+  std::string name{};
+  std::vector<std::string> values{};
+  std::size_t line_number{ 0 };
+};
+
 struct ParsedShader
 {
   std::vector<ShaderEntry> entries;
   std::unordered_map<std::string, size_t> stage_lookup;
+  std::vector<ShaderVariantDeclaration> variants;
 };
 
 class ShaderParser
@@ -121,6 +134,59 @@ class ShaderParser
     return PragmaInfo{ *stage_result, "", line_number };
   }
 
+  static auto is_variant_pragma(std::string_view line) -> bool
+  {
+    return line.starts_with("#pragma variant") ||
+           line.starts_with("# pragma variant");
+  }
+
+  static auto is_identifier(std::string_view str) -> bool
+  {
+    const auto alpha = [](char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    };
+    return !str.empty() && alpha(str.front()) &&
+           std::ranges::all_of(str, [&](char c) {
+             return alpha(c) || (c >= '0' && c <= '9');
+           });
+  }
+
+  static auto parse_variant_line(std::string_view line, size_t line_number)
+    -> Expected<ShaderVariantDeclaration, ParseError>
+  {
+    line = trim(line.substr(line.find("variant") + 7));
+
+    const auto colon_pos = line.find(':');
+    if (colon_pos == std::string_view::npos) {
+      return unexpected<ParseError>(ParseError::invalid_variant_declaration);
+    }
+
+    ShaderVariantDeclaration declaration{
+      .name = std::string(trim(line.substr(0, colon_pos))),
+      .line_number = line_number,
+    };
+    if (!is_identifier(declaration.name)) {
+      return unexpected<ParseError>(ParseError::invalid_variant_declaration);
+    }
+
+    std::string_view values = line.substr(colon_pos + 1);
+    while (!values.empty()) {
+      const auto comma = std::min(values.find(','), values.size());
+      const auto value = trim(values.substr(0, comma));
+      if (value.empty() || value.find_first_of(" \t=") != value.npos ||
+          std::ranges::find(declaration.values, value) !=
+            declaration.values.end()) {
+        return unexpected<ParseError>(ParseError::invalid_variant_declaration);
+      }
+      declaration.values.emplace_back(value);
+      values.remove_prefix(std::min(comma + 1, values.size()));
+    }
+    if (declaration.values.empty()) {
+      return unexpected<ParseError>(ParseError::invalid_variant_declaration);
+    }
+    return declaration;
+  }
+
   static auto trim(std::string_view str) -> std::string_view
   {
     str.remove_prefix(std::min(str.find_first_not_of(" \t\r\n"), str.size()));
@@ -152,7 +218,17 @@ public:
     while (std::getline(stream, line)) {
       std::string_view line_view = trim(line);
 
-      if (line_view.starts_with("#pragma stage") ||
+      if (is_variant_pragma(line_view)) {
+        auto variant = parse_variant_line(line_view, line_number);
+        if (!variant ||
+            std::ranges::any_of(result.variants, [&](const auto& v) {
+              return v.name == variant->name;
+            })) {
+          return unexpected<ParseError>(
+            ParseError::invalid_variant_declaration);
+        }
+        result.variants.push_back(std::move(*variant));
+      } else if (line_view.starts_with("#pragma stage") ||
           line_view.starts_with("# pragma stage")) {
         auto pragma_result = parse_pragma_line(line_view, line_number);
         if (!pragma_result) {
@@ -203,7 +279,7 @@ public:
         current_content.clear();
         in_stage = true;
         current_pragma_idx++;
-      } else if (in_stage) {
+      } else if (in_stage && !is_variant_pragma(line_view)) {
         // Accumulate content for current stage
         current_content += line + "\n";
       }
@@ -230,6 +306,13 @@ public:
     return result;
   }
 
+  // Normalises `key` ("NAME=value,..." in any order, omitted names taking
+  // their default) to the declaration order with every name present.
+  static auto select_variant(const ParsedShader&, std::string_view key)
+    -> Expected<std::string, ParseError>;
+  // Defines each NAME of a normalised key at the top of every stage; call
+  // before prepend_preamble.
+  static auto define_variant(ParsedShader&, std::string_view key) -> void;
   static auto prepend_preamble(ParsedShader&) -> bool;
   static auto destroy_context() -> void;
 
@@ -271,6 +354,10 @@ error_to_string(ParseError error) -> std::string_view
       return "Missing stage content";
     case ParseError::invalid_compute_entry_name:
       return "Invalid compute entry name";
+    case ParseError::invalid_variant_declaration:
+      return "Invalid variant declaration";
+    case ParseError::unknown_variant:
+      return "Unknown variant";
   }
   return "Unknown error";
 }
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sv {
+
+// In-memory #include files for shader compilation, plus the graph of which
+// shader files pulled in which includes. An entry is re-read when its mtime or
+// size changes; its hash tells a real edit from a touch. Thread-safe.
+class IncludeCache final
+{
+public:
+  struct File
+  {
+    std::filesystem::path path{};
+    std::string contents{};
+    std::uint64_t hash{ 0 };
+    std::filesystem::file_time_type modified{};
+    std::uintmax_t size{ 0 };
+  };
+
+  explicit IncludeCache(std::filesystem::path include_directory);
+
+  IncludeCache(const IncludeCache&) = delete;
+  auto operator=(const IncludeCache&) -> IncludeCache& = delete;
+
+  // `"name"` looks next to the includer before the include directory;
+  // `<name>` only looks in the include directory.
+  auto resolve(std::string_view name,
+               const std::filesystem::path& includer,
+               bool system) -> std::shared_ptr<const File>;
+  // `path` itself, re-read if it changed on disk.
+  auto get(const std::filesystem::path& path) -> std::shared_ptr<const File>;
+  // Re-validates `path`; true when its contents hash differently than before.
+  auto refresh(const std::filesystem::path& path) -> bool;
+
+  auto clear_dependencies(const std::filesystem::path& shader) -> void;
+  [[nodiscard]] auto dependencies_of(const std::filesystem::path& shader) const
+    -> std::vector<std::filesystem::path>;
+  auto add_dependency(const std::filesystem::path& shader,
+                      const std::filesystem::path& file) -> void;
+  // Shader files that include `file`, directly or through other includes.
+  [[nodiscard]] auto dependents(const std::filesystem::path& file) const
+    -> std::vector<std::filesystem::path>;
+
+  [[nodiscard]] static auto key(const std::filesystem::path&)
+    -> std::filesystem::path;
+
+private:
+  auto load(const std::filesystem::path& path) -> std::shared_ptr<const File>;
+
+  std::filesystem::path include_directory;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::filesystem::path, std::shared_ptr<const File>> files;
+  std::unordered_map<std::filesystem::path,
+                     std::unordered_set<std::filesystem::path>>
+    dependencies;
+};
+
+}
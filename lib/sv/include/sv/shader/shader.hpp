@@ -3,11 +3,15 @@
 #include "sv/object_handle.hpp"
 #include "sv/object_holder.hpp"
 #include "sv/shader/compilation.hpp"
+#include "sv/shader/shader_archive.hpp"
 
 #include <algorithm>
 #include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.h>
@@ -15,6 +19,8 @@
 namespace sv {
 
 struct IContext;
+class IncludeCache;
+class ShaderCache;
 class VulkanContext;
 
 inline auto
@@ -78,6 +84,9 @@ class VulkanShader
     ShaderStage stage;
     std::string entry_name{ "main" }; // for compute
     VkShaderModule module{ VK_NULL_HANDLE };
+    // Only kept when the context renders with VK_EXT_shader_object.
+    std::vector<std::uint8_t> spirv{};
+    VkShaderEXT object{ VK_NULL_HANDLE };
   };
 
 public:
@@ -89,6 +98,24 @@ public:
 
   static auto create(IContext& context, const std::filesystem::path& path)
     -> Holder<ShaderModuleHandle>;
+  // Compiles every stage of every file on a thread pool, then creates the
+  // modules on the calling thread. Failed files yield an empty holder.
+  static auto create_batch(IContext& context,
+                           std::span<const std::filesystem::path> paths)
+    -> std::vector<Holder<ShaderModuleHandle>>;
+  // The module set compiled with `key` ("NAME=value,...") selecting among the
+  // file's `#pragma variant` values, compiled on first use and owned by the
+  // shader. The default selection is the shader itself.
+  static auto get_variant(IContext& context,
+                          ShaderModuleHandle shader,
+                          std::string_view key) -> ShaderModuleHandle;
+  // Parses and compiles the default variant of `path` without a device, for
+  // building a ShaderArchive rooted at `root`.
+  static auto compile_offline(const std::filesystem::path& path,
+                              const std::filesystem::path& root,
+                              ShaderCache& cache,
+                              IncludeCache& include_cache)
+    -> Expected<ShaderArchive::Entry, ShaderError>;
 
   [[nodiscard]] auto get_modules() const -> const auto& { return modules; }
 
@@ -102,14 +129,14 @@ public:
   {
     stages.clear();
     stages.reserve(modules.size());
-    for (auto&& [stage, entry_name, module] : modules) {
+    for (const auto& m : modules) {
       stages.push_back(VkPipelineShaderStageCreateInfo{
         .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
         .pNext = nullptr,
         .flags = 0,
-        .stage = to_vk_stage(stage),
-        .module = module,
-        .pName = entry_name.c_str(),
+        .stage = to_vk_stage(m.stage),
+        .module = m.module,
+        .pName = m.entry_name.c_str(),
         .pSpecializationInfo = &info,
       });
     }
@@ -128,8 +155,39 @@ private:
   VulkanContext* context{ nullptr };
   std::vector<StageModule> modules{};
   VkShaderStageFlagBits flags{ VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM };
-
-  static auto compile(IContext& device, const std::filesystem::path& path)
+  // The set layout the shader objects were created against.
+  VkDescriptorSetLayout object_set_layout{ VK_NULL_HANDLE };
+
+  std::filesystem::path path{};
+  // The parsed file, kept when it declares variants to compile them from.
+  std::shared_ptr<const ParsedShader> variant_source{};
+  std::unordered_map<std::string, ShaderModuleHandle> variants{};
+
+  friend class VulkanContext;
+  friend class ShaderWatcher;
+
+  using CompiledStage = ShaderArchive::Stage;
+
+  static auto initialise_glslang() -> void;
+  static auto load_source(const std::filesystem::path& path)
+    -> Expected<ParsedShader, ShaderError>;
+  // Defines the variant selected by `key` and prepends the preamble.
+  static auto prepare_source(const ParsedShader& parsed, std::string_view key)
+    -> Expected<ParsedShader, ShaderError>;
+  // Compiles the stages of every source on a thread pool.
+  static auto compile_sources(
+    IContext& context,
+    std::span<const std::filesystem::path> paths,
+    std::span<const Expected<ParsedShader, ShaderError>> sources)
+    -> std::vector<Expected<std::vector<CompiledStage>, ShaderError>>;
+  // Thread-safe; touches no Vulkan state.
+  static auto compile_stage(ShaderCache& cache,
+                            IncludeCache& include_cache,
+                            const std::filesystem::path& path,
+                            const ShaderEntry& entry)
+    -> Expected<CompiledStage, ShaderError>;
+  static auto create_modules(IContext& context,
+                             std::vector<CompiledStage>&& stages)
     -> Expected<VulkanShader, ShaderError>;
 
   void move_from(VulkanShader&& other)
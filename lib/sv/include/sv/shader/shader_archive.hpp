@@ -0,0 +1,80 @@
+#pragma once
+
+#include "sv/shader/compilation.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sv {
+
+class IncludeCache;
+
+// Shaders compiled at build time by sv_shader_pack: every stage's SPIR-V and
+// push constant size for each file under the shader directory, keyed by the
+// path relative to that directory. Entries remember the hashes of the source
+// and every include they were built from, so a stale archive is ignored.
+class ShaderArchive final
+{
+public:
+  struct Stage
+  {
+    ShaderStage stage;
+    std::string entry_name{ "main" };
+    std::vector<std::uint8_t> spirv{};
+    std::uint32_t push_constant_size{ 0 };
+  };
+
+  struct Include
+  {
+    // Relative to the archive's directory, like Entry::name.
+    std::string name{};
+    std::uint64_t hash{ 0 };
+  };
+
+  struct Entry
+  {
+    std::string name{};
+    std::uint64_t source_hash{ 0 };
+    std::vector<Include> includes{};
+    // The file declares `#pragma variant`s; only the defaults are packed, so
+    // the source is still parsed (not compiled) to build the others.
+    bool has_variants{ false };
+    std::vector<Stage> stages{};
+  };
+
+  ShaderArchive() = default;
+  explicit ShaderArchive(std::filesystem::path root);
+
+  [[nodiscard]] static auto read(const std::filesystem::path& file)
+    -> std::optional<ShaderArchive>;
+  auto write(const std::filesystem::path& file) const -> bool;
+
+  auto add(Entry entry) -> void { entries.push_back(std::move(entry)); }
+  // `path` as passed to VulkanShader::create, i.e. including the directory
+  // the archive sits in.
+  [[nodiscard]] auto find(const std::filesystem::path& path) const
+    -> const Entry*;
+  // True when the source and includes on disk still hash as they did when
+  // `entry` was packed.
+  [[nodiscard]] auto is_current(const Entry& entry,
+                                IncludeCache& include_cache) const -> bool;
+  [[nodiscard]] auto path_of(std::string_view name) const
+    -> std::filesystem::path
+  {
+    return root / name;
+  }
+  [[nodiscard]] auto get_entries() const -> const std::vector<Entry>&
+  {
+    return entries;
+  }
+
+private:
+  std::filesystem::path root{};
+  std::vector<Entry> entries{};
+};
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "sv/shader/compilation.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace sv {
+
+struct ShaderCacheTelemetry
+{
+  std::uint32_t hits{ 0 };
+  std::uint32_t misses{ 0 };
+  std::chrono::nanoseconds load_time{ 0 };
+  std::chrono::nanoseconds compile_time{ 0 };
+};
+
+// On-disk SPIR-V for VulkanShader::create_batch, one file per stage. Entries
+// are keyed by the preprocessed stage source (so every resolved #include and
+// the preamble are covered), the stage and the compiler identity; anything else
+// reaching the compiler must be folded into the compiler identity.
+class ShaderCache final
+{
+public:
+  struct Stage
+  {
+    std::vector<std::uint8_t> spirv{};
+    std::uint32_t push_constant_size{ 0 };
+  };
+
+  explicit ShaderCache(std::filesystem::path directory);
+
+  ShaderCache(const ShaderCache&) = delete;
+  auto operator=(const ShaderCache&) -> ShaderCache& = delete;
+
+  [[nodiscard]] static auto make_key(std::string_view preprocessed_source,
+                                     ShaderStage,
+                                     std::string_view compiler)
+    -> std::uint64_t;
+
+  // load, store and the record_* calls may run on any thread.
+  auto load(std::uint64_t key) -> std::optional<Stage>;
+  // Writes to a per-thread temporary file and renames it into place.
+  auto store(std::uint64_t key, const Stage&) -> bool;
+
+  auto record_load(std::chrono::nanoseconds elapsed) -> void
+  {
+    std::scoped_lock lock{ telemetry_mutex };
+    telemetry.hits++;
+    telemetry.load_time += elapsed;
+  }
+  auto record_compile(std::chrono::nanoseconds elapsed) -> void
+  {
+    std::scoped_lock lock{ telemetry_mutex };
+    telemetry.misses++;
+    telemetry.compile_time += elapsed;
+  }
+  [[nodiscard]] auto get_telemetry() const -> ShaderCacheTelemetry
+  {
+    std::scoped_lock lock{ telemetry_mutex };
+    return telemetry;
+  }
+
+private:
+  [[nodiscard]] auto path_for(std::uint64_t key) const
+    -> std::filesystem::path;
+
+  std::filesystem::path directory;
+  mutable std::mutex telemetry_mutex;
+  ShaderCacheTelemetry telemetry{};
+};
+
+}
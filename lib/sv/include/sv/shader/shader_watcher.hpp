@@ -0,0 +1,59 @@
+#pragma once
+
+#include "sv/object_handle.hpp"
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sv {
+
+class VulkanContext;
+
+// Watches a shader directory (inotify, Linux only) and recompiles tracked
+// shader files, and the shaders including a changed file, on its own thread.
+// apply() swaps the finished modules into the shader pool; everything but the
+// background thread runs on the context's thread.
+class ShaderWatcher final
+{
+public:
+  ShaderWatcher(VulkanContext&, std::filesystem::path directory);
+  ~ShaderWatcher();
+
+  ShaderWatcher(const ShaderWatcher&) = delete;
+  auto operator=(const ShaderWatcher&) -> ShaderWatcher& = delete;
+
+  // `variant` is the normalised key a variant module was compiled with.
+  auto track(const std::filesystem::path&,
+             ShaderModuleHandle,
+             std::string variant = {}) -> void;
+  auto untrack(ShaderModuleHandle) -> void;
+
+  // Installs every reload finished since the last call; never waits on one.
+  auto apply() -> void;
+
+private:
+  struct Reload;
+  struct Tracked
+  {
+    ShaderModuleHandle handle;
+    std::string variant;
+  };
+
+  auto watch(std::stop_token) -> void;
+  auto reload(const std::filesystem::path& shader) -> void;
+
+  VulkanContext& context;
+  std::filesystem::path directory;
+
+  std::mutex mutex;
+  std::unordered_map<std::filesystem::path, std::vector<Tracked>> tracked;
+  std::vector<Reload> ready;
+
+  std::jthread thread;
+};
+
+}
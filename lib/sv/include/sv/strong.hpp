@@ -65,10 +65,12 @@ struct Strong : Mixins<Strong<T, Tag, Mixins...>, T>...
 struct VertexOffsetTag;
 struct IndexOffsetTag;
 struct CascadeIndexTag;
+struct GraphResourceTag;
 
 using VertexOffset = Strong<std::uint32_t, VertexOffsetTag, Equality, Additive>;
 using IndexOffset = Strong<std::uint32_t, IndexOffsetTag, Equality, Additive>;
 using CascadeIndex = Strong<std::uint32_t, CascadeIndexTag, Equality, Additive>;
+using GraphResource = Strong<std::uint32_t, GraphResourceTag, Equality>;
 
 }
 
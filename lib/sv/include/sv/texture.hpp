@@ -2,6 +2,7 @@
 
 #include "object_handle.hpp"
 #include "sv/common.hpp"
+#include "sv/image_barriers.hpp"
 #include "sv/object_holder.hpp"
 #include "vulkan/vulkan_core.h"
 
@@ -16,6 +17,14 @@ static constexpr auto max_mip_levels_framebuffer = 8ULL;
 static constexpr auto num_faces_cube = 6ULL;
 static constexpr auto max_layers_framebuffer = num_faces_cube;
 
+// Memory a texture is placed in instead of getting its own allocation. The
+// owner keeps it alive and the lifetimes of textures sharing it apart.
+struct AliasedMemory
+{
+  VmaAllocation allocation{ VK_NULL_HANDLE };
+  VkDeviceSize offset{ 0 };
+};
+
 struct TextureDescription
 {
   TextureType type{ TextureType::Two };
@@ -31,6 +40,7 @@ struct TextureDescription
   std::span<const std::byte> pixel_data{};
   std::uint32_t mip_count_pixel_data{ 1 };
   bool generate_mipmaps{ false };
+  AliasedMemory aliased_memory{};
   std::string_view debug_name;
 };
 
@@ -52,7 +62,7 @@ struct VulkanTextureND
   bool is_depth_format = false;
   bool is_stencil_format = false;
   std::string debug_name{};
-  mutable VkImageLayout image_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+  mutable ImageStates states{}; // per mip level and layer
   VkImageView image_view = VK_NULL_HANDLE;         // all levels
   VkImageView storage_image_view = VK_NULL_HANDLE; // identity swizzle
   std::array<std::array<VkImageView, max_layers_framebuffer>,
@@ -101,6 +111,7 @@ struct VulkanTextureND
     swap(is_stencil_format, other.is_stencil_format);
     swap(is_owning_image, other.is_owning_image);
     swap(debug_name, other.debug_name);
+    swap(states, other.states);
     swap(framebuffer_image_views, other.framebuffer_image_views);
   }
 
@@ -113,6 +124,8 @@ struct VulkanTextureND
     -> Holder<TextureHandle>;
 
   static auto build(IContext&, const TextureDescription&) -> VulkanTextureND;
+  static auto memory_requirements(IContext&, const TextureDescription&)
+    -> VkMemoryRequirements;
 
   static auto create(IContext&, const VkSamplerCreateInfo&)
     -> Holder<SamplerHandle>;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sv {
+
+// A fixed set of threads working through a FIFO job queue, so background work
+// (pipeline compiles, relinks) never starts more threads than the pool has.
+// Jobs still queued at destruction are run before the threads are joined, so
+// every future handed out is eventually ready.
+class WorkerPool final
+{
+public:
+  explicit WorkerPool(std::uint32_t thread_count);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  auto operator=(const WorkerPool&) -> WorkerPool& = delete;
+
+  template<typename F>
+  auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+  {
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+    auto task =
+      std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+    auto future = task->get_future();
+    push([task = std::move(task)] { (*task)(); });
+    return future;
+  }
+
+  [[nodiscard]] auto thread_count() const -> std::size_t
+  {
+    return threads.size();
+  }
+
+private:
+  auto push(std::function<void()>&&) -> void;
+  auto work(const std::stop_token&) -> void;
+
+  std::mutex mutex;
+  std::condition_variable_any available;
+  std::deque<std::function<void()>> jobs;
+  std::vector<std::jthread> threads;
+};
+
+}
@@ -0,0 +1,201 @@
+#include "sv/bound_state.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace sv {
+
+namespace {
+
+template<typename T, typename Equal = std::equal_to<T>>
+auto
+update(std::optional<T>& slot,
+       const T& value,
+       std::uint64_t& skipped,
+       Equal equal = {}) -> bool
+{
+  if (slot && equal(*slot, value)) {
+    skipped++;
+    return false;
+  }
+  slot = value;
+  return true;
+}
+
+auto
+update(VkPipelineLayout& slot, VkPipelineLayout value) -> bool
+{
+  if (slot == value)
+    return false;
+  slot = value;
+  return true;
+}
+
+}
+
+auto
+StateFilterTelemetry::operator+=(const StateFilterTelemetry& other)
+  -> StateFilterTelemetry&
+{
+  pipelines += other.pipelines;
+  vertex_buffers += other.vertex_buffers;
+  index_buffers += other.index_buffers;
+  depth_state += other.depth_state;
+  viewports += other.viewports;
+  scissors += other.scissors;
+  push_constants += other.push_constants;
+  return *this;
+}
+
+auto
+StateFilterTelemetry::total() const -> std::uint64_t
+{
+  return pipelines + vertex_buffers + index_buffers + depth_state +
+         viewports + scissors + push_constants;
+}
+
+auto
+BoundState::begin_pass() -> void
+{
+  vertex_buffers = {};
+  index.reset();
+  depth_test_enabled.reset();
+  depth_compare_op.reset();
+  depth_write_enabled.reset();
+  depth_bias_enabled.reset();
+  viewport_bound.reset();
+  scissor_bound.reset();
+  push.reset();
+}
+
+auto
+BoundState::pipeline(VkPipeline value) -> bool
+{
+  if (pipeline_bound == value) {
+    skipped.pipelines++;
+    return false;
+  }
+  pipeline_bound = value;
+  return true;
+}
+
+auto
+BoundState::graphics_layout(VkPipelineLayout value) -> bool
+{
+  if (!update(graphics_layout_bound, value))
+    return false;
+  push.reset();
+  return true;
+}
+
+auto
+BoundState::compute_layout(VkPipelineLayout value) -> bool
+{
+  if (!update(compute_layout_bound, value))
+    return false;
+  push.reset();
+  return true;
+}
+
+auto
+BoundState::vertex_buffer(std::uint32_t binding,
+                          VkBuffer buffer,
+                          VkDeviceSize offset) -> bool
+{
+  if (binding >= max_vertex_buffers)
+    return true;
+  return update(vertex_buffers[binding],
+                VertexBinding{ buffer, offset },
+                skipped.vertex_buffers,
+                [](const VertexBinding& a, const VertexBinding& b) {
+                  return a.buffer == b.buffer && a.offset == b.offset;
+                });
+}
+
+auto
+BoundState::index_buffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type)
+  -> bool
+{
+  return update(index,
+                IndexBinding{ buffer, offset, type },
+                skipped.index_buffers,
+                [](const IndexBinding& a, const IndexBinding& b) {
+                  return a.buffer == b.buffer && a.offset == b.offset &&
+                         a.type == b.type;
+                });
+}
+
+auto
+BoundState::depth_test(VkBool32 value) -> bool
+{
+  return update(depth_test_enabled, value, skipped.depth_state);
+}
+
+auto
+BoundState::depth_compare(VkCompareOp value) -> bool
+{
+  return update(depth_compare_op, value, skipped.depth_state);
+}
+
+auto
+BoundState::depth_write(VkBool32 value) -> bool
+{
+  return update(depth_write_enabled, value, skipped.depth_state);
+}
+
+auto
+BoundState::depth_bias(VkBool32 value) -> bool
+{
+  return update(depth_bias_enabled, value, skipped.depth_state);
+}
+
+auto
+BoundState::viewport(const VkViewport& value) -> bool
+{
+  return update(viewport_bound,
+                value,
+                skipped.viewports,
+                [](const VkViewport& a, const VkViewport& b) {
+                  return a.x == b.x && a.y == b.y && a.width == b.width &&
+                         a.height == b.height && a.minDepth == b.minDepth &&
+                         a.maxDepth == b.maxDepth;
+                });
+}
+
+auto
+BoundState::scissor(const VkRect2D& value) -> bool
+{
+  return update(scissor_bound,
+                value,
+                skipped.scissors,
+                [](const VkRect2D& a, const VkRect2D& b) {
+                  return a.offset.x == b.offset.x &&
+                         a.offset.y == b.offset.y &&
+                         a.extent.width == b.extent.width &&
+                         a.extent.height == b.extent.height;
+                });
+}
+
+auto
+BoundState::push_constants(VkPipelineLayout layout,
+                           VkShaderStageFlags stages,
+                           std::span<const std::byte> data) -> bool
+{
+  if (data.size() > max_push_constant_size) {
+    push.reset();
+    return true;
+  }
+  if (push && push->layout == layout && push->stages == stages &&
+      std::ranges::equal(std::span{ push->data }.first(push->size), data)) {
+    skipped.push_constants++;
+    return false;
+  }
+  push.emplace();
+  push->layout = layout;
+  push->stages = stages;
+  push->size = static_cast<std::uint32_t>(data.size());
+  std::ranges::copy(data, push->data.begin());
+  return true;
+}
+
+}
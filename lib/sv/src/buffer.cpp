@@ -117,7 +117,7 @@ VulkanDeviceBuffer::create(IContext& ctx, const BufferDescription& w)
     memory_flags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
   }
 
-  assert(!description.debug_name.empty());
+  assert(!names_objects(ctx) || !description.debug_name.empty());
   const auto handle = create_buffer(
     ctx, description.size, usage_flags, memory_flags, description.debug_name);
   auto* buffer = ctx.get_buffer_pool().get(handle);
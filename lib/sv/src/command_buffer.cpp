@@ -2,9 +2,10 @@
 
 #include "sv/bindless.hpp"
 #include "sv/context.hpp"
-#include "sv/transitions.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <vulkan/vulkan_core.h>
@@ -29,6 +30,58 @@ constexpr auto sample_count_more_than_one = [](VkSampleCountFlagBits sc) {
   }
 };
 
+auto
+aspect_of(const VulkanTextureND& texture) -> VkImageAspectFlags
+{
+  if (!texture.is_depth_format && !texture.is_stencil_format)
+    return VK_IMAGE_ASPECT_COLOR_BIT;
+  VkImageAspectFlags aspect = 0;
+  if (texture.is_depth_format)
+    aspect |= VK_IMAGE_ASPECT_DEPTH_BIT;
+  if (texture.is_stencil_format)
+    aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+  return aspect;
+}
+
+auto
+attachment_range(const VulkanTextureND& texture,
+                 std::uint32_t level,
+                 std::uint32_t layer) -> VkImageSubresourceRange
+{
+  return { aspect_of(texture), level, 1, layer, 1 };
+}
+
+// Shader objects have no pipeline to fix the viewport count.
+auto
+set_viewport(const VulkanContext& context,
+             BoundState& bound,
+             VkCommandBuffer cmd,
+             const VkViewport& viewport) -> void
+{
+  if (!bound.viewport(viewport))
+    return;
+  if (context.uses_shader_objects()) {
+    vkCmdSetViewportWithCount(cmd, 1, &viewport);
+  } else {
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+  }
+}
+
+auto
+set_scissor(const VulkanContext& context,
+            BoundState& bound,
+            VkCommandBuffer cmd,
+            const VkRect2D& rect) -> void
+{
+  if (!bound.scissor(rect))
+    return;
+  if (context.uses_shader_objects()) {
+    vkCmdSetScissorWithCount(cmd, 1, &rect);
+  } else {
+    vkCmdSetScissor(cmd, 0, 1, &rect);
+  }
+}
+
 auto
 set_clear_colour(VkClearColorValue& dst, const ClearColourValue& src) -> void
 {
@@ -131,15 +184,21 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
 
   is_rendering = true;
   view_mask = render_pass.view_mask;
+  bound.begin_pass();
 
+  // Every barrier the pass needs goes out in one batch before it begins.
   for (std::uint32_t i = 0;
        i != Dependencies::max_dependencies && deps.textures[i];
        i++) {
     auto* image = context->get_texture_pool().get(deps.textures[i]);
-    Transition::image(wrapper->command_buffer,
-                      image->image,
-                      VK_IMAGE_LAYOUT_UNDEFINED,
-                      VK_IMAGE_LAYOUT_GENERAL);
+    barriers.require(image->image,
+                     image->states,
+                     { aspect_of(*image),
+                       0,
+                       VK_REMAINING_MIP_LEVELS,
+                       0,
+                       VK_REMAINING_ARRAY_LAYERS },
+                     dependency_usage);
   }
 
   const std::uint32_t framebuffer_colour_attachment_count =
@@ -147,23 +206,6 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
 
   framebuffer = fb;
 
-  for (std::uint32_t i = 0; i != framebuffer_colour_attachment_count; i++) {
-    if (const auto& handle = fb.color[i].texture; handle) {
-      auto* texture = context->get_texture_pool().get(handle);
-      Transition::image(wrapper->command_buffer,
-                        texture->image,
-                        VK_IMAGE_LAYOUT_UNDEFINED,
-                        VK_IMAGE_LAYOUT_GENERAL);
-    }
-    if (const auto& handle = fb.color[i].resolve_texture; handle) {
-      auto* color_resolve_texture = context->get_texture_pool().get(handle);
-      Transition::image(wrapper->command_buffer,
-                        color_resolve_texture->image,
-                        VK_IMAGE_LAYOUT_UNDEFINED,
-                        VK_IMAGE_LAYOUT_GENERAL);
-    }
-  }
-
   TextureHandle depth_texture = fb.depth_stencil.texture;
 
   VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
@@ -180,6 +222,11 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
 
     auto* color_texture = context->get_texture_pool().get(texture);
     const auto& desc_color = render_pass.color[i];
+    barriers.require(
+      color_texture->image,
+      color_texture->states,
+      attachment_range(*color_texture, desc_color.level, desc_color.layer),
+      colour_attachment_usage(desc_color.load_op != LoadOp::Load));
     if (mip_level && desc_color.level) {
       assert(desc_color.level == mip_level &&
              "All color attachments should have the same mip-level");
@@ -224,6 +271,12 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
              "Framebuffer attachment should contain a resolve texture");
       auto* colour_resolve_texture =
         context->get_texture_pool().get(resolve_texture);
+      barriers.require(colour_resolve_texture->image,
+                       colour_resolve_texture->states,
+                       attachment_range(*colour_resolve_texture,
+                                        desc_color.level,
+                                        desc_color.layer),
+                       resolve_attachment_usage);
       colour_attachments[i].resolveImageView =
         colour_resolve_texture->get_or_create_image_view_for_framebuffer(
           *context, desc_color.level, desc_color.layer);
@@ -240,6 +293,11 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
     assert(
       desc_depth.level == mip_level &&
       "Depth attachment should have the same mip-level as color attachments");
+    barriers.require(
+      depth_texture_obj->image,
+      depth_texture_obj->states,
+      attachment_range(*depth_texture_obj, desc_depth.level, desc_depth.layer),
+      depth_attachment_usage(desc_depth.load_op != LoadOp::Load));
     depth_attachment = {
       .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
       .pNext = nullptr,
@@ -264,6 +322,12 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
              "Framebuffer depth attachment should contain a resolve texture");
       auto* depth_resolve_texture =
         context->get_texture_pool().get(attachment.resolve_texture);
+      barriers.require(depth_resolve_texture->image,
+                       depth_resolve_texture->states,
+                       attachment_range(*depth_resolve_texture,
+                                        desc_depth.level,
+                                        desc_depth.layer),
+                       resolve_attachment_usage);
       depth_attachment.resolveImageView =
         depth_resolve_texture->get_or_create_image_view_for_framebuffer(
           *context, desc_depth.level, desc_depth.layer);
@@ -320,18 +384,38 @@ CommandBuffer::cmd_begin_rendering(const RenderPass& render_pass,
     .minDepth = viewport.minDepth,
     .maxDepth = viewport.maxDepth,
   };
-  vkCmdSetViewport(wrapper->command_buffer, 0, 1, &vp);
+  set_viewport(*context, bound, wrapper->command_buffer, vp);
 
   VkRect2D rect = { .offset = { static_cast<std::int32_t>(scissor.x),
                                 static_cast<std::int32_t>(scissor.y), },
                     .extent = { scissor.width, scissor.height, }, };
-  vkCmdSetScissor(wrapper->command_buffer, 0, 1, &rect);
+  set_scissor(*context, bound, wrapper->command_buffer, rect);
 
   Bindless<VulkanContext>::sync_on_frame_acquire(*context);
 
+  barriers.flush(wrapper->command_buffer, context->barrier_telemetry);
   vkCmdBeginRendering(wrapper->command_buffer, &rendering_info);
 }
 
+auto
+CommandBuffer::cmd_transition_image(TextureHandle handle,
+                                    const ImageUsage& usage) -> void
+{
+  assert(!is_rendering && "Images cannot change layout while rendering");
+  auto* texture = context->get_texture_pool().get(handle);
+  if (!texture)
+    return;
+  barriers.require(texture->image,
+                   texture->states,
+                   { aspect_of(*texture),
+                     0,
+                     VK_REMAINING_MIP_LEVELS,
+                     0,
+                     VK_REMAINING_ARRAY_LAYERS },
+                   usage);
+  barriers.flush(wrapper->command_buffer, context->barrier_telemetry);
+}
+
 auto
 CommandBuffer::cmd_end_rendering() -> void
 {
@@ -352,7 +436,7 @@ CommandBuffer::cmd_bind_viewport(const Viewport& viewport) -> void
     .minDepth = viewport.minDepth,
     .maxDepth = viewport.maxDepth,
   };
-  vkCmdSetViewport(wrapper->command_buffer, 0, 1, &vp);
+  set_viewport(*context, bound, wrapper->command_buffer, vp);
 }
 
 auto
@@ -362,20 +446,68 @@ CommandBuffer::cmd_bind_scissor_rect(const ScissorRect& rect) -> void
   VkRect2D vk_rect = { .offset = { static_cast<std::int32_t>(rect.x),
                                    static_cast<std::int32_t>(rect.y), },
                        .extent = { rect.width, rect.height, }, };
-  vkCmdSetScissor(wrapper->command_buffer, 0, 1, &vk_rect);
+  set_scissor(*context, bound, wrapper->command_buffer, vk_rect);
 }
 
 auto
 CommandBuffer::cmd_bind_depth_state(const DepthState& state) -> void
 {
   assert(is_rendering && "Depth state can only be bound during rendering");
-  vkCmdSetDepthTestEnable(wrapper->command_buffer,
-                          state.is_depth_test_enabled ? VK_TRUE : VK_FALSE);
-  vkCmdSetDepthCompareOp(wrapper->command_buffer,
-                         static_cast<VkCompareOp>(state.compare_operation));
-  vkCmdSetDepthWriteEnable(wrapper->command_buffer,
-                           state.is_depth_write_enabled ? VK_TRUE : VK_FALSE);
-  vkCmdSetDepthBiasEnable(wrapper->command_buffer, VK_FALSE);
+  const auto cmd = wrapper->command_buffer;
+  const VkBool32 test = state.is_depth_test_enabled ? VK_TRUE : VK_FALSE;
+  const auto compare = static_cast<VkCompareOp>(state.compare_operation);
+  const VkBool32 write = state.is_depth_write_enabled ? VK_TRUE : VK_FALSE;
+  if (bound.depth_test(test))
+    vkCmdSetDepthTestEnable(cmd, test);
+  if (bound.depth_compare(compare))
+    vkCmdSetDepthCompareOp(cmd, compare);
+  if (bound.depth_write(write))
+    vkCmdSetDepthWriteEnable(cmd, write);
+  if (bound.depth_bias(VK_FALSE))
+    vkCmdSetDepthBiasEnable(cmd, VK_FALSE);
+}
+
+auto
+CommandBuffer::cmd_set_cull_mode(const CullMode mode) -> void
+{
+  if (context->can_set_dynamic_pipeline_state()) {
+    context->set_cull_mode(wrapper->command_buffer, mode);
+  }
+}
+
+auto
+CommandBuffer::cmd_set_winding(const WindingMode winding) -> void
+{
+  if (context->can_set_dynamic_pipeline_state()) {
+    context->set_winding(wrapper->command_buffer, winding);
+  }
+}
+
+auto
+CommandBuffer::cmd_set_polygon_mode(const PolygonMode mode) -> void
+{
+  if (context->can_set_dynamic_pipeline_state()) {
+    context->set_polygon_mode(wrapper->command_buffer, mode);
+  }
+}
+
+auto
+CommandBuffer::cmd_set_blend_state(const std::uint32_t attachment,
+                                   const ColourAttachment& state) -> void
+{
+  if (context->can_set_dynamic_pipeline_state()) {
+    context->set_blend_state(
+      wrapper->command_buffer, attachment, std::span{ &state, 1 });
+  }
+}
+
+auto
+CommandBuffer::cmd_set_colour_write_mask(const std::uint32_t attachment,
+                                         const ColourWriteMask mask) -> void
+{
+  if (context->can_set_dynamic_pipeline_state()) {
+    context->set_colour_write_mask(wrapper->command_buffer, attachment, mask);
+  }
 }
 
 auto
@@ -385,6 +517,9 @@ CommandBuffer::cmd_draw(std::uint32_t vertex_count,
                         std::uint32_t base_instance) -> void
 {
   assert(is_rendering && "Draw can only be called during rendering");
+  if (skip_draws) {
+    return;
+  }
   vkCmdDraw(wrapper->command_buffer,
             vertex_count,
             instance_count,
@@ -400,6 +535,9 @@ CommandBuffer::cmd_draw_indexed(std::uint32_t index_count,
                                 std::uint32_t base_instance) -> void
 {
   assert(is_rendering && "Draw indexed can only be called during rendering");
+  if (skip_draws) {
+    return;
+  }
   vkCmdDrawIndexed(wrapper->command_buffer,
                    index_count,
                    instance_count,
@@ -414,6 +552,10 @@ CommandBuffer::cmd_draw_indexed_indirect(BufferHandle indirect_buffer,
                                          uint32_t draw_count,
                                          uint32_t stride) -> void
 {
+  if (skip_draws) {
+    return;
+  }
+
   auto* indirect = context->get_buffer_pool().get(indirect_buffer);
 
   vkCmdDrawIndexedIndirect(wrapper->command_buffer,
@@ -424,6 +566,74 @@ CommandBuffer::cmd_draw_indexed_indirect(BufferHandle indirect_buffer,
                                   : sizeof(VkDrawIndexedIndirectCommand));
 }
 
+auto
+CommandBuffer::cmd_draw_indexed_indirect_count(BufferHandle indirect_buffer,
+                                               std::size_t indirect_offset,
+                                               BufferHandle count_buffer,
+                                               std::size_t count_offset,
+                                               std::uint32_t max_draw_count,
+                                               std::uint32_t stride) -> void
+{
+  assert(is_rendering && "Draw can only be called during rendering");
+  if (skip_draws) {
+    return;
+  }
+
+  auto& buffers = context->get_buffer_pool();
+  const auto* indirect = buffers.get(indirect_buffer);
+  const auto* count = buffers.get(count_buffer);
+
+  vkCmdDrawIndexedIndirectCount(wrapper->command_buffer,
+                                indirect->get_buffer(),
+                                indirect_offset,
+                                count->get_buffer(),
+                                count_offset,
+                                max_draw_count,
+                                stride ? stride
+                                       : sizeof(VkDrawIndexedIndirectCommand));
+}
+
+auto
+CommandBuffer::cmd_draw_multi_indexed(std::span<const MultiDrawIndexed> draws,
+                                      std::uint32_t instance_count,
+                                      std::uint32_t first_instance) -> void
+{
+  static_assert(sizeof(MultiDrawIndexed) == sizeof(VkMultiDrawIndexedInfoEXT));
+  static_assert(offsetof(MultiDrawIndexed, vertex_offset) ==
+                offsetof(VkMultiDrawIndexedInfoEXT, vertexOffset));
+
+  assert(is_rendering && "Draw can only be called during rendering");
+  if (skip_draws || draws.empty()) {
+    return;
+  }
+
+  const auto limit = context->get_max_multi_draw_count();
+  if (limit == 0) {
+    for (const auto& draw : draws) {
+      vkCmdDrawIndexed(wrapper->command_buffer,
+                       draw.index_count,
+                       instance_count,
+                       draw.first_index,
+                       draw.vertex_offset,
+                       first_instance);
+    }
+    return;
+  }
+
+  for (std::size_t first = 0; first < draws.size(); first += limit) {
+    const auto chunk = draws.subspan(
+      first, std::min<std::size_t>(limit, draws.size() - first));
+    context->dispatch<VKB_MEMBER(vkCmdDrawMultiIndexedEXT)>(
+      wrapper->command_buffer,
+      static_cast<std::uint32_t>(chunk.size()),
+      reinterpret_cast<const VkMultiDrawIndexedInfoEXT*>(chunk.data()),
+      instance_count,
+      first_instance,
+      static_cast<std::uint32_t>(sizeof(MultiDrawIndexed)),
+      nullptr);
+  }
+}
+
 auto
 CommandBuffer::cmd_dispatch_thread_groups(const Dimensions& xyz) -> void
 {
@@ -450,10 +660,13 @@ CommandBuffer::cmd_bind_compute_pipeline(ComputePipelineHandle handle) -> void
 
   assert(vk_pipeline != VK_NULL_HANDLE);
 
-  if (last_pipeline_bound != vk_pipeline) {
-    last_pipeline_bound = vk_pipeline;
+  if (bound.pipeline(vk_pipeline)) {
     vkCmdBindPipeline(
       wrapper->command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, vk_pipeline);
+  }
+  // Pipeline layouts are shared, so a switch between pipelines with the same
+  // layout keeps the bound descriptors and push constants valid.
+  if (bound.compute_layout(pipeline->get_layout())) {
     context->bind_default_descriptor_sets(wrapper->command_buffer,
                                           VK_PIPELINE_BIND_POINT_COMPUTE,
                                           pipeline->get_layout());
@@ -483,17 +696,44 @@ CommandBuffer::cmd_bind_graphics_pipeline(const GraphicsPipelineHandle handle)
     assert(false);
   }
 
-  const auto vk_pipeline = context->get_pipeline(handle /*viewMask??*/);
+  if (context->uses_shader_objects()) {
+    const auto layout =
+      context->bind_shader_objects(wrapper->command_buffer, handle);
+    skip_draws = layout == VK_NULL_HANDLE;
+    bound.forget_pipeline();
+    if (!skip_draws && bound.graphics_layout(layout)) {
+      context->bind_default_descriptor_sets(
+        wrapper->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout);
+    }
+    return;
+  }
 
-  assert(vk_pipeline != VK_NULL_HANDLE);
+  // Variants draw with, and push constants through, the pipeline they share.
+  const auto owner =
+    pipeline->variant_of.valid() ? pipeline->variant_of : handle;
+  current_pipeline_graphics = owner;
+
+  const auto vk_pipeline = context->get_pipeline(owner /*viewMask??*/);
+
+  // Still compiling in the background; draws are dropped until it lands.
+  skip_draws = vk_pipeline == VK_NULL_HANDLE;
+  if (skip_draws) {
+    return;
+  }
 
-  if (last_pipeline_bound != vk_pipeline) {
-    last_pipeline_bound = vk_pipeline;
+  if (bound.pipeline(vk_pipeline)) {
     vkCmdBindPipeline(
       wrapper->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline);
-    context->bind_default_descriptor_sets(wrapper->command_buffer,
-                                          VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                          pipeline->get_layout());
+  }
+  const auto layout =
+    context->get_graphics_pipeline_pool().get(owner)->get_layout();
+  if (bound.graphics_layout(layout)) {
+    context->bind_default_descriptor_sets(
+      wrapper->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout);
+  }
+  if (context->has_dynamic_pipeline_state()) {
+    context->apply_dynamic_pipeline_state(wrapper->command_buffer,
+                                          pipeline->description);
   }
 }
 
@@ -531,6 +771,8 @@ CommandBuffer::cmd_push_constants(const std::span<const std::byte> data) -> void
     std::cerr << "Pipeline layout is null for push constants." << std::endl;
     return;
   }
+  if (!bound.push_constants(pipeline_layout, stage_flags, data))
+    return;
 
   vkCmdPushConstants(
     wrapper->command_buffer,
@@ -557,10 +799,14 @@ CommandBuffer::cmd_bind_index_buffer(BufferHandle index_buffer,
     return;
   }
 
+  const auto index_type = static_cast<VkIndexType>(index_format);
+  if (!bound.index_buffer(
+        buffer->get_buffer(), index_buffer_offset, index_type))
+    return;
   vkCmdBindIndexBuffer(wrapper->command_buffer,
                        buffer->get_buffer(),
                        index_buffer_offset,
-                       static_cast<VkIndexType>(index_format));
+                       index_type);
 }
 
 void
@@ -569,6 +815,8 @@ CommandBuffer::cmd_bind_vertex_buffer(const std::uint32_t index,
                                       const std::uint64_t buffer_offset)
 {
   const auto* buffer = context->get_buffer_pool().get(vertex_buffer);
+  if (!bound.vertex_buffer(index, buffer->get_buffer(), buffer_offset))
+    return;
 
   const std::array buffers{ buffer->get_buffer() };
   vkCmdBindVertexBuffers2(wrapper->command_buffer,
@@ -0,0 +1,610 @@
+#include "sv/command_stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sv {
+
+namespace {
+
+struct BeginRendering
+{
+  RenderPass render_pass{};
+  std::array<Framebuffer::AttachmentDescription, max_colour_attachments>
+    colour{};
+  Framebuffer::AttachmentDescription depth_stencil{};
+  Dependencies dependencies{};
+  // Followed by the framebuffer's debug name.
+  std::uint32_t name_size{ 0 };
+};
+
+struct TransitionImage
+{
+  TextureHandle texture{};
+  ImageUsage usage{};
+};
+
+struct SetBlendState
+{
+  std::uint32_t attachment{ 0 };
+  ColourAttachment state{};
+};
+
+struct SetColourWriteMask
+{
+  std::uint32_t attachment{ 0 };
+  ColourWriteMask mask{ ColourWriteMask::All };
+};
+
+struct Draw
+{
+  std::uint32_t vertex_count{ 0 };
+  std::uint32_t instance_count{ 0 };
+  std::uint32_t first_vertex{ 0 };
+  std::uint32_t base_instance{ 0 };
+};
+
+struct DrawIndexed
+{
+  std::uint32_t index_count{ 0 };
+  std::uint32_t instance_count{ 0 };
+  std::uint32_t first_index{ 0 };
+  std::int32_t vertex_offset{ 0 };
+  std::uint32_t base_instance{ 0 };
+};
+
+struct DrawIndexedIndirect
+{
+  BufferHandle buffer{};
+  std::uint32_t draw_count{ 0 };
+  std::uint32_t stride{ 0 };
+  std::uint64_t offset{ 0 };
+};
+
+struct DrawIndexedIndirectCount
+{
+  BufferHandle buffer{};
+  BufferHandle count_buffer{};
+  std::uint64_t offset{ 0 };
+  std::uint64_t count_offset{ 0 };
+  std::uint32_t max_draw_count{ 0 };
+  std::uint32_t stride{ 0 };
+};
+
+struct DrawMultiIndexed
+{
+  // Followed by this many MultiDrawIndexed.
+  std::uint32_t draw_count{ 0 };
+  std::uint32_t instance_count{ 0 };
+  std::uint32_t first_instance{ 0 };
+};
+
+struct BindIndexBuffer
+{
+  BufferHandle buffer{};
+  IndexFormat format{ IndexFormat::UI32 };
+  std::uint64_t offset{ 0 };
+};
+
+struct BindVertexBuffer
+{
+  BufferHandle buffer{};
+  std::uint32_t index{ 0 };
+  std::uint64_t offset{ 0 };
+};
+
+template<typename T>
+auto
+as_bytes(const T& value) -> std::span<const std::byte>
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  return { reinterpret_cast<const std::byte*>(&value), sizeof(T) };
+}
+
+class Reader final
+{
+public:
+  explicit Reader(std::span<const std::byte> b)
+    : bytes(b)
+  {
+  }
+
+  template<typename T>
+  auto read() -> T
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  auto take(std::size_t size) -> std::span<const std::byte>
+  {
+    assert(offset + size <= bytes.size());
+    const auto taken = bytes.subspan(offset, size);
+    offset += size;
+    return taken;
+  }
+
+  [[nodiscard]] auto done() const -> bool { return offset == bytes.size(); }
+
+private:
+  std::span<const std::byte> bytes;
+  std::size_t offset{ 0 };
+};
+
+}
+
+auto
+CommandCounts::draws() const -> std::uint32_t
+{
+  return (*this)[CommandType::Draw] + (*this)[CommandType::DrawIndexed] +
+         (*this)[CommandType::DrawIndexedIndirect] +
+         (*this)[CommandType::DrawIndexedIndirectCount] +
+         (*this)[CommandType::DrawMultiIndexed];
+}
+
+auto
+CommandCounts::binds() const -> std::uint32_t
+{
+  return (*this)[CommandType::BindGraphicsPipeline] +
+         (*this)[CommandType::BindComputePipeline] +
+         (*this)[CommandType::BindDepthState] +
+         (*this)[CommandType::BindViewport] +
+         (*this)[CommandType::BindScissorRect] +
+         (*this)[CommandType::BindIndexBuffer] +
+         (*this)[CommandType::BindVertexBuffer];
+}
+
+auto
+CommandCounts::operator+=(const CommandCounts& other) -> CommandCounts&
+{
+  for (std::size_t i = 0; i < by_type.size(); ++i)
+    by_type[i] += other.by_type[i];
+  image_barriers += other.image_barriers;
+  barrier_batches += other.barrier_batches;
+  return *this;
+}
+
+auto
+CommandStream::write(std::span<const std::byte> data) -> void
+{
+  bytes.insert(bytes.end(), data.begin(), data.end());
+}
+
+auto
+CommandStream::clear() -> void
+{
+  bytes.clear();
+  counts = {};
+}
+
+auto
+CommandStream::replay(ICommandBuffer& buf) const -> void
+{
+  Reader reader{ bytes };
+  while (!reader.done()) {
+    switch (reader.read<CommandType>()) {
+      case CommandType::BeginRendering: {
+        const auto begin = reader.read<BeginRendering>();
+        const auto name = reader.take(begin.name_size);
+        Framebuffer framebuffer{
+          .color = begin.colour,
+          .depth_stencil = begin.depth_stencil,
+          .debug_name = std::string{
+            reinterpret_cast<const char*>(name.data()), name.size() },
+        };
+        buf.cmd_begin_rendering(
+          begin.render_pass, framebuffer, begin.dependencies);
+        break;
+      }
+      case CommandType::EndRendering:
+        buf.cmd_end_rendering();
+        break;
+      case CommandType::TransitionImage: {
+        const auto transition = reader.read<TransitionImage>();
+        buf.cmd_transition_image(transition.texture, transition.usage);
+        break;
+      }
+      case CommandType::BindViewport:
+        buf.cmd_bind_viewport(reader.read<Viewport>());
+        break;
+      case CommandType::BindScissorRect:
+        buf.cmd_bind_scissor_rect(reader.read<ScissorRect>());
+        break;
+      case CommandType::BindGraphicsPipeline:
+        buf.cmd_bind_graphics_pipeline(reader.read<GraphicsPipelineHandle>());
+        break;
+      case CommandType::BindComputePipeline:
+        buf.cmd_bind_compute_pipeline(reader.read<ComputePipelineHandle>());
+        break;
+      case CommandType::BindDepthState:
+        buf.cmd_bind_depth_state(reader.read<DepthState>());
+        break;
+      case CommandType::SetCullMode:
+        buf.cmd_set_cull_mode(reader.read<CullMode>());
+        break;
+      case CommandType::SetWinding:
+        buf.cmd_set_winding(reader.read<WindingMode>());
+        break;
+      case CommandType::SetPolygonMode:
+        buf.cmd_set_polygon_mode(reader.read<PolygonMode>());
+        break;
+      case CommandType::SetBlendState: {
+        const auto blend = reader.read<SetBlendState>();
+        buf.cmd_set_blend_state(blend.attachment, blend.state);
+        break;
+      }
+      case CommandType::SetColourWriteMask: {
+        const auto write_mask = reader.read<SetColourWriteMask>();
+        buf.cmd_set_colour_write_mask(write_mask.attachment, write_mask.mask);
+        break;
+      }
+      case CommandType::Draw: {
+        const auto draw = reader.read<Draw>();
+        buf.cmd_draw(draw.vertex_count,
+                     draw.instance_count,
+                     draw.first_vertex,
+                     draw.base_instance);
+        break;
+      }
+      case CommandType::DrawIndexed: {
+        const auto draw = reader.read<DrawIndexed>();
+        buf.cmd_draw_indexed(draw.index_count,
+                             draw.instance_count,
+                             draw.first_index,
+                             draw.vertex_offset,
+                             draw.base_instance);
+        break;
+      }
+      case CommandType::DrawIndexedIndirect: {
+        const auto draw = reader.read<DrawIndexedIndirect>();
+        buf.cmd_draw_indexed_indirect(draw.buffer,
+                                      static_cast<std::size_t>(draw.offset),
+                                      draw.draw_count,
+                                      draw.stride);
+        break;
+      }
+      case CommandType::DrawIndexedIndirectCount: {
+        const auto draw = reader.read<DrawIndexedIndirectCount>();
+        buf.cmd_draw_indexed_indirect_count(
+          draw.buffer,
+          static_cast<std::size_t>(draw.offset),
+          draw.count_buffer,
+          static_cast<std::size_t>(draw.count_offset),
+          draw.max_draw_count,
+          draw.stride);
+        break;
+      }
+      case CommandType::DrawMultiIndexed: {
+        const auto draw = reader.read<DrawMultiIndexed>();
+        std::vector<MultiDrawIndexed> draws(draw.draw_count);
+        const auto packed =
+          reader.take(draw.draw_count * sizeof(MultiDrawIndexed));
+        std::memcpy(draws.data(), packed.data(), packed.size());
+        buf.cmd_draw_multi_indexed(
+          draws, draw.instance_count, draw.first_instance);
+        break;
+      }
+      case CommandType::DispatchThreadGroups:
+        buf.cmd_dispatch_thread_groups(reader.read<Dimensions>());
+        break;
+      case CommandType::PushConstants: {
+        const auto size = reader.read<std::uint32_t>();
+        buf.cmd_push_constants(reader.take(size));
+        break;
+      }
+      case CommandType::BindIndexBuffer: {
+        const auto bind = reader.read<BindIndexBuffer>();
+        buf.cmd_bind_index_buffer(bind.buffer, bind.format, bind.offset);
+        break;
+      }
+      case CommandType::BindVertexBuffer: {
+        const auto bind = reader.read<BindVertexBuffer>();
+        buf.cmd_bind_vertex_buffer(bind.index, bind.buffer, bind.offset);
+        break;
+      }
+      case CommandType::Count:
+        assert(false && "Corrupt command stream");
+        return;
+    }
+  }
+}
+
+template<typename T>
+auto
+CommandRecorder::record(CommandType type, const T& payload) -> void
+{
+  record(type);
+  stream.write(as_bytes(payload));
+}
+
+auto
+CommandRecorder::record(CommandType type) -> void
+{
+  stream.write(as_bytes(type));
+  stream.counts.by_type[static_cast<std::size_t>(type)]++;
+}
+
+auto
+CommandRecorder::take() -> CommandStream
+{
+  return std::exchange(stream, CommandStream{});
+}
+
+auto
+CommandRecorder::states_for(TextureHandle texture,
+                            std::uint32_t level,
+                            std::uint32_t layer) -> ImageStates&
+{
+  auto& states = image_states[texture];
+  if (level < states.get_level_count() && layer < states.get_layer_count())
+    return states;
+
+  ImageStates grown{ std::max(states.get_level_count(), level + 1),
+                     std::max(states.get_layer_count(), layer + 1) };
+  for (auto l = 0U; l < states.get_level_count(); ++l) {
+    for (auto y = 0U; y < states.get_layer_count(); ++y)
+      grown.get(l, y) = states.get(l, y);
+  }
+  states = std::move(grown);
+  return states;
+}
+
+auto
+CommandRecorder::count_barriers(const ImageBarrierBatch& batch) -> void
+{
+  const auto pending = static_cast<std::uint32_t>(batch.pending().size());
+  stream.counts.image_barriers += pending;
+  stream.counts.barrier_batches += pending > 0 ? 1 : 0;
+}
+
+auto
+CommandRecorder::cmd_begin_rendering(const RenderPass& render_pass,
+                                     const Framebuffer& framebuffer,
+                                     const Dependencies& deps) -> void
+{
+  record(CommandType::BeginRendering,
+         BeginRendering{
+           .render_pass = render_pass,
+           .colour = framebuffer.color,
+           .depth_stencil = framebuffer.depth_stencil,
+           .dependencies = deps,
+           .name_size =
+             static_cast<std::uint32_t>(framebuffer.debug_name.size()),
+         });
+  stream.write(std::as_bytes(std::span{ framebuffer.debug_name }));
+
+  // The same requests, in the same order, as CommandBuffer's pass batch.
+  constexpr VkImageSubresourceRange whole_image{
+    0, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS
+  };
+  const auto single = [](std::uint32_t level, std::uint32_t layer) {
+    return VkImageSubresourceRange{ 0, level, 1, layer, 1 };
+  };
+  ImageBarrierBatch batch;
+  for (std::uint32_t i = 0;
+       i != Dependencies::max_dependencies && deps.textures[i];
+       i++) {
+    batch.require(VK_NULL_HANDLE,
+                  states_for(deps.textures[i], 0, 0),
+                  whole_image,
+                  dependency_usage);
+  }
+  for (std::uint32_t i = 0; i != framebuffer.get_colour_attachment_count();
+       i++) {
+    const auto& [texture, resolve_texture] = framebuffer.color[i];
+    const auto& desc = render_pass.color[i];
+    batch.require(VK_NULL_HANDLE,
+                  states_for(texture, desc.level, desc.layer),
+                  single(desc.level, desc.layer),
+                  colour_attachment_usage(desc.load_op != LoadOp::Load));
+    if (desc.store_op == StoreOp::MsaaResolve && resolve_texture) {
+      batch.require(VK_NULL_HANDLE,
+                    states_for(resolve_texture, desc.level, desc.layer),
+                    single(desc.level, desc.layer),
+                    resolve_attachment_usage);
+    }
+  }
+  if (const auto& [texture, resolve_texture] = framebuffer.depth_stencil;
+      texture) {
+    const auto& desc = render_pass.depth;
+    batch.require(VK_NULL_HANDLE,
+                  states_for(texture, desc.level, desc.layer),
+                  single(desc.level, desc.layer),
+                  depth_attachment_usage(desc.load_op != LoadOp::Load));
+    if (desc.store_op == StoreOp::MsaaResolve && resolve_texture) {
+      batch.require(VK_NULL_HANDLE,
+                    states_for(resolve_texture, desc.level, desc.layer),
+                    single(desc.level, desc.layer),
+                    resolve_attachment_usage);
+    }
+  }
+  count_barriers(batch);
+}
+
+auto
+CommandRecorder::cmd_end_rendering() -> void
+{
+  record(CommandType::EndRendering);
+}
+
+auto
+CommandRecorder::cmd_transition_image(TextureHandle texture,
+                                      const ImageUsage& usage) -> void
+{
+  record(CommandType::TransitionImage, TransitionImage{ texture, usage });
+
+  ImageBarrierBatch batch;
+  batch.require(VK_NULL_HANDLE,
+                states_for(texture, 0, 0),
+                { 0, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS },
+                usage);
+  count_barriers(batch);
+}
+
+auto
+CommandRecorder::cmd_bind_viewport(const Viewport& viewport) -> void
+{
+  record(CommandType::BindViewport, viewport);
+}
+
+auto
+CommandRecorder::cmd_bind_scissor_rect(const ScissorRect& rect) -> void
+{
+  record(CommandType::BindScissorRect, rect);
+}
+
+auto
+CommandRecorder::cmd_bind_graphics_pipeline(GraphicsPipelineHandle handle)
+  -> void
+{
+  record(CommandType::BindGraphicsPipeline, handle);
+}
+
+auto
+CommandRecorder::cmd_bind_compute_pipeline(ComputePipelineHandle handle)
+  -> void
+{
+  record(CommandType::BindComputePipeline, handle);
+}
+
+auto
+CommandRecorder::cmd_bind_depth_state(const DepthState& state) -> void
+{
+  record(CommandType::BindDepthState, state);
+}
+
+auto
+CommandRecorder::cmd_set_cull_mode(CullMode mode) -> void
+{
+  record(CommandType::SetCullMode, mode);
+}
+
+auto
+CommandRecorder::cmd_set_winding(WindingMode mode) -> void
+{
+  record(CommandType::SetWinding, mode);
+}
+
+auto
+CommandRecorder::cmd_set_polygon_mode(PolygonMode mode) -> void
+{
+  record(CommandType::SetPolygonMode, mode);
+}
+
+auto
+CommandRecorder::cmd_set_blend_state(std::uint32_t attachment,
+                                     const ColourAttachment& state) -> void
+{
+  record(CommandType::SetBlendState, SetBlendState{ attachment, state });
+}
+
+auto
+CommandRecorder::cmd_set_colour_write_mask(std::uint32_t attachment,
+                                           ColourWriteMask mask) -> void
+{
+  record(CommandType::SetColourWriteMask,
+         SetColourWriteMask{ attachment, mask });
+}
+
+auto
+CommandRecorder::cmd_draw(std::uint32_t vertex_count,
+                          std::uint32_t instance_count,
+                          std::uint32_t first_vertex,
+                          std::uint32_t base_instance) -> void
+{
+  record(CommandType::Draw,
+         Draw{ vertex_count, instance_count, first_vertex, base_instance });
+}
+
+auto
+CommandRecorder::cmd_draw_indexed(std::uint32_t index_count,
+                                  std::uint32_t instance_count,
+                                  std::uint32_t first_index,
+                                  std::int32_t vertex_offset,
+                                  std::uint32_t base_instance) -> void
+{
+  record(CommandType::DrawIndexed,
+         DrawIndexed{ index_count,
+                      instance_count,
+                      first_index,
+                      vertex_offset,
+                      base_instance });
+}
+
+auto
+CommandRecorder::cmd_draw_indexed_indirect(BufferHandle buffer,
+                                           std::size_t offset,
+                                           std::uint32_t draw_count,
+                                           std::uint32_t stride) -> void
+{
+  record(CommandType::DrawIndexedIndirect,
+         DrawIndexedIndirect{ buffer, draw_count, stride, offset });
+}
+
+auto
+CommandRecorder::cmd_draw_indexed_indirect_count(BufferHandle buffer,
+                                                 std::size_t offset,
+                                                 BufferHandle count_buffer,
+                                                 std::size_t count_offset,
+                                                 std::uint32_t max_draw_count,
+                                                 std::uint32_t stride) -> void
+{
+  record(CommandType::DrawIndexedIndirectCount,
+         DrawIndexedIndirectCount{ buffer,
+                                   count_buffer,
+                                   offset,
+                                   count_offset,
+                                   max_draw_count,
+                                   stride });
+}
+
+auto
+CommandRecorder::cmd_draw_multi_indexed(std::span<const MultiDrawIndexed> draws,
+                                        std::uint32_t instance_count,
+                                        std::uint32_t first_instance) -> void
+{
+  record(CommandType::DrawMultiIndexed,
+         DrawMultiIndexed{ static_cast<std::uint32_t>(draws.size()),
+                           instance_count,
+                           first_instance });
+  stream.write(std::as_bytes(draws));
+}
+
+auto
+CommandRecorder::cmd_dispatch_thread_groups(const Dimensions& groups) -> void
+{
+  record(CommandType::DispatchThreadGroups, groups);
+}
+
+auto
+CommandRecorder::cmd_push_constants(std::span<const std::byte> data) -> void
+{
+  record(CommandType::PushConstants, static_cast<std::uint32_t>(data.size()));
+  stream.write(data);
+}
+
+auto
+CommandRecorder::cmd_bind_index_buffer(BufferHandle buffer,
+                                       IndexFormat format,
+                                       std::uint64_t offset) -> void
+{
+  record(CommandType::BindIndexBuffer,
+         BindIndexBuffer{ buffer, format, offset });
+}
+
+auto
+CommandRecorder::cmd_bind_vertex_buffer(std::uint32_t index,
+                                        BufferHandle buffer,
+                                        std::uint64_t offset) -> void
+{
+  record(CommandType::BindVertexBuffer,
+         BindVertexBuffer{ buffer, index, offset });
+}
+
+}
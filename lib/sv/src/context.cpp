@@ -7,7 +7,6 @@
 #include "sv/bindless_access.hpp"
 #include "sv/object_handle.hpp"
 #include "sv/texture.hpp"
-#include "sv/transitions.hpp"
 
 #include "sv/app.hpp"
 #include "sv/common.hpp"
@@ -16,9 +15,15 @@
 #include "vulkan/vulkan_core.h"
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
 
 namespace sv {
 
@@ -93,6 +98,36 @@ static constexpr auto get_pipeline_specialisation_info =
     };
   };
 
+template<typename... Ts>
+auto
+pack_key(std::string& key, const Ts&... values) -> void
+{
+  static_assert((std::is_trivially_copyable_v<Ts> && ...));
+  (key.append(reinterpret_cast<const char*>(&values), sizeof(Ts)), ...);
+}
+
+template<typename T>
+auto
+pack_key_range(std::string& key, const T* values, std::uint32_t count)
+  -> void
+{
+  for (auto i = 0U; i < count; ++i) {
+    pack_key(key, values[i]);
+  }
+}
+
+auto
+pack_stage_key(std::string& key, const VkPipelineShaderStageCreateInfo& stage)
+  -> void
+{
+  pack_key(key, stage.stage, stage.module);
+  key.append(stage.pName).push_back('\0');
+  if (const auto* si = stage.pSpecializationInfo) {
+    pack_key_range(key, si->pMapEntries, si->mapEntryCount);
+    key.append(static_cast<const char*>(si->pData), si->dataSize);
+  }
+}
+
 auto
 blend_factor_to_vk_blend_factor(BlendFactor blend_factor) -> VkBlendFactor
 {
@@ -262,6 +297,54 @@ compare_op_to_vk_compare_op(CompareOp compare_op) -> VkCompareOp
   return VK_COMPARE_OP_ALWAYS;
 }
 
+auto
+sample_count_to_vk_sample_count(const std::uint32_t sample_count,
+                                const VkSampleCountFlags max_samples_mask)
+  -> VkSampleCountFlagBits
+{
+  if (sample_count <= 1 || VK_SAMPLE_COUNT_2_BIT > max_samples_mask) {
+    return VK_SAMPLE_COUNT_1_BIT;
+  }
+  if (sample_count <= 2 || VK_SAMPLE_COUNT_4_BIT > max_samples_mask) {
+    return VK_SAMPLE_COUNT_2_BIT;
+  }
+  if (sample_count <= 4 || VK_SAMPLE_COUNT_8_BIT > max_samples_mask) {
+    return VK_SAMPLE_COUNT_4_BIT;
+  }
+  if (sample_count <= 8 || VK_SAMPLE_COUNT_16_BIT > max_samples_mask) {
+    return VK_SAMPLE_COUNT_8_BIT;
+  }
+  if (sample_count <= 16 || VK_SAMPLE_COUNT_32_BIT > max_samples_mask) {
+    return VK_SAMPLE_COUNT_16_BIT;
+  }
+  if (sample_count <= 32 || VK_SAMPLE_COUNT_64_BIT > max_samples_mask) {
+    return VK_SAMPLE_COUNT_32_BIT;
+  }
+  return VK_SAMPLE_COUNT_64_BIT;
+}
+
+// The stages that may follow `stage` within a shader that has `present`.
+auto
+next_shader_stages(const VkShaderStageFlagBits stage,
+                   const VkShaderStageFlags present) -> VkShaderStageFlags
+{
+  switch (stage) {
+    case VK_SHADER_STAGE_VERTEX_BIT:
+      return present & (VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
+                        VK_SHADER_STAGE_GEOMETRY_BIT |
+                        VK_SHADER_STAGE_FRAGMENT_BIT);
+    case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+      return present & VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+      return present &
+             (VK_SHADER_STAGE_GEOMETRY_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+    case VK_SHADER_STAGE_GEOMETRY_BIT:
+      return present & VK_SHADER_STAGE_FRAGMENT_BIT;
+    default:
+      return 0;
+  }
+}
+
 constexpr VkShaderStageFlags all_stages_flags =
   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT |
   VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT |
@@ -420,8 +503,20 @@ VulkanContext::initialise_tracing() -> void
 VulkanContext::~VulkanContext()
 {
   // LVK_PROFILER_FUNCTION();
+  shader_watcher.reset();
   vkDeviceWaitIdle(device);
 
+  while (!pending_graphics_pipelines.empty()) {
+    discard_pending_pipeline(pending_graphics_pipelines.begin()->first);
+  }
+  while (!optimised_graphics_pipelines.empty()) {
+    discard_pending_pipeline(optimised_graphics_pipelines.begin()->first);
+  }
+  pipeline_workers.reset();
+  for (const auto library : pipeline_libraries.clear()) {
+    vkDestroyPipeline(device, library, nullptr);
+  }
+
 #if defined(HAS_TRACY_TRACING)
   TracyVkDestroy(tracing->vulkan_context);
   if (tracing->command_pool) {
@@ -431,10 +526,19 @@ VulkanContext::~VulkanContext()
 
   destroy(*dummy_texture);
   destroy(*dummy_sampler);
+  if (descriptors.buffer.buffer != VK_NULL_HANDLE) {
+    BindlessAccess<VulkanContext>::destroy_descriptor_buffer(
+      *this, descriptors.buffer);
+  }
 
   swapchain.reset();
   staging_allocator.reset();
   immediate_commands.reset();
+  pipeline_cache.reset();
+  shader_cache.reset();
+  for (const auto layout : pipeline_layouts.clear()) {
+    vkDestroyPipelineLayout(device, layout, nullptr);
+  }
 
   while (!delete_queue.empty()) {
     auto back = std::move(delete_queue.back());
@@ -510,6 +614,8 @@ VulkanContext::create(const Window& window, const ContextConfiguration& conf)
   VkPhysicalDeviceFeatures required_features{};
   required_features.multiViewport = true;
   required_features.multiDrawIndirect = true;
+  // Indirect draws find their instance run through firstInstance.
+  required_features.drawIndirectFirstInstance = true;
   required_features.inheritedQueries = true;
   required_features.sampleRateShading = true;
   required_features.geometryShader = true;
@@ -527,6 +633,7 @@ VulkanContext::create(const Window& window, const ContextConfiguration& conf)
   required_12_features.vulkanMemoryModelDeviceScope = true;
   required_12_features.vulkanMemoryModelAvailabilityVisibilityChains = true;
   required_12_features.bufferDeviceAddress = true;
+  required_12_features.drawIndirectCount = true;
   required_12_features.descriptorIndexing = true;
   required_12_features.timelineSemaphore = true;
   required_12_features.hostQueryReset = true;
@@ -594,6 +701,78 @@ VulkanContext::create(const Window& window, const ContextConfiguration& conf)
   }
   vkb::PhysicalDevice physical_device = phys_device_ret.value();
 
+  if (conf.prefer_descriptor_buffer &&
+      physical_device.is_extension_present(
+        VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) {
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features{};
+    descriptor_buffer_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+    descriptor_buffer_features.descriptorBuffer = VK_TRUE;
+    if (physical_device.enable_extension_features_if_present(
+          descriptor_buffer_features)) {
+      physical_device.enable_extension_if_present(
+        VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    }
+  }
+
+  if (conf.prefer_graphics_pipeline_library &&
+      physical_device.is_extension_present(
+        VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gpl_features{};
+    gpl_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+    gpl_features.graphicsPipelineLibrary = VK_TRUE;
+    if (physical_device.enable_extension_features_if_present(gpl_features)) {
+      physical_device.enable_extension_if_present(
+        VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+      physical_device.enable_extension_if_present(
+        VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    }
+  }
+
+  if (conf.prefer_shader_objects &&
+      physical_device.is_extension_present(
+        VK_EXT_SHADER_OBJECT_EXTENSION_NAME)) {
+    VkPhysicalDeviceShaderObjectFeaturesEXT shader_object_features{};
+    shader_object_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+    shader_object_features.shaderObject = VK_TRUE;
+    if (physical_device.enable_extension_features_if_present(
+          shader_object_features)) {
+      physical_device.enable_extension_if_present(
+        VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+    }
+  }
+
+  if (conf.prefer_extended_dynamic_state3 &&
+      physical_device.is_extension_present(
+        VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME)) {
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT eds3_features{};
+    eds3_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+    eds3_features.extendedDynamicState3PolygonMode = VK_TRUE;
+    eds3_features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+    eds3_features.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+    eds3_features.extendedDynamicState3ColorWriteMask = VK_TRUE;
+    if (physical_device.enable_extension_features_if_present(eds3_features)) {
+      physical_device.enable_extension_if_present(
+        VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    }
+  }
+
+  if (physical_device.is_extension_present(
+        VK_EXT_MULTI_DRAW_EXTENSION_NAME)) {
+    VkPhysicalDeviceMultiDrawFeaturesEXT multi_draw_features{};
+    multi_draw_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT;
+    multi_draw_features.multiDraw = VK_TRUE;
+    if (physical_device.enable_extension_features_if_present(
+          multi_draw_features)) {
+      physical_device.enable_extension_if_present(
+        VK_EXT_MULTI_DRAW_EXTENSION_NAME);
+    }
+  }
+
   vkb::DeviceBuilder device_builder{ physical_device };
 
   auto device_ret = device_builder.build();
@@ -660,13 +839,27 @@ DeviceAllocator::initialise(VkInstance instance,
 }
 
 auto
-query_vulkan_properties(VkPhysicalDevice physical_device, auto& props) -> void
+query_vulkan_properties(VkPhysicalDevice physical_device,
+                        auto& props,
+                        bool with_descriptor_buffer,
+                        bool with_multi_draw) -> void
 {
   vkGetPhysicalDeviceProperties(physical_device, &props.base);
 
+  props.multi_draw.sType =
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT;
+  props.multi_draw.pNext = nullptr;
+  void* extensions = with_multi_draw ? &props.multi_draw : nullptr;
+
+  props.descriptor_buffer.sType =
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+  props.descriptor_buffer.pNext = extensions;
+  if (with_descriptor_buffer)
+    extensions = &props.descriptor_buffer;
+
   props.fourteen.sType =
     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_4_PROPERTIES;
-  props.fourteen.pNext = nullptr;
+  props.fourteen.pNext = extensions;
 
   props.thirteen.sType =
     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES;
@@ -706,10 +899,54 @@ VulkanContext::VulkanContext(vkb::Instance&& i,
   , graphics_family(gfam)
   , present_family(pfam)
 {
+  // The messenger only exists when VK_EXT_debug_utils was enabled.
+  has_debug_names = debug_names_compiled && config.debug_names &&
+                    instance.debug_messenger != VK_NULL_HANDLE &&
+                    dispatch_table.fp_vkSetDebugUtilsObjectNameEXT != nullptr;
   has_swapchain_maintenance_1 = device.physical_device.is_extension_present(
     VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+  const auto enabled_extensions = device.physical_device.get_extensions();
+  if (std::ranges::find(enabled_extensions,
+                        VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) !=
+      enabled_extensions.end()) {
+    descriptors.backend = DescriptorBackend::DescriptorBuffer;
+  }
+  has_graphics_pipeline_library =
+    std::ranges::find(enabled_extensions,
+                      VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) !=
+    enabled_extensions.end();
+  has_shader_objects =
+    std::ranges::find(enabled_extensions,
+                      VK_EXT_SHADER_OBJECT_EXTENSION_NAME) !=
+    enabled_extensions.end();
+  has_extended_dynamic_state3 =
+    std::ranges::find(enabled_extensions,
+                      VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) !=
+    enabled_extensions.end();
   swapchain = std::make_unique<VulkanSwapchain>(*this);
-  query_vulkan_properties(device.physical_device, vulkan_properties);
+  has_multi_draw = std::ranges::find(enabled_extensions,
+                                     VK_EXT_MULTI_DRAW_EXTENSION_NAME) !=
+                   enabled_extensions.end();
+  query_vulkan_properties(device.physical_device,
+                          vulkan_properties,
+                          descriptors.uses_descriptor_buffer(),
+                          has_multi_draw);
+  pipeline_cache = std::make_unique<PipelineCache>(
+    device, vulkan_properties.base, config.pipeline_cache_directory);
+  // Leaves the recording thread and shader compiles most of the cores.
+  pipeline_workers = std::make_unique<WorkerPool>(
+    std::clamp(std::thread::hardware_concurrency() / 4, 1U, 4U));
+  shader_cache = std::make_unique<ShaderCache>(
+    config.pipeline_cache_directory.empty()
+      ? std::filesystem::path{}
+      : std::filesystem::path{ config.pipeline_cache_directory } / "shaders");
+  include_cache = std::make_unique<IncludeCache>("shaders/include");
+  if (!config.shader_archive.empty()) {
+    shader_archive = ShaderArchive::read(config.shader_archive);
+  }
+  if (config.hot_reload_shaders) {
+    shader_watcher = std::make_unique<ShaderWatcher>(*this, "shaders");
+  }
   staging_allocator = std::make_unique<StagingAllocator>(*this);
   immediate_commands =
     std::make_unique<ImmediateCommands>(*this, "ImmediateCommands");
@@ -731,7 +968,7 @@ VulkanContext::recreate_texture(const Holder<TextureHandle>& tex,
   std::swap(*slot, replacement);
   destroy_texture_resources(replacement);
 
-  needs_descriptor_update = true;
+  update_resources(*tex);
 
   if (!desc.pixel_data.empty()) {
     get_staging_allocator().upload(
@@ -789,16 +1026,13 @@ VulkanContext::create_placeholder_resources() -> void
 auto
 VulkanContext::destroy(TextureHandle handle) -> void
 {
-  SCOPE_EXIT
-  {
-    textures.erase(handle);
-    needs_descriptor_update = true;
-  };
   auto* tex = textures.get(handle);
   if (!tex)
     return;
 
   destroy_texture_resources(*tex);
+  textures.erase_retained(handle);
+  descriptors.slots.retire_texture(handle.index());
 };
 
 auto
@@ -813,14 +1047,55 @@ VulkanContext::destroy(const ShaderModuleHandle handle) -> void
     return;
   }
 
+  // Background pipeline compiles may still be reading these modules.
+  for (const auto* pending :
+       { &pending_graphics_pipelines, &optimised_graphics_pipelines }) {
+    for (const auto& [pipeline, compiled] : *pending) {
+      compiled.wait();
+    }
+  }
+
+  if (shader_watcher) {
+    shader_watcher->untrack(handle);
+  }
+  for (const auto& [key, variant] : std::exchange(maybe_shader->variants, {})) {
+    destroy(variant);
+  }
+  release_shader_objects(*maybe_shader);
   for (const auto shader = *maybe_shader;
        const auto& module : shader.get_modules()) {
+    evict_pipeline_libraries(std::bit_cast<std::uint64_t>(module.module));
     defer_task([m = module.module](auto& ctx) {
       vkDestroyShaderModule(ctx.get_device(), m, nullptr);
     });
   }
 }
 
+auto
+VulkanContext::replace_shader(const ShaderModuleHandle handle,
+                              VulkanShader&& shader) -> bool
+{
+  auto* current = shader_modules.get(handle);
+  if (!current) {
+    return false;
+  }
+  // Variants are compiled from, and reloaded with, the same file; keep them.
+  shader.variants = std::exchange(current->variants, {});
+  shader_modules.replace_in_place(this, handle, std::move(shader));
+
+  graphics_pipelines.for_each_dense([handle](auto, auto& pipeline) {
+    if (pipeline.description.shader == handle) {
+      pipeline.update_shader(handle);
+    }
+  });
+  compute_pipelines.for_each_dense([handle](auto, auto& pipeline) {
+    if (pipeline.description.shader == handle) {
+      pipeline.update_shader(handle);
+    }
+  });
+  return true;
+}
+
 auto
 VulkanContext::destroy(const ComputePipelineHandle handle) -> void
 {
@@ -838,12 +1113,9 @@ VulkanContext::destroy(const ComputePipelineHandle handle) -> void
     return;
   }
 
-  defer_task([ptr = pipeline->get_pipeline(),
-              layout = pipeline->get_layout()](auto& ctx) {
-    auto device = ctx.get_device();
-    auto allocation_callbacks = nullptr;
-    vkDestroyPipeline(device, ptr, allocation_callbacks);
-    vkDestroyPipelineLayout(device, layout, allocation_callbacks);
+  release_pipeline_layout(pipeline->get_layout());
+  defer_task([ptr = pipeline->get_pipeline()](auto& ctx) {
+    vkDestroyPipeline(ctx.get_device(), ptr, nullptr);
   });
 }
 
@@ -864,12 +1136,20 @@ VulkanContext::destroy(const GraphicsPipelineHandle handle) -> void
     return;
   }
 
-  defer_task([ptr = pipeline->get_pipeline(),
-              layout = pipeline->get_layout()](auto& ctx) {
-    auto device = ctx.get_device();
-    auto allocation_callbacks = nullptr;
-    vkDestroyPipeline(device, ptr, allocation_callbacks);
-    vkDestroyPipelineLayout(device, layout, allocation_callbacks);
+  // Variants hold a reference on the pipeline they draw with.
+  if (pipeline->variant_of.valid()) {
+    destroy(pipeline->variant_of);
+    return;
+  }
+
+  if (!pipeline_descriptions.release(handle)) {
+    return;
+  }
+
+  discard_pending_pipeline(handle);
+  release_pipeline_layout(pipeline->get_layout());
+  defer_task([ptr = pipeline->get_pipeline()](auto& ctx) {
+    vkDestroyPipeline(ctx.get_device(), ptr, nullptr);
   });
 }
 
@@ -891,16 +1171,16 @@ VulkanContext::destroy(BufferHandle handle) -> void
 auto
 VulkanContext::destroy(SamplerHandle handle) -> void
 {
-  SCOPE_EXIT
-  {
-    samplers.erase(handle);
-  };
   auto* buf = samplers.get(handle);
   if (!buf)
     return;
+  if (!sampler_cache.release(handle))
+    return;
   defer_task([sampler = *buf](IContext& ctx) {
     vkDestroySampler(ctx.get_device(), sampler, nullptr);
   });
+  samplers.erase_retained(handle);
+  descriptors.slots.retire_sampler(handle.index());
 }
 
 auto
@@ -942,8 +1222,17 @@ VulkanContext::submit(ICommandBuffer& cmd, TextureHandle present)
 
     assert(tex.is_swapchain_image);
 
-    Transition::release_swapchain_for_present(vk_cmd->wrapper->command_buffer,
-                                              tex.image);
+    vk_cmd->barriers.require(tex.image,
+                             tex.states,
+                             { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+                             ImageUsage{
+                               .layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                               .stage = VK_PIPELINE_STAGE_2_NONE,
+                               .access = VK_ACCESS_2_NONE,
+                               .discard = false,
+                             });
+    vk_cmd->barriers.flush(vk_cmd->wrapper->command_buffer,
+                           barrier_telemetry);
   }
 
   constexpr auto has_swapchain = [] { return true; };
@@ -961,11 +1250,21 @@ VulkanContext::submit(ICommandBuffer& cmd, TextureHandle present)
   }
 
   vk_cmd->last_submit_handle = immediate_commands->submit(*vk_cmd->wrapper);
+  state_filter_telemetry += vk_cmd->bound.get_skipped();
+  descriptors.slots.stamp(vk_cmd->last_submit_handle);
 
   if (should_present) {
     swapchain->present(immediate_commands->acquire_last_submit_semaphore());
   }
 
+  // Pick up pipelines compiled since the last write without waiting for
+  // shutdown; a crash then only loses the most recent ones.
+  static constexpr std::uint64_t pipeline_cache_save_interval = 1024;
+  if (should_present &&
+      swapchain->current_frame_index % pipeline_cache_save_interval == 0) {
+    pipeline_cache->save_if_changed();
+  }
+
   BindlessAccess<VulkanContext>::process_pre_frame_work(*this);
 
   SubmitHandle handle = vk_cmd->last_submit_handle;
@@ -1105,6 +1404,69 @@ VulkanContext::destroy_texture_resources(VulkanTextureND& tex) -> void
   tex.allocation_info = {};
 }
 
+auto
+VulkanContext::acquire_pipeline_layout(VkShaderStageFlags stages,
+                                       std::size_t push_constant_size)
+  -> VkPipelineLayout
+{
+  assert(push_constant_size <=
+         vulkan_properties.base.limits.maxPushConstantsSize);
+  const PipelineLayoutCache::Key key{
+    .set_layout = descriptors.layout,
+    .stages = stages,
+    .push_constant_size =
+      static_cast<std::uint32_t>(get_aligned_size(push_constant_size, 4)),
+  };
+  if (const auto cached = pipeline_layouts.find(key);
+      cached != VK_NULL_HANDLE) {
+    return cached;
+  }
+
+  // duplicate for MoltenVK
+  const std::array dsls = {
+    descriptors.layout,
+  };
+  const VkPushConstantRange range = {
+    .stageFlags = key.stages,
+    .offset = 0,
+    .size = key.push_constant_size,
+  };
+  const VkPipelineLayoutCreateInfo ci = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .setLayoutCount = static_cast<std::uint32_t>(dsls.size()),
+    .pSetLayouts = dsls.data(),
+    .pushConstantRangeCount = key.push_constant_size ? 1u : 0u,
+    .pPushConstantRanges = key.push_constant_size ? &range : nullptr,
+  };
+  VkPipelineLayout layout = VK_NULL_HANDLE;
+  if (vkCreatePipelineLayout(get_device(), &ci, nullptr, &layout) !=
+      VK_SUCCESS) {
+    return VK_NULL_HANDLE;
+  }
+  set_name(*this,
+           layout,
+           VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+           "Pipeline Layout {:#x} {}B",
+           key.stages,
+           key.push_constant_size);
+  pipeline_layouts.insert(key, layout);
+  return layout;
+}
+
+auto
+VulkanContext::release_pipeline_layout(VkPipelineLayout layout) -> void
+{
+  if (!pipeline_layouts.release(layout)) {
+    return;
+  }
+  evict_pipeline_libraries(std::bit_cast<std::uint64_t>(layout));
+  defer_task([layout](auto& ctx) {
+    vkDestroyPipelineLayout(ctx.get_device(), layout, nullptr);
+  });
+}
+
 auto
 VulkanContext::get_pipeline(ComputePipelineHandle handle) -> VkPipeline
 {
@@ -1118,9 +1480,7 @@ VulkanContext::get_pipeline(ComputePipelineHandle handle) -> VkPipeline
 
   if (cps->new_shader ||
       cps->last_descriptor_set_layout != descriptors.layout) {
-    defer_task([l = cps->get_layout()](auto& ctx) {
-      vkDestroyPipelineLayout(ctx.get_device(), l, nullptr);
-    });
+    release_pipeline_layout(cps->get_layout());
     defer_task([p = cps->get_pipeline()](auto& ctx) {
       vkDestroyPipeline(ctx.get_device(), p, nullptr);
     });
@@ -1140,36 +1500,10 @@ VulkanContext::get_pipeline(ComputePipelineHandle handle) -> VkPipeline
     const VkSpecializationInfo siComp = get_pipeline_specialisation_info(
       cps->description.specialisation_constants, entries);
 
-    // create pipeline layout
-    {
-      // duplicate for MoltenVK
-      const std::array dsls = {
-        descriptors.layout,
-      };
-      assert(sm->get_push_constant_info().first <=
-             vulkan_properties.base.limits.maxPushConstantsSize);
-      const VkPushConstantRange range = {
-        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-        .offset = 0,
-        .size = static_cast<uint32_t>(
-          get_aligned_size(sm->get_push_constant_info().first, 4)),
-      };
-      const VkPipelineLayoutCreateInfo ci = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .pNext = nullptr,
-        .flags = 0,
-        .setLayoutCount = static_cast<uint32_t>(dsls.size()),
-        .pSetLayouts = dsls.data(),
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges = &range,
-      };
-      vkCreatePipelineLayout(get_device(), &ci, nullptr, &cps->layout);
-      set_name(*this,
-               cps->get_layout(),
-               VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-               "Compute Pipeline Layout {}",
-               cps->description.debug_name);
-    }
+    const auto layout = acquire_pipeline_layout(
+      VK_SHADER_STAGE_COMPUTE_BIT, sm->get_push_constant_info().first);
+    release_pipeline_layout(cps->layout);
+    cps->layout = layout;
 
     auto maybe_module = std::ranges::find_if(
       sm->get_modules(), [entry = cps->description.entry_point](auto m) {
@@ -1190,14 +1524,16 @@ VulkanContext::get_pipeline(ComputePipelineHandle handle) -> VkPipeline
     const VkComputePipelineCreateInfo ci = {
       .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
       .pNext = nullptr,
-      .flags = 0,
+      .flags = get_pipeline_create_flags(),
       .stage = psci,
       .layout = cps->layout,
       .basePipelineHandle = VK_NULL_HANDLE,
       .basePipelineIndex = -1,
     };
+    const auto start = std::chrono::steady_clock::now();
     vkCreateComputePipelines(
-      get_device(), nullptr, 1, &ci, nullptr, &cps->pipeline);
+      get_device(), pipeline_cache->get(), 1, &ci, nullptr, &cps->pipeline);
+    pipeline_cache->record_compile(std::chrono::steady_clock::now() - start);
     set_name(*this,
              cps->get_pipeline(),
              VK_OBJECT_TYPE_PIPELINE,
@@ -1208,6 +1544,26 @@ VulkanContext::get_pipeline(ComputePipelineHandle handle) -> VkPipeline
   return cps->pipeline;
 }
 
+struct VulkanContext::GraphicsPipelineBuild
+{
+  GraphicsPipelineDescription description;
+  std::vector<std::byte> specialisation_data;
+  std::array<VkVertexInputBindingDescription,
+             VertexInput::input_bindings_max_count>
+    bindings{};
+  std::array<VkVertexInputAttributeDescription,
+             VertexInput::vertex_attribute_max_count>
+    attributes{};
+  std::uint32_t binding_count{ 0 };
+  std::uint32_t attribute_count{ 0 };
+  VulkanShader shader;
+  VkPipelineLayout layout{ VK_NULL_HANDLE };
+  VkPipelineCreateFlags flags{ 0 };
+  VkSampleCountFlags sample_counts{ 0 };
+  PipelineLibraryCache* libraries{ nullptr };
+  bool dynamic_state{ false };
+};
+
 auto
 VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
 {
@@ -1219,31 +1575,156 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
 
   if (rps->new_shader ||
       rps->last_descriptor_set_layout != descriptors.layout) {
-    defer_task([l = rps->get_layout()](auto& ctx) {
-      vkDestroyPipelineLayout(ctx.get_device(), l, nullptr);
-    });
+    discard_pending_pipeline(handle);
+    release_pipeline_layout(rps->get_layout());
     defer_task([p = rps->get_pipeline()](auto& ctx) {
       vkDestroyPipeline(ctx.get_device(), p, nullptr);
     });
 
     rps->pipeline = VK_NULL_HANDLE;
-    rps->last_descriptor_set_layout = descriptors.layout;
+    rps->layout = VK_NULL_HANDLE;
     static constexpr auto viewMask = 0U;
     rps->view_mask = viewMask;
-    rps->new_shader = false;
+
+    if (config.skip_draws_on_pending_pipelines) {
+      precompile(handle);
+      return VK_NULL_HANDLE;
+    }
   }
 
   if (rps->pipeline != VK_NULL_HANDLE) {
+    if (auto it = optimised_graphics_pipelines.find(handle);
+        it != optimised_graphics_pipelines.end() &&
+        it->second.wait_for(std::chrono::seconds{ 0 }) ==
+          std::future_status::ready) {
+      const auto optimised = it->second.get();
+      optimised_graphics_pipelines.erase(it);
+      if (optimised.pipeline != VK_NULL_HANDLE) {
+        // The fast-linked pipeline may already be recorded in this frame.
+        enqueue_destruction([p = rps->pipeline](auto& ctx) {
+          vkDestroyPipeline(ctx.get_device(), p, nullptr);
+        });
+        pipeline_cache->record_compile(optimised.elapsed);
+        rps->pipeline = optimised.pipeline;
+        set_name(*this,
+                 rps->get_pipeline(),
+                 VK_OBJECT_TYPE_PIPELINE,
+                 "Graphics Pipeline {} (optimised)",
+                 rps->description.debug_name);
+      }
+    }
     return rps->pipeline;
   }
 
-  VkPipelineLayout layout = VK_NULL_HANDLE;
-  VkPipeline pipeline = VK_NULL_HANDLE;
+  if (auto it = pending_graphics_pipelines.find(handle);
+      it != pending_graphics_pipelines.end()) {
+    auto& future = it->second;
+    if (config.skip_draws_on_pending_pipelines &&
+        future.wait_for(std::chrono::seconds{ 0 }) !=
+          std::future_status::ready) {
+      return VK_NULL_HANDLE;
+    }
+    const auto compiled = future.get();
+    pending_graphics_pipelines.erase(it);
+    return adopt_graphics_pipeline(handle, *rps, compiled);
+  }
 
-  const auto& desc = rps->description;
+  const auto build = prepare_graphics_pipeline(*rps);
+  const auto compiled =
+    compile_graphics_pipeline(get_device(), pipeline_cache->get(), build);
+  return adopt_graphics_pipeline(handle, *rps, compiled);
+}
+
+auto
+VulkanContext::precompile(GraphicsPipelineHandle handle) -> void
+{
+  if (has_shader_objects) {
+    return;
+  }
+
+  auto* rps = get_graphics_pipeline_pool().get(handle);
+  if (!rps || rps->pipeline != VK_NULL_HANDLE ||
+      pending_graphics_pipelines.contains(handle)) {
+    return;
+  }
+
+  // The pool may reallocate while the worker runs, so it only ever sees a
+  // snapshot of the pipeline state.
+  pending_graphics_pipelines.emplace(
+    handle,
+    pipeline_workers->submit([device = get_device(),
+                              cache = pipeline_cache->get(),
+                              build = prepare_graphics_pipeline(*rps)] {
+      return compile_graphics_pipeline(device, cache, build);
+    }));
+}
+
+auto
+VulkanContext::discard_pending_pipeline(GraphicsPipelineHandle handle) -> void
+{
+  // Never recorded, so these can go right away.
+  for (auto* pending :
+       { &pending_graphics_pipelines, &optimised_graphics_pipelines }) {
+    auto it = pending->find(handle);
+    if (it == pending->end()) {
+      continue;
+    }
+    const auto compiled = it->second.get();
+    pending->erase(it);
+    vkDestroyPipeline(get_device(), compiled.pipeline, nullptr);
+  }
+}
+
+auto
+VulkanContext::prepare_graphics_pipeline(VulkanGraphicsPipeline& rps)
+  -> GraphicsPipelineBuild
+{
+  const auto& desc = rps.description;
+  const auto* shader = get_shader_module_pool().get(desc.shader);
+
+  assert(shader);
+
+  const auto layout = acquire_pipeline_layout(
+    rps.stage_flags, shader->get_push_constant_info().first);
+  release_pipeline_layout(rps.layout);
+  rps.layout = layout;
+
+  rps.last_descriptor_set_layout = descriptors.layout;
+  rps.new_shader = false;
+
+  const auto& spec = desc.specialisation_constants.data;
+  GraphicsPipelineBuild build{
+    .description = desc,
+    .specialisation_data = { spec.begin(), spec.end() },
+    .bindings = rps.bindings,
+    .attributes = rps.attributes,
+    .binding_count = rps.binding_count,
+    .attribute_count = rps.attribute_count,
+    .shader = *shader,
+    .layout = rps.layout,
+    .flags = get_pipeline_create_flags(),
+    .sample_counts =
+      vulkan_properties.base.limits.framebufferColorSampleCounts &
+      vulkan_properties.base.limits.framebufferDepthSampleCounts,
+    .libraries = has_graphics_pipeline_library ? &pipeline_libraries : nullptr,
+    .dynamic_state = has_dynamic_pipeline_state(),
+  };
+  if (build.dynamic_state) {
+    build.description = desc.without_dynamic_state();
+  }
+  build.description.specialisation_constants.data = {};
+  return build;
+}
+
+auto
+VulkanContext::compile_graphics_pipeline(VkDevice device,
+                                         VkPipelineCache cache,
+                                         const GraphicsPipelineBuild& build)
+  -> CompiledPipeline
+{
+  const auto& desc = build.description;
 
-  const auto colour_attachments_count =
-    rps->description.get_colour_attachments_count();
+  const auto colour_attachments_count = desc.get_colour_attachments_count();
 
   std::array<VkPipelineColorBlendAttachmentState, max_colour_attachments>
     color_blend_attachment_states{};
@@ -1291,10 +1772,6 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
     }
   }
 
-  const auto* shader = get_shader_module_pool().get(desc.shader);
-
-  assert(shader);
-
   /*  if (tescModule || teseModule || desc.patchControlPoints) {
       LVK_ASSERT_MSG(tescModule && teseModule, "Both tessellation control and
     evaluation shaders should be provided"); LVK_ASSERT(desc.patchControlPoints
@@ -1306,64 +1783,47 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
     .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
     .pNext = nullptr,
     .flags = 0,
-    .vertexBindingDescriptionCount = rps->binding_count,
+    .vertexBindingDescriptionCount = build.binding_count,
     .pVertexBindingDescriptions =
-      rps->binding_count > 0 ? rps->bindings.data() : nullptr,
-    .vertexAttributeDescriptionCount = rps->attribute_count,
+      build.binding_count > 0 ? build.bindings.data() : nullptr,
+    .vertexAttributeDescriptionCount = build.attribute_count,
     .pVertexAttributeDescriptions =
-      rps->attribute_count > 0 ? rps->attributes.data() : nullptr,
+      build.attribute_count > 0 ? build.attributes.data() : nullptr,
   };
 
   std::array<VkSpecializationMapEntry,
              SpecialisationConstantDescription::max_specialization_constants>
     entries{};
 
+  auto specialisation_constants = desc.specialisation_constants;
+  specialisation_constants.data = build.specialisation_data;
   const VkSpecializationInfo si =
-    get_pipeline_specialisation_info(desc.specialisation_constants, entries);
-
-  // create pipeline layout
-  {
-    auto&& [size, flags] = shader->get_push_constant_info();
-
-    // duplicate for MoltenVK
-    const std::array<VkDescriptorSetLayout, 1> dsls = {
-
-      descriptors.layout
-    };
-    assert(size <= vulkan_properties.base.limits.maxPushConstantsSize);
-    const VkPushConstantRange range = {
-      .stageFlags = rps->stage_flags,
-      .offset = 0,
-      .size = static_cast<uint32_t>(get_aligned_size(size, 4)),
-    };
-    const VkPipelineLayoutCreateInfo ci = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .setLayoutCount = static_cast<std::uint32_t>(std::size(dsls)),
-      .pSetLayouts = dsls.data(),
-      .pushConstantRangeCount = size ? 1u : 0u,
-      .pPushConstantRanges = size ? &range : nullptr,
-    };
-    assert(!desc.debug_name.empty());
-    vkCreatePipelineLayout(get_device(), &ci, nullptr, &layout);
-    set_name(*this,
-             layout,
-             VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-             "Pipeline_Layout_{}",
-             desc.debug_name);
-  }
+    get_pipeline_specialisation_info(specialisation_constants, entries);
 
+  static constexpr auto base_dynamic_state_count = 8U;
   std::array dynamic_states = {
-    VK_DYNAMIC_STATE_VIEWPORT,          VK_DYNAMIC_STATE_SCISSOR,
-    VK_DYNAMIC_STATE_DEPTH_BIAS,        VK_DYNAMIC_STATE_BLEND_CONSTANTS,
-    VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
-    VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,  VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+    VK_DYNAMIC_STATE_DEPTH_BIAS,
+    VK_DYNAMIC_STATE_BLEND_CONSTANTS,
+    VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+    VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+    VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,
+    VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE,
+    // Only with build.dynamic_state
+    VK_DYNAMIC_STATE_CULL_MODE,
+    VK_DYNAMIC_STATE_FRONT_FACE,
+    VK_DYNAMIC_STATE_POLYGON_MODE_EXT,
+    VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT,
+    VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT,
+    VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT,
   };
 
   VkPipelineDynamicStateCreateInfo ci_dynamic{};
   ci_dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-  ci_dynamic.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+  ci_dynamic.dynamicStateCount =
+    build.dynamic_state ? static_cast<uint32_t>(dynamic_states.size())
+                        : base_dynamic_state_count;
   ci_dynamic.pDynamicStates = dynamic_states.data();
 
   VkPipelineInputAssemblyStateCreateInfo ci_ia{};
@@ -1378,34 +1838,9 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
   ci_rs.depthBiasEnable = VK_FALSE;
   ci_rs.lineWidth = 1.0f;
 
-  auto getVulkanSampleCountFlags = [](const uint32_t sample_count,
-                                      VkSampleCountFlags max_samples_mask) {
-    if (sample_count <= 1 || VK_SAMPLE_COUNT_2_BIT > max_samples_mask) {
-      return VK_SAMPLE_COUNT_1_BIT;
-    }
-    if (sample_count <= 2 || VK_SAMPLE_COUNT_4_BIT > max_samples_mask) {
-      return VK_SAMPLE_COUNT_2_BIT;
-    }
-    if (sample_count <= 4 || VK_SAMPLE_COUNT_8_BIT > max_samples_mask) {
-      return VK_SAMPLE_COUNT_4_BIT;
-    }
-    if (sample_count <= 8 || VK_SAMPLE_COUNT_16_BIT > max_samples_mask) {
-      return VK_SAMPLE_COUNT_8_BIT;
-    }
-    if (sample_count <= 16 || VK_SAMPLE_COUNT_32_BIT > max_samples_mask) {
-      return VK_SAMPLE_COUNT_16_BIT;
-    }
-    if (sample_count <= 32 || VK_SAMPLE_COUNT_64_BIT > max_samples_mask) {
-      return VK_SAMPLE_COUNT_32_BIT;
-    }
-    return VK_SAMPLE_COUNT_64_BIT;
-  };
-
-  auto limits = vulkan_properties.base.limits.framebufferColorSampleCounts &
-                vulkan_properties.base.limits.framebufferDepthSampleCounts;
 
   VkSampleCountFlagBits samples =
-    getVulkanSampleCountFlags(desc.sample_count, limits);
+    sample_count_to_vk_sample_count(desc.sample_count, build.sample_counts);
   VkPipelineMultisampleStateCreateInfo ci_ms{};
   ci_ms.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
   ci_ms.rasterizationSamples = samples;
@@ -1463,8 +1898,9 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
   ci_cb.pAttachments = color_blend_attachment_states.data();
 
   VkPipelineTessellationStateCreateInfo ci_ts{};
-  bool has_tess = (shader->has_stage(ShaderStage::tessellation_control) &&
-                   shader->has_stage(ShaderStage::tessellation_evaluation)) &&
+  const auto& shader = build.shader;
+  bool has_tess = (shader.has_stage(ShaderStage::tessellation_control) &&
+                   shader.has_stage(ShaderStage::tessellation_evaluation)) &&
                   desc.patch_control_points > 0;
   if (has_tess) {
     ci_ts.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
@@ -1472,7 +1908,7 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
   }
 
   std::vector<VkPipelineShaderStageCreateInfo> stages;
-  shader->populate_stages(stages, si);
+  shader.populate_stages(stages, si);
 
   VkPipelineRenderingCreateInfo ci_rendering{};
   ci_rendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
@@ -1487,6 +1923,7 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
   VkGraphicsPipelineCreateInfo ci_gp{};
   ci_gp.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
   ci_gp.pNext = &ci_rendering;
+  ci_gp.flags = build.flags;
   ci_gp.stageCount = static_cast<uint32_t>(stages.size());
   ci_gp.pStages = stages.data();
   ci_gp.pVertexInputState = &ciVertexInputState;
@@ -1498,23 +1935,681 @@ VulkanContext::get_pipeline(GraphicsPipelineHandle handle) -> VkPipeline
   ci_gp.pColorBlendState = &ci_cb;
   ci_gp.pDynamicState = &ci_dynamic;
   ci_gp.pTessellationState = has_tess ? &ci_ts : nullptr;
-  ci_gp.layout = layout;
+  ci_gp.layout = build.layout;
+
+  if (build.libraries != nullptr) {
+    return compile_pipeline_libraries(device, cache, *build.libraries, ci_gp);
+  }
 
+  CompiledPipeline compiled{};
+  const auto start = std::chrono::steady_clock::now();
   if (const auto res = vkCreateGraphicsPipelines(
-        get_device(), nullptr, 1, &ci_gp, nullptr, &pipeline);
+        device, cache, 1, &ci_gp, nullptr, &compiled.pipeline);
       res != VK_SUCCESS) {
+    return {};
+  }
+  compiled.elapsed = std::chrono::steady_clock::now() - start;
+
+  return compiled;
+}
+
+auto
+VulkanContext::compile_pipeline_libraries(
+  VkDevice device,
+  VkPipelineCache cache,
+  PipelineLibraryCache& libraries,
+  const VkGraphicsPipelineCreateInfo& full) -> CompiledPipeline
+{
+  using Part = PipelineLibraryCache::Part;
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto* rendering =
+    static_cast<const VkPipelineRenderingCreateInfo*>(full.pNext);
+  const auto layout = std::bit_cast<std::uint64_t>(full.layout);
+
+  std::vector<VkPipelineShaderStageCreateInfo> pre_rasterisation_stages;
+  std::vector<VkPipelineShaderStageCreateInfo> fragment_stages;
+  std::vector<std::uint64_t> pre_rasterisation_uses{ layout };
+  std::vector<std::uint64_t> fragment_uses{ layout };
+  for (const auto& stage : std::span{ full.pStages, full.stageCount }) {
+    const bool fragment = stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+    (fragment ? fragment_stages : pre_rasterisation_stages).push_back(stage);
+    (fragment ? fragment_uses : pre_rasterisation_uses)
+      .push_back(std::bit_cast<std::uint64_t>(stage.module));
+  }
+
+  const auto make_library = [&](Part part,
+                                VkGraphicsPipelineLibraryFlagsEXT flags,
+                                const std::string& key,
+                                std::span<const std::uint64_t> uses,
+                                VkGraphicsPipelineCreateInfo ci) {
+    if (const auto cached = libraries.find(part, key);
+        cached != VK_NULL_HANDLE) {
+      return cached;
+    }
+
+    const VkGraphicsPipelineLibraryCreateInfoEXT library_info{
+      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+      .pNext = rendering,
+      .flags = flags,
+    };
+    ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    ci.pNext = &library_info;
+    ci.flags = full.flags | VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+               VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    ci.pDynamicState = full.pDynamicState;
+
+    VkPipeline library = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(device, cache, 1, &ci, nullptr, &library) !=
+        VK_SUCCESS) {
+      return VkPipeline{ VK_NULL_HANDLE };
+    }
+    const auto shared = libraries.insert(part, key, uses, library);
+    if (shared != library) {
+      vkDestroyPipeline(device, library, nullptr);
+    }
+    return shared;
+  };
+
+  std::string key;
+  PipelineLibraries parts{};
+
+  const auto& vertex_input = *full.pVertexInputState;
+  pack_key(key, full.flags, full.pInputAssemblyState->topology);
+  pack_key_range(key,
+                 vertex_input.pVertexBindingDescriptions,
+                 vertex_input.vertexBindingDescriptionCount);
+  pack_key_range(key,
+                 vertex_input.pVertexAttributeDescriptions,
+                 vertex_input.vertexAttributeDescriptionCount);
+  parts[0] = make_library(
+    Part::VertexInput,
+    VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+    key,
+    {},
+    { .pVertexInputState = full.pVertexInputState,
+      .pInputAssemblyState = full.pInputAssemblyState });
+
+  key.clear();
+  const auto& raster = *full.pRasterizationState;
+  pack_key(key, full.flags, layout, rendering->viewMask);
+  for (const auto& stage : pre_rasterisation_stages) {
+    pack_stage_key(key, stage);
+  }
+  pack_key(key,
+           raster.polygonMode,
+           raster.cullMode,
+           raster.frontFace,
+           raster.depthBiasEnable,
+           raster.lineWidth);
+  if (const auto* tessellation = full.pTessellationState) {
+    pack_key(key, tessellation->patchControlPoints);
+  }
+  parts[1] = make_library(
+    Part::PreRasterisation,
+    VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+    key,
+    pre_rasterisation_uses,
+    { .stageCount = static_cast<std::uint32_t>(pre_rasterisation_stages.size()),
+      .pStages = pre_rasterisation_stages.data(),
+      .pTessellationState = full.pTessellationState,
+      .pViewportState = full.pViewportState,
+      .pRasterizationState = full.pRasterizationState,
+      .layout = full.layout });
+
+  key.clear();
+  const auto& depth_stencil = *full.pDepthStencilState;
+  const auto& multisample = *full.pMultisampleState;
+  pack_key(key, full.flags, layout);
+  for (const auto& stage : fragment_stages) {
+    pack_stage_key(key, stage);
+  }
+  pack_key(key,
+           depth_stencil.stencilTestEnable,
+           depth_stencil.front,
+           depth_stencil.back,
+           multisample.rasterizationSamples,
+           multisample.sampleShadingEnable,
+           multisample.minSampleShading);
+  parts[2] =
+    make_library(Part::FragmentShader,
+                 VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                 key,
+                 fragment_uses,
+                 { .stageCount =
+                     static_cast<std::uint32_t>(fragment_stages.size()),
+                   .pStages = fragment_stages.data(),
+                   .pMultisampleState = full.pMultisampleState,
+                   .pDepthStencilState = full.pDepthStencilState,
+                   .layout = full.layout });
+
+  key.clear();
+  const auto& blend = *full.pColorBlendState;
+  pack_key(key,
+           full.flags,
+           multisample.rasterizationSamples,
+           multisample.sampleShadingEnable,
+           multisample.minSampleShading,
+           rendering->depthAttachmentFormat,
+           rendering->stencilAttachmentFormat);
+  pack_key_range(key,
+                 rendering->pColorAttachmentFormats,
+                 rendering->colorAttachmentCount);
+  pack_key_range(key, blend.pAttachments, blend.attachmentCount);
+  parts[3] =
+    make_library(Part::FragmentOutput,
+                 VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+                 key,
+                 {},
+                 { .pMultisampleState = full.pMultisampleState,
+                   .pColorBlendState = full.pColorBlendState });
+
+  if (std::ranges::find(parts, VK_NULL_HANDLE) != parts.end()) {
+    return {};
+  }
+
+  auto linked = link_pipeline_libraries(
+    device, cache, parts, full.flags, full.layout, false);
+  linked.elapsed = std::chrono::steady_clock::now() - start;
+  return linked;
+}
+
+auto
+VulkanContext::link_pipeline_libraries(VkDevice device,
+                                       VkPipelineCache cache,
+                                       const PipelineLibraries& parts,
+                                       VkPipelineCreateFlags flags,
+                                       VkPipelineLayout layout,
+                                       bool optimise) -> CompiledPipeline
+{
+  const VkPipelineLibraryCreateInfoKHR library_info{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+    .pNext = nullptr,
+    .libraryCount = static_cast<std::uint32_t>(parts.size()),
+    .pLibraries = parts.data(),
+  };
+  if (optimise) {
+    flags |= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+  }
+  const VkGraphicsPipelineCreateInfo ci{
+    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .pNext = &library_info,
+    .flags = flags,
+    .layout = layout,
+  };
+
+  CompiledPipeline compiled{};
+  const auto start = std::chrono::steady_clock::now();
+  if (vkCreateGraphicsPipelines(
+        device, cache, 1, &ci, nullptr, &compiled.pipeline) != VK_SUCCESS) {
+    return {};
+  }
+  compiled.elapsed = std::chrono::steady_clock::now() - start;
+  if (!optimise) {
+    compiled.libraries = parts;
+  }
+  return compiled;
+}
+
+auto
+VulkanContext::evict_pipeline_libraries(std::uint64_t dependency) -> void
+{
+  for (const auto library : pipeline_libraries.evict(dependency)) {
+    defer_task([library](auto& ctx) {
+      vkDestroyPipeline(ctx.get_device(), library, nullptr);
+    });
+  }
+}
+
+auto
+VulkanContext::adopt_graphics_pipeline(GraphicsPipelineHandle handle,
+                                       VulkanGraphicsPipeline& rps,
+                                       const CompiledPipeline& compiled)
+  -> VkPipeline
+{
+  if (compiled.pipeline == VK_NULL_HANDLE) {
     return VK_NULL_HANDLE;
   }
 
-  rps->pipeline = pipeline;
-  rps->layout = layout;
+  pipeline_cache->record_compile(compiled.elapsed);
+  rps.pipeline = compiled.pipeline;
   set_name(*this,
-           rps->get_pipeline(),
+           rps.get_pipeline(),
            VK_OBJECT_TYPE_PIPELINE,
            "Graphics Pipeline {}",
-           rps->description.debug_name);
+           rps.description.debug_name);
+
+  if (config.optimise_linked_pipelines &&
+      compiled.libraries.front() != VK_NULL_HANDLE) {
+    optimised_graphics_pipelines.insert_or_assign(
+      handle,
+      pipeline_workers->submit([device = get_device(),
+                                cache = pipeline_cache->get(),
+                                libraries = compiled.libraries,
+                                flags = get_pipeline_create_flags(),
+                                layout = rps.layout] {
+        return link_pipeline_libraries(
+          device, cache, libraries, flags, layout, true);
+      }));
+  }
+
+  return rps.pipeline;
+}
+
+auto
+VulkanContext::release_shader_objects(VulkanShader& shader) -> void
+{
+  for (auto& module : shader.modules) {
+    if (module.object == VK_NULL_HANDLE) {
+      continue;
+    }
+    defer_task([this, o = module.object](auto& ctx) {
+      dispatch<VKB_MEMBER(vkDestroyShaderEXT)>(ctx.get_device(), o, nullptr);
+    });
+    module.object = VK_NULL_HANDLE;
+  }
+  shader.object_set_layout = VK_NULL_HANDLE;
+}
+
+auto
+VulkanContext::create_shader_objects(VulkanShader& shader) -> bool
+{
+  release_shader_objects(shader);
+
+  // Must match the range acquire_pipeline_layout gives the pipeline.
+  const VkPushConstantRange range = {
+    .stageFlags = static_cast<VkShaderStageFlags>(shader.flags),
+    .offset = 0,
+    .size = static_cast<std::uint32_t>(
+      get_aligned_size(shader.push_constant_info.size, 4)),
+  };
+
+  std::vector<VkShaderCreateInfoEXT> infos;
+  std::vector<VulkanShader::StageModule*> targets;
+  for (auto& module : shader.modules) {
+    if (module.spirv.empty()) {
+      continue;
+    }
+    const auto stage = to_vk_stage(module.stage);
+    infos.push_back(VkShaderCreateInfoEXT{
+      .sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+      .pNext = nullptr,
+      .flags = 0,
+      .stage = stage,
+      .nextStage = next_shader_stages(stage, shader.flags),
+      .codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+      .codeSize = module.spirv.size(),
+      .pCode = module.spirv.data(),
+      .pName = module.entry_name.c_str(),
+      .setLayoutCount = 1,
+      .pSetLayouts = &descriptors.layout,
+      .pushConstantRangeCount = range.size ? 1u : 0u,
+      .pPushConstantRanges = range.size ? &range : nullptr,
+      .pSpecializationInfo = nullptr,
+    });
+    targets.push_back(&module);
+  }
+
+  std::vector<VkShaderEXT> objects(infos.size(), VK_NULL_HANDLE);
+  if (dispatch<VKB_MEMBER(vkCreateShadersEXT)>(
+        get_device(),
+        static_cast<std::uint32_t>(infos.size()),
+        infos.data(),
+        nullptr,
+        objects.data()) != VK_SUCCESS) {
+    for (const auto object : objects) {
+      dispatch<VKB_MEMBER(vkDestroyShaderEXT)>(get_device(), object, nullptr);
+    }
+    return false;
+  }
+
+  for (auto i = 0U; i < objects.size(); ++i) {
+    targets[i]->object = objects[i];
+  }
+  shader.object_set_layout = descriptors.layout;
+  return true;
+}
+
+auto
+VulkanContext::bind_shader_objects(VkCommandBuffer cmd,
+                                   GraphicsPipelineHandle handle)
+  -> VkPipelineLayout
+{
+  auto* rps = get_graphics_pipeline_pool().get(handle);
+  if (!rps) {
+    return VK_NULL_HANDLE;
+  }
+  auto* shader = get_shader_module_pool().get(rps->description.shader);
+  assert(shader);
+
+  if (rps->new_shader ||
+      rps->last_descriptor_set_layout != descriptors.layout) {
+    const auto layout = acquire_pipeline_layout(
+      rps->stage_flags, shader->get_push_constant_info().first);
+    release_pipeline_layout(rps->layout);
+    rps->layout = layout;
+    rps->last_descriptor_set_layout = descriptors.layout;
+    rps->new_shader = false;
+  }
+  if (shader->object_set_layout != descriptors.layout &&
+      !create_shader_objects(*shader)) {
+    return VK_NULL_HANDLE;
+  }
 
-  return pipeline;
+  static constexpr std::array graphics_stages = {
+    VK_SHADER_STAGE_VERTEX_BIT,
+    VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+    VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+    VK_SHADER_STAGE_GEOMETRY_BIT,
+    VK_SHADER_STAGE_FRAGMENT_BIT,
+  };
+  std::array<VkShaderEXT, graphics_stages.size()> objects{};
+  for (const auto& module : shader->modules) {
+    const auto it =
+      std::ranges::find(graphics_stages, to_vk_stage(module.stage));
+    if (it != graphics_stages.end()) {
+      objects[std::distance(graphics_stages.begin(), it)] = module.object;
+    }
+  }
+  dispatch<VKB_MEMBER(vkCmdBindShadersEXT)>(
+    cmd,
+    static_cast<std::uint32_t>(graphics_stages.size()),
+    graphics_stages.data(),
+    objects.data());
+
+  // Everything a pipeline would have baked in is dynamic from here on.
+  const auto& desc = rps->description;
+
+  std::array<VkVertexInputBindingDescription2EXT,
+             VertexInput::input_bindings_max_count>
+    bindings{};
+  for (auto i = 0U; i < rps->binding_count; ++i) {
+    bindings[i] = VkVertexInputBindingDescription2EXT{
+      .sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT,
+      .pNext = nullptr,
+      .binding = rps->bindings[i].binding,
+      .stride = rps->bindings[i].stride,
+      .inputRate = rps->bindings[i].inputRate,
+      .divisor = 1,
+    };
+  }
+  std::array<VkVertexInputAttributeDescription2EXT,
+             VertexInput::vertex_attribute_max_count>
+    attributes{};
+  for (auto i = 0U; i < rps->attribute_count; ++i) {
+    attributes[i] = VkVertexInputAttributeDescription2EXT{
+      .sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT,
+      .pNext = nullptr,
+      .location = rps->attributes[i].location,
+      .binding = rps->attributes[i].binding,
+      .format = rps->attributes[i].format,
+      .offset = rps->attributes[i].offset,
+    };
+  }
+  dispatch<VKB_MEMBER(vkCmdSetVertexInputEXT)>(cmd,
+                                               rps->binding_count,
+                                               bindings.data(),
+                                               rps->attribute_count,
+                                               attributes.data());
+
+  vkCmdSetPrimitiveTopology(cmd, topology_to_vk_topology(desc.topology));
+  vkCmdSetPrimitiveRestartEnable(cmd, VK_FALSE);
+  if (shader->has_stage(ShaderStage::tessellation_control) &&
+      desc.patch_control_points > 0) {
+    dispatch<VKB_MEMBER(vkCmdSetPatchControlPointsEXT)>(
+      cmd, desc.patch_control_points);
+  }
+  vkCmdSetRasterizerDiscardEnable(cmd, VK_FALSE);
+  vkCmdSetLineWidth(cmd, 1.0f);
+  apply_dynamic_pipeline_state(cmd, desc);
+
+  const auto samples = sample_count_to_vk_sample_count(
+    desc.sample_count,
+    vulkan_properties.base.limits.framebufferColorSampleCounts &
+      vulkan_properties.base.limits.framebufferDepthSampleCounts);
+  const VkSampleMask sample_mask = ~0U;
+  dispatch<VKB_MEMBER(vkCmdSetRasterizationSamplesEXT)>(cmd, samples);
+  dispatch<VKB_MEMBER(vkCmdSetSampleMaskEXT)>(cmd, samples, &sample_mask);
+  dispatch<VKB_MEMBER(vkCmdSetAlphaToCoverageEnableEXT)>(cmd, VK_FALSE);
+
+  // Depth test, write, compare and bias stay with cmd_bind_depth_state.
+  vkCmdSetDepthBoundsTestEnable(cmd, VK_FALSE);
+  vkCmdSetStencilTestEnable(cmd,
+                            desc.front_face_stencil.enabled ||
+                                desc.back_face_stencil.enabled
+                              ? VK_TRUE
+                              : VK_FALSE);
+  for (const auto& [face, state] :
+       { std::pair{ VK_STENCIL_FACE_FRONT_BIT, desc.front_face_stencil },
+         std::pair{ VK_STENCIL_FACE_BACK_BIT, desc.back_face_stencil } }) {
+    vkCmdSetStencilOp(
+      cmd,
+      face,
+      stencil_op_to_vk_stencil_op(state.stencil_failure_operation),
+      stencil_op_to_vk_stencil_op(state.depth_stencil_pass_operation),
+      stencil_op_to_vk_stencil_op(state.depth_failure_operation),
+      compare_op_to_vk_compare_op(state.stencil_compare_op));
+    vkCmdSetStencilCompareMask(cmd, face, state.read_mask);
+    vkCmdSetStencilWriteMask(cmd, face, state.write_mask);
+    vkCmdSetStencilReference(cmd, face, 0xFF);
+  }
+
+  return rps->layout;
+}
+
+auto
+VulkanContext::apply_dynamic_pipeline_state(
+  VkCommandBuffer cmd,
+  const GraphicsPipelineDescription& desc) const -> void
+{
+  set_cull_mode(cmd, desc.cull_mode);
+  set_winding(cmd, desc.winding);
+  set_polygon_mode(cmd, desc.polygon_mode);
+
+  const auto count = desc.get_colour_attachments_count();
+  if (count == 0) {
+    return;
+  }
+  set_blend_state(cmd, 0, std::span{ desc.color.data(), count });
+  std::array<VkColorComponentFlags, max_colour_attachments> write_masks{};
+  write_masks.fill(static_cast<VkColorComponentFlags>(ColourWriteMask::All));
+  dispatch<VKB_MEMBER(vkCmdSetColorWriteMaskEXT)>(
+    cmd, 0U, count, write_masks.data());
+}
+
+auto
+VulkanContext::set_cull_mode(VkCommandBuffer cmd, CullMode mode) const -> void
+{
+  vkCmdSetCullMode(cmd, cull_mode_to_vk_cull_mode(mode));
+}
+
+auto
+VulkanContext::set_winding(VkCommandBuffer cmd, WindingMode winding) const
+  -> void
+{
+  vkCmdSetFrontFace(cmd, winding_to_vk_winding(winding));
+}
+
+auto
+VulkanContext::set_polygon_mode(VkCommandBuffer cmd, PolygonMode mode) const
+  -> void
+{
+  dispatch<VKB_MEMBER(vkCmdSetPolygonModeEXT)>(
+    cmd, polygon_mode_to_vk_polygon_mode(mode));
+}
+
+auto
+VulkanContext::set_blend_state(
+  VkCommandBuffer cmd,
+  const std::uint32_t first_attachment,
+  const std::span<const ColourAttachment> attachments) const -> void
+{
+  assert(first_attachment + attachments.size() <= max_colour_attachments);
+
+  std::array<VkBool32, max_colour_attachments> enables{};
+  std::array<VkColorBlendEquationEXT, max_colour_attachments> equations{};
+  for (auto i = 0U; i < attachments.size(); ++i) {
+    const auto& attachment = attachments[i];
+    enables[i] = attachment.blend_enabled ? VK_TRUE : VK_FALSE;
+    equations[i] = VkColorBlendEquationEXT{
+      .srcColorBlendFactor =
+        blend_factor_to_vk_blend_factor(attachment.src_rgb_blend_factor),
+      .dstColorBlendFactor =
+        blend_factor_to_vk_blend_factor(attachment.dst_rgb_blend_factor),
+      .colorBlendOp = blend_op_to_vk_blend_op(attachment.rgb_blend_op),
+      .srcAlphaBlendFactor =
+        blend_factor_to_vk_blend_factor(attachment.src_alpha_blend_factor),
+      .dstAlphaBlendFactor =
+        blend_factor_to_vk_blend_factor(attachment.dst_alpha_blend_factor),
+      .alphaBlendOp = blend_op_to_vk_blend_op(attachment.alpha_blend_op),
+    };
+  }
+  const auto count = static_cast<std::uint32_t>(attachments.size());
+  dispatch<VKB_MEMBER(vkCmdSetColorBlendEnableEXT)>(
+    cmd, first_attachment, count, enables.data());
+  dispatch<VKB_MEMBER(vkCmdSetColorBlendEquationEXT)>(
+    cmd, first_attachment, count, equations.data());
+}
+
+auto
+VulkanContext::set_colour_write_mask(VkCommandBuffer cmd,
+                                     const std::uint32_t attachment,
+                                     const ColourWriteMask mask) const -> void
+{
+  const auto flags = static_cast<VkColorComponentFlags>(mask);
+  dispatch<VKB_MEMBER(vkCmdSetColorWriteMaskEXT)>(cmd, attachment, 1U, &flags);
+}
+
+auto
+VulkanContext::bind_default_descriptor_sets(VkCommandBuffer cmd,
+                                            VkPipelineBindPoint bind_point,
+                                            VkPipelineLayout layout) const
+  -> void
+{
+  if (descriptors.uses_descriptor_buffer()) {
+    const VkDescriptorBufferBindingInfoEXT binding_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+      .pNext = nullptr,
+      .address = descriptors.buffer.address,
+      .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+               VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT,
+    };
+    dispatch<VKB_MEMBER(vkCmdBindDescriptorBuffersEXT)>(cmd, 1u, &binding_info);
+
+    const std::uint32_t buffer_index = 0;
+    const VkDeviceSize offset = 0;
+    dispatch<VKB_MEMBER(vkCmdSetDescriptorBufferOffsetsEXT)>(
+      cmd, bind_point, layout, 0u, 1u, &buffer_index, &offset);
+    return;
+  }
+
+  const std::array dsets{
+    descriptors.set,
+  };
+  vkCmdBindDescriptorSets(cmd,
+                          bind_point,
+                          layout,
+                          0,
+                          static_cast<std::uint32_t>(dsets.size()),
+                          dsets.data(),
+                          0,
+                          nullptr);
+}
+
+auto
+BindlessAccess<VulkanContext>::create_descriptor_buffer(VulkanContext& c,
+                                                        VkDeviceSize size)
+  -> DescriptorBuffer
+{
+  const VkBufferCreateInfo ci{
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .size = size,
+    .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+             VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
+             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = 0,
+    .pQueueFamilyIndices = nullptr,
+  };
+
+  VmaAllocationCreateInfo aci{};
+  aci.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+  aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT |
+              VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+  aci.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+  DescriptorBuffer out{};
+  VmaAllocationInfo info{};
+  vmaCreateBuffer(
+    DeviceAllocator::the(), &ci, &aci, &out.buffer, &out.allocation, &info);
+  set_name(c,
+           out.buffer,
+           VK_OBJECT_TYPE_BUFFER,
+           "Bindless Descriptor Buffer ({} bytes)",
+           size);
+
+  const VkBufferDeviceAddressInfo address_info{
+    .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+    .pNext = nullptr,
+    .buffer = out.buffer,
+  };
+  out.address = vkGetBufferDeviceAddress(c.get_device(), &address_info);
+  out.mapped = static_cast<std::byte*>(info.pMappedData);
+  out.size = size;
+  return out;
+}
+
+auto
+BindlessAccess<VulkanContext>::destroy_descriptor_buffer(
+  VulkanContext& c,
+  const DescriptorBuffer& buffer) -> void
+{
+  c.defer_task([b = buffer.buffer, a = buffer.allocation](IContext&) {
+    vmaDestroyBuffer(DeviceAllocator::the(), b, a);
+  });
+}
+
+auto
+BindlessAccess<VulkanContext>::flush_descriptor_buffer(
+  VulkanContext&,
+  const DescriptorBuffer& buffer) -> void
+{
+  vmaFlushAllocation(DeviceAllocator::the(), buffer.allocation, 0, buffer.size);
+}
+
+auto
+BindlessAccess<VulkanContext>::get_descriptor(
+  VulkanContext& c,
+  const VkDescriptorGetInfoEXT& info,
+  std::size_t size,
+  void* out) -> void
+{
+  c.dispatch<VKB_MEMBER(vkGetDescriptorEXT)>(c.get_device(), &info, size, out);
+}
+
+auto
+BindlessAccess<VulkanContext>::layout_size(VulkanContext& c,
+                                           VkDescriptorSetLayout layout)
+  -> VkDeviceSize
+{
+  VkDeviceSize size{ 0 };
+  c.dispatch<VKB_MEMBER(vkGetDescriptorSetLayoutSizeEXT)>(
+    c.get_device(), layout, &size);
+  return size;
+}
+
+auto
+BindlessAccess<VulkanContext>::binding_offset(VulkanContext& c,
+                                              VkDescriptorSetLayout layout,
+                                              std::uint32_t binding)
+  -> VkDeviceSize
+{
+  VkDeviceSize offset{ 0 };
+  c.dispatch<VKB_MEMBER(vkGetDescriptorSetLayoutBindingOffsetEXT)>(
+    c.get_device(), layout, binding, &offset);
+  return offset;
 }
 
 VulkanSwapchain::VulkanSwapchain(IContext& ctx)
@@ -1663,6 +2758,7 @@ VulkanSwapchain::resize(std::uint32_t width, std::uint32_t height) -> void
         false, // VulkanImage::isDepthFormat(surfaceFormat_.format),
       .is_stencil_format =
         false, // VulkanImage::isStencilFormat(surfaceFormat_.format),
+      .states = ImageStates{ 1, 1 },
     };
 
     image.image_view = image.create_image_view(*context,
@@ -1673,6 +2769,7 @@ VulkanSwapchain::resize(std::uint32_t width, std::uint32_t height) -> void
 
     swapchain_textures[i] =
       context->get_texture_pool().insert(std::move(image));
+    context->update_resources(swapchain_textures[i]);
   }
 }
 
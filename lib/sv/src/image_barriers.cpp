@@ -0,0 +1,223 @@
+#include "sv/image_barriers.hpp"
+
+namespace sv {
+
+namespace {
+
+constexpr VkAccessFlags2 write_accesses =
+  VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+  VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+  VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+  VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT |
+  VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+auto
+same_dependency(const VkImageMemoryBarrier2& a, const VkImageMemoryBarrier2& b)
+  -> bool
+{
+  return a.image == b.image && a.srcStageMask == b.srcStageMask &&
+         a.srcAccessMask == b.srcAccessMask &&
+         a.dstStageMask == b.dstStageMask &&
+         a.dstAccessMask == b.dstAccessMask && a.oldLayout == b.oldLayout &&
+         a.newLayout == b.newLayout &&
+         a.subresourceRange.aspectMask == b.subresourceRange.aspectMask;
+}
+
+auto
+resolve_count(std::uint32_t base, std::uint32_t count, std::uint32_t total)
+  -> std::uint32_t
+{
+  return count == VK_REMAINING_MIP_LEVELS ? total - base : count;
+}
+
+}
+
+ImageStates::ImageStates(std::uint32_t level_count, std::uint32_t layer_count)
+  : levels(level_count)
+  , layers(layer_count)
+  , states(static_cast<std::size_t>(level_count) * layer_count)
+{
+}
+
+auto
+ImageStates::set(const VkImageSubresourceRange& range, const ImageState& state)
+  -> void
+{
+  const auto level_count =
+    resolve_count(range.baseMipLevel, range.levelCount, levels);
+  const auto layer_count =
+    resolve_count(range.baseArrayLayer, range.layerCount, layers);
+  for (auto level = range.baseMipLevel;
+       level < range.baseMipLevel + level_count;
+       ++level) {
+    for (auto layer = range.baseArrayLayer;
+         layer < range.baseArrayLayer + layer_count;
+         ++layer) {
+      get(level, layer) = state;
+    }
+  }
+}
+
+auto
+colour_attachment_usage(const bool discard) -> ImageUsage
+{
+  return {
+    .layout = VK_IMAGE_LAYOUT_GENERAL,
+    .stage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+    .access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT |
+              VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+    .discard = discard,
+  };
+}
+
+auto
+depth_attachment_usage(const bool discard) -> ImageUsage
+{
+  return {
+    .layout = VK_IMAGE_LAYOUT_GENERAL,
+    .stage = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT |
+             VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+    .access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+    .discard = discard,
+  };
+}
+
+auto
+ImageBarrierBatch::transition(ImageState& state, const ImageUsage& usage)
+  -> std::optional<VkImageMemoryBarrier2>
+{
+  const auto writes = usage.access & write_accesses;
+  const auto same_layout = state.layout == usage.layout;
+  const auto visible = (usage.stage & ~state.visible_stage) == 0 &&
+                       (usage.access & ~state.visible_access) == 0;
+  if (same_layout && writes == 0 && visible) {
+    // A later write has to wait for this read as well.
+    state.stage |= usage.stage;
+    return std::nullopt;
+  }
+
+  const VkImageMemoryBarrier2 barrier{
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+    .pNext = nullptr,
+    .srcStageMask = state.stage,
+    .srcAccessMask = state.write_access,
+    .dstStageMask = usage.stage,
+    .dstAccessMask = usage.access,
+    .oldLayout = usage.discard && !same_layout ? VK_IMAGE_LAYOUT_UNDEFINED
+                                               : state.layout,
+    .newLayout = usage.layout,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = VK_NULL_HANDLE,
+    .subresourceRange = {},
+  };
+
+  if (same_layout && writes == 0 && state.write_access == 0) {
+    // Another reader; the earlier ones keep their visibility.
+    state.stage |= usage.stage;
+    state.visible_stage |= usage.stage;
+    state.visible_access |= usage.access;
+  } else {
+    state = ImageState{
+      .layout = usage.layout,
+      .stage = usage.stage,
+      .write_access = writes,
+      .visible_stage = usage.stage,
+      .visible_access = usage.access,
+    };
+  }
+  return barrier;
+}
+
+auto
+ImageBarrierBatch::require(VkImage image,
+                           ImageStates& states,
+                           const VkImageSubresourceRange& range,
+                           const ImageUsage& usage) -> void
+{
+  const auto level_count = resolve_count(
+    range.baseMipLevel, range.levelCount, states.get_level_count());
+  const auto layer_count = resolve_count(
+    range.baseArrayLayer, range.layerCount, states.get_layer_count());
+
+  const auto first = barriers.size();
+  for (auto level = range.baseMipLevel;
+       level < range.baseMipLevel + level_count;
+       ++level) {
+    const auto level_first = barriers.size();
+    for (auto layer = range.baseArrayLayer;
+         layer < range.baseArrayLayer + layer_count;
+         ++layer) {
+      auto barrier = transition(states.get(level, layer), usage);
+      if (!barrier) {
+        elided++;
+        continue;
+      }
+      barrier->image = image;
+      barrier->subresourceRange = {
+        .aspectMask = range.aspectMask,
+        .baseMipLevel = level,
+        .levelCount = 1,
+        .baseArrayLayer = layer,
+        .layerCount = 1,
+      };
+
+      // Adjacent layers of this level moving the same way share a barrier.
+      if (barriers.size() > level_first) {
+        auto& previous = barriers.back();
+        if (same_dependency(previous, *barrier) &&
+            previous.subresourceRange.baseArrayLayer +
+                previous.subresourceRange.layerCount ==
+              layer) {
+          previous.subresourceRange.layerCount++;
+          continue;
+        }
+      }
+      barriers.push_back(*barrier);
+    }
+
+    // So do adjacent levels whose layers moved as one.
+    if (barriers.size() == level_first + 1 && level_first > first) {
+      auto& previous = barriers[level_first - 1];
+      const auto& current = barriers.back();
+      const auto& a = previous.subresourceRange;
+      const auto& b = current.subresourceRange;
+      if (same_dependency(previous, current) &&
+          a.baseMipLevel + a.levelCount == b.baseMipLevel &&
+          a.baseArrayLayer == b.baseArrayLayer &&
+          a.layerCount == b.layerCount) {
+        previous.subresourceRange.levelCount++;
+        barriers.pop_back();
+      }
+    }
+  }
+}
+
+auto
+ImageBarrierBatch::flush(VkCommandBuffer cmd, BarrierTelemetry& telemetry)
+  -> void
+{
+  telemetry.elided += elided;
+  elided = 0;
+  if (barriers.empty())
+    return;
+
+  const VkDependencyInfo dependency_info{
+    .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+    .pNext = nullptr,
+    .dependencyFlags = 0,
+    .memoryBarrierCount = 0,
+    .pMemoryBarriers = nullptr,
+    .bufferMemoryBarrierCount = 0,
+    .pBufferMemoryBarriers = nullptr,
+    .imageMemoryBarrierCount = static_cast<std::uint32_t>(barriers.size()),
+    .pImageMemoryBarriers = barriers.data(),
+  };
+  vkCmdPipelineBarrier2(cmd, &dependency_info);
+  telemetry.emitted += barriers.size();
+  telemetry.batches++;
+  barriers.clear();
+}
+
+}
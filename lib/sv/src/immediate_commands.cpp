@@ -13,7 +13,7 @@ namespace sv {
 static auto
 create_semaphore(const IContext& ctx, const std::string_view name)
 {
-  assert(!name.empty());
+  assert(!names_objects(ctx) || !name.empty());
   VkSemaphore semaphore;
   VkSemaphoreCreateInfo create_info{
     .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
@@ -31,7 +31,7 @@ create_semaphore(const IContext& ctx, const std::string_view name)
 static auto
 create_fence(const IContext& ctx, const std::string_view name)
 {
-  assert(!name.empty());
+  assert(!names_objects(ctx) || !name.empty());
   VkFence fence;
   VkFenceCreateInfo create_info{
     .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
@@ -74,9 +74,10 @@ ImmediateCommands::ImmediateCommands(IContext& ctx, std::string_view debug_name)
   };
   for (auto i = 0U; i < max_command_buffers; i++) {
     auto& buf = command_buffers[i];
-    buf.semaphore =
-      create_semaphore(ctx, std::format("Semaphore_{}::{}", i, debug_name));
-    buf.fence = create_fence(ctx, std::format("Fence_{}::{}", i, debug_name));
+    buf.semaphore = create_semaphore(
+      ctx, format_debug_name(ctx, "Semaphore_{}::{}", i, debug_name));
+    buf.fence =
+      create_fence(ctx, format_debug_name(ctx, "Fence_{}::{}", i, debug_name));
     vkAllocateCommandBuffers(
       ctx.get_device(), &ai, &buf.command_buffer_allocated);
     set_name(ctx,
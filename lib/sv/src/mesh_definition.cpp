@@ -10,6 +10,7 @@
 #include <assimp/scene.h>
 #include <meshoptimizer.h>
 
+#include <algorithm>
 #include <execution>
 #include <filesystem>
 #include <glm/gtc/packing.hpp>
@@ -1192,7 +1193,7 @@ RenderMesh::create(IContext& ctx, const std::string_view path)
       .usage = BufferUsageBits::Vertex,
       .storage = StorageType::Device,
       .size = std::span{ mesh.file.mesh.vertices }.size_bytes(),
-      .debug_name = std::format("{}_VB", filename),
+      .debug_name = format_debug_name(ctx, "{}_VB", filename),
     });
 
   mesh.index_buffer = VulkanDeviceBuffer::create(
@@ -1202,9 +1203,25 @@ RenderMesh::create(IContext& ctx, const std::string_view path)
       .usage = BufferUsageBits::Index,
       .storage = StorageType::Device,
       .size = std::span{ mesh.file.mesh.indices }.size_bytes(),
-      .debug_name = std::format("{}_IB", filename),
+      .debug_name = format_debug_name(ctx, "{}_IB", filename),
     });
 
+  const auto& submeshes = mesh.file.mesh.meshes;
+  for (const auto& submesh : submeshes)
+    mesh.lod_levels = std::max(mesh.lod_levels, submesh.lod_count);
+  for (std::uint32_t lod = 0; lod < mesh.lod_levels; ++lod) {
+    for (const auto& submesh : submeshes) {
+      const auto level = std::min(lod, submesh.lod_count - 1);
+      mesh.lod_commands.push_back({
+        .indexCount = submesh.get_lod_index_count(level),
+        .instanceCount = 1,
+        .firstIndex = submesh.get_lod_first_index(level),
+        .vertexOffset = static_cast<std::int32_t>(submesh.vertex_offset),
+        .firstInstance = 0,
+      });
+    }
+  }
+
   std::vector<std::uint8_t> draw_commands;
   const auto& command_count = mesh.file.header.mesh_count;
   draw_commands.resize(sizeof(VkDrawIndexedIndirectCommand) * command_count +
@@ -1213,15 +1230,8 @@ RenderMesh::create(IContext& ctx, const std::string_view path)
   VkDrawIndexedIndirectCommand* cmd =
     std::launder(reinterpret_cast<VkDrawIndexedIndirectCommand*>(
       draw_commands.data() + sizeof(std::uint32_t)));
-  for (std::uint32_t i = 0; i < command_count; i++) {
-    *cmd++ = VkDrawIndexedIndirectCommand{
-      .indexCount = mesh.file.mesh.meshes[i].get_lod_index_count(0),
-      .instanceCount = 1,
-      .firstIndex = mesh.file.mesh.meshes[i].index_offset,
-      .vertexOffset =
-        static_cast<std::int32_t>(mesh.file.mesh.meshes[i].vertex_offset),
-      .firstInstance = 0,
-    };
+  for (const auto& lod_zero : mesh.get_draw_commands(0)) {
+    *cmd++ = lod_zero;
   }
 
   mesh.indirect_buffer = VulkanDeviceBuffer::create(
@@ -1231,7 +1241,7 @@ RenderMesh::create(IContext& ctx, const std::string_view path)
       .usage = BufferUsageBits::Indirect,
       .storage = StorageType::Device,
       .size = std::span{ draw_commands }.size_bytes(),
-      .debug_name = std::format("{}_IndirectBuffer", filename),
+      .debug_name = format_debug_name(ctx, "{}_IndirectBuffer", filename),
     });
 
   const auto transforms =
@@ -1243,7 +1253,7 @@ RenderMesh::create(IContext& ctx, const std::string_view path)
       .usage = BufferUsageBits::Storage,
       .storage = StorageType::Device,
       .size = std::span{ draw_commands }.size_bytes(),
-      .debug_name = std::format("{}_TransformBuffer", filename),
+      .debug_name = format_debug_name(ctx, "{}_TransformBuffer", filename),
     });
 
   struct SomeMaterial
@@ -1260,10 +1270,21 @@ RenderMesh::create(IContext& ctx, const std::string_view path)
       .usage = BufferUsageBits::Storage,
       .storage = StorageType::Device,
       .size = std::span{ materials }.size_bytes(),
-      .debug_name = std::format("{}_MaterialBuffer", filename),
+      .debug_name = format_debug_name(ctx, "{}_MaterialBuffer", filename),
     });
 
   return mesh;
 }
 
+auto
+RenderMesh::get_draw_commands(const std::uint32_t lod) const
+  -> std::span<const VkDrawIndexedIndirectCommand>
+{
+  if (lod_levels == 0)
+    return {};
+  const auto count = file.mesh.meshes.size();
+  return std::span{ lod_commands }.subspan(
+    std::min(lod, lod_levels - 1) * count, count);
+}
+
 }
@@ -0,0 +1,131 @@
+#include "sv/null_context.hpp"
+
+#include <cassert>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+namespace sv {
+
+namespace {
+
+[[noreturn]] auto
+no_device(const char* what) -> void
+{
+  throw std::runtime_error(
+    std::format("NullContext has no device to back the {}", what));
+}
+
+}
+
+NullContext::NullContext(bool dynamic_state)
+  : dynamic_pipeline_state(dynamic_state)
+{
+}
+
+NullContext::~NullContext()
+{
+  run_deferred();
+}
+
+auto
+NullContext::run_deferred() -> void
+{
+  // Tasks may queue more tasks.
+  while (!delete_queue.empty()) {
+    auto task = std::move(delete_queue.front());
+    delete_queue.pop_front();
+    task(*this);
+  }
+}
+
+auto
+NullContext::destroy(GraphicsPipelineHandle handle) -> void
+{
+  const auto* pipeline = graphics_pipelines.get(handle);
+  if (!pipeline)
+    return;
+  if (pipeline->variant_of.valid()) {
+    destroy(pipeline->variant_of);
+    return;
+  }
+  if (!pipeline_descriptions.release(handle))
+    return;
+  graphics_pipelines.erase(handle);
+}
+
+auto
+NullContext::destroy(SamplerHandle handle) -> void
+{
+  if (!samplers.get(handle) || !sampler_cache.release(handle))
+    return;
+  samplers.erase(handle);
+}
+
+auto
+NullContext::acquire_command_buffer() -> ICommandBuffer&
+{
+  recorder.take();
+  return recorder;
+}
+
+auto
+NullContext::submit(ICommandBuffer& cmd, TextureHandle) -> SubmitHandle
+{
+  auto& submitted = static_cast<CommandRecorder&>(cmd);
+  assert(&submitted == &recorder);
+
+  last_submitted = submitted.take();
+  submitted_counts += last_submitted.get_counts();
+  run_deferred();
+  return SubmitHandle{ static_cast<std::uint64_t>(++submit_count) << 32 };
+}
+
+auto
+NullContext::get_pipeline_cache() -> PipelineCache&
+{
+  no_device("pipeline cache");
+}
+
+auto
+NullContext::get_shader_cache() -> ShaderCache&
+{
+  no_device("shader cache");
+}
+
+auto
+NullContext::get_swapchain() -> VulkanSwapchain&
+{
+  no_device("swapchain");
+}
+
+auto
+NullContext::get_immediate_commands() -> ImmediateCommands&
+{
+  no_device("immediate commands");
+}
+
+auto
+NullContext::get_staging_allocator() -> StagingAllocator&
+{
+  no_device("staging allocator");
+}
+
+auto
+NullContext::recreate_buffer(const Holder<BufferHandle>&,
+                             VkDeviceSize,
+                             std::span<const std::byte>,
+                             VkDeviceSize,
+                             bool) -> void
+{
+  no_device("buffer");
+}
+
+auto
+NullContext::recreate_texture(const Holder<TextureHandle>&,
+                              const TextureDescription&) -> void
+{
+  no_device("texture");
+}
+
+}
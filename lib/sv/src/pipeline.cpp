@@ -156,8 +156,36 @@ VulkanGraphicsPipeline::create(IContext& context,
   assert(desc.shader.valid());
   assert(!desc.debug_name.empty());
 
+  if (!desc.shader_variant.empty()) {
+    auto resolved = desc;
+    resolved.shader =
+      VulkanShader::get_variant(context, desc.shader, desc.shader_variant);
+    resolved.shader_variant.clear();
+    if (!resolved.shader.valid()) {
+      return Holder<GraphicsPipelineHandle>::invalid();
+    }
+    return create(context, resolved);
+  }
+
+  // With dynamic pipeline state the VkPipeline is only keyed on what is
+  // left baked in; each create still gets its own handle to carry the rest.
+  const auto dynamic = context.has_dynamic_pipeline_state();
+  const auto key = dynamic ? desc.without_dynamic_state() : desc;
+  auto& descriptions = context.get_pipeline_description_cache();
+  const auto shared = descriptions.find(key);
+  if (shared.valid()) {
+    context.get_pipeline_cache().record_deduplicated();
+    if (!dynamic) {
+      return Holder{
+        &context,
+        shared,
+      };
+    }
+  }
+
   VulkanGraphicsPipeline pipeline{};
   pipeline.description = desc;
+  pipeline.variant_of = shared;
 
   const auto& vertex_input = desc.vertex_input;
   std::bitset<VertexInput::input_bindings_max_count> used_bindings{};
@@ -203,9 +231,16 @@ VulkanGraphicsPipeline::create(IContext& context,
   pipeline.stage_flags =
     context.get_shader_module_pool().get(desc.shader)->get_shader_stage_flags();
 
+  const auto handle =
+    context.get_graphics_pipeline_pool().insert(std::move(pipeline));
+  if (!shared.valid()) {
+    descriptions.insert(key, handle);
+    context.precompile(handle);
+  }
+
   return Holder{
     &context,
-    context.get_graphics_pipeline_pool().insert(std::move(pipeline)),
+    handle,
   };
 }
 
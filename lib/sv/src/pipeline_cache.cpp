@@ -0,0 +1,160 @@
+#include "sv/pipeline_cache.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <vector>
+
+namespace sv {
+
+namespace {
+
+auto
+cache_file_name(const VkPhysicalDeviceProperties& props) -> std::string
+{
+  std::string uuid;
+  for (const auto byte : props.pipelineCacheUUID)
+    uuid += std::format("{:02x}", byte);
+  return std::format("pipelines_{:04x}_{:04x}_{:08x}_{}.bin",
+                     props.vendorID,
+                     props.deviceID,
+                     props.driverVersion,
+                     uuid);
+}
+
+auto
+is_compatible(std::span<const char> blob,
+              const VkPhysicalDeviceProperties& props) -> bool
+{
+  VkPipelineCacheHeaderVersionOne header{};
+  if (blob.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, blob.data(), sizeof(header));
+
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == props.vendorID &&
+         header.deviceID == props.deviceID &&
+         std::memcmp(header.pipelineCacheUUID,
+                     props.pipelineCacheUUID,
+                     VK_UUID_SIZE) == 0;
+}
+
+auto
+read_blob(const std::filesystem::path& path) -> std::vector<char>
+{
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    return {};
+  std::vector<char> blob(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  if (!file.read(blob.data(), static_cast<std::streamsize>(blob.size())))
+    return {};
+  return blob;
+}
+
+}
+
+PipelineCache::PipelineCache(VkDevice dev,
+                             const VkPhysicalDeviceProperties& props,
+                             std::filesystem::path directory)
+  : device(dev)
+  , properties(props)
+{
+  std::vector<char> blob;
+  if (!directory.empty()) {
+    path = std::move(directory) / cache_file_name(props);
+    blob = read_blob(path);
+    if (!is_compatible(blob, props))
+      blob.clear();
+  }
+
+  const VkPipelineCacheCreateInfo ci{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .initialDataSize = blob.size(),
+    .pInitialData = blob.empty() ? nullptr : blob.data(),
+  };
+  if (vkCreatePipelineCache(device, &ci, nullptr, &cache) != VK_SUCCESS &&
+      !blob.empty()) {
+    // A blob the driver rejects is no worse than a cold start.
+    const VkPipelineCacheCreateInfo empty{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .initialDataSize = 0,
+      .pInitialData = nullptr,
+    };
+    blob.clear();
+    vkCreatePipelineCache(device, &empty, nullptr, &cache);
+  }
+  telemetry.bytes_loaded = blob.size();
+}
+
+PipelineCache::~PipelineCache()
+{
+  save();
+  vkDestroyPipelineCache(device, cache, nullptr);
+}
+
+auto
+PipelineCache::record_compile(std::chrono::nanoseconds elapsed) -> void
+{
+  telemetry.compiled++;
+  telemetry.compile_time += elapsed;
+}
+
+auto
+PipelineCache::save() -> bool
+{
+  if (path.empty() || cache == VK_NULL_HANDLE)
+    return false;
+
+  std::size_t size{ 0 };
+  if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS ||
+      size == 0)
+    return false;
+  std::vector<char> blob(size);
+  if (vkGetPipelineCacheData(device, cache, &size, blob.data()) != VK_SUCCESS)
+    return false;
+  blob.resize(size);
+
+  if (!is_compatible(blob, properties))
+    return false;
+
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.write(blob.data(), static_cast<std::streamsize>(blob.size())))
+      return false;
+  }
+
+  std::filesystem::rename(temporary, path, ec);
+  if (ec) {
+    std::cerr << std::format(
+      "Could not replace pipeline cache {}: {}\n", path.string(), ec.message());
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+
+  telemetry.bytes_saved = blob.size();
+  compiled_at_last_save = telemetry.compiled;
+  return true;
+}
+
+auto
+PipelineCache::save_if_changed() -> bool
+{
+  if (telemetry.compiled == compiled_at_last_save)
+    return false;
+  return save();
+}
+
+}
@@ -0,0 +1,203 @@
+#include "sv/pipeline_description_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace sv {
+
+namespace {
+auto
+equal_attachments(const ColourAttachment& a, const ColourAttachment& b)
+  -> bool
+{
+  return a.format == b.format && a.blend_enabled == b.blend_enabled &&
+         a.rgb_blend_op == b.rgb_blend_op &&
+         a.alpha_blend_op == b.alpha_blend_op &&
+         a.src_rgb_blend_factor == b.src_rgb_blend_factor &&
+         a.src_alpha_blend_factor == b.src_alpha_blend_factor &&
+         a.dst_rgb_blend_factor == b.dst_rgb_blend_factor &&
+         a.dst_alpha_blend_factor == b.dst_alpha_blend_factor;
+}
+
+auto
+equal_stencil(const StencilState& a, const StencilState& b) -> bool
+{
+  return a.enabled == b.enabled &&
+         a.stencil_failure_operation == b.stencil_failure_operation &&
+         a.depth_failure_operation == b.depth_failure_operation &&
+         a.depth_stencil_pass_operation == b.depth_stencil_pass_operation &&
+         a.stencil_compare_op == b.stencil_compare_op &&
+         a.read_mask == b.read_mask && a.write_mask == b.write_mask;
+}
+
+auto
+equal_specialisation(const SpecialisationConstantDescription& a,
+                     const SpecialisationConstantDescription& b) -> bool
+{
+  const auto count = a.get_specialisation_constants_count();
+  if (count != b.get_specialisation_constants_count())
+    return false;
+
+  for (auto i = 0U; i < count; ++i) {
+    const auto& x = a.entries[i];
+    const auto& y = b.entries[i];
+    if (x.constant_id != y.constant_id || x.offset != y.offset ||
+        x.size != y.size)
+      return false;
+  }
+  return std::ranges::equal(a.data, b.data);
+}
+}
+
+auto
+PipelineDescriptionCache::hash(const GraphicsPipelineDescription& desc)
+  -> std::size_t
+{
+  std::size_t h = 0xcbf29ce484222325ULL;
+  const auto mix = [&](std::size_t x) {
+    h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  };
+  mix(static_cast<std::size_t>(desc.topology));
+  mix(desc.shader.index());
+  mix(desc.shader.generation());
+
+  const auto& input = desc.vertex_input;
+  for (auto i = 0U; i < input.get_attributes_count(); ++i) {
+    const auto& attribute = input.attributes[i];
+    mix(attribute.location);
+    mix(attribute.binding);
+    mix(static_cast<std::size_t>(attribute.format));
+    mix(attribute.offset);
+  }
+  for (auto i = 0U; i < input.get_input_bindings_count(); ++i) {
+    mix(input.input_bindings[i].stride);
+    mix(static_cast<std::size_t>(input.input_bindings[i].rate));
+  }
+
+  const auto& spec = desc.specialisation_constants;
+  for (auto i = 0U; i < spec.get_specialisation_constants_count(); ++i) {
+    mix(spec.entries[i].constant_id);
+    mix(spec.entries[i].offset);
+    mix(spec.entries[i].size);
+  }
+  for (const auto byte : spec.data) {
+    mix(static_cast<std::size_t>(byte));
+  }
+
+  for (const auto& colour : desc.color) {
+    mix(static_cast<std::size_t>(colour.format));
+    mix(static_cast<std::size_t>(colour.blend_enabled));
+    mix(static_cast<std::size_t>(colour.rgb_blend_op));
+    mix(static_cast<std::size_t>(colour.alpha_blend_op));
+    mix(static_cast<std::size_t>(colour.src_rgb_blend_factor));
+    mix(static_cast<std::size_t>(colour.src_alpha_blend_factor));
+    mix(static_cast<std::size_t>(colour.dst_rgb_blend_factor));
+    mix(static_cast<std::size_t>(colour.dst_alpha_blend_factor));
+  }
+  mix(static_cast<std::size_t>(desc.depth_format));
+  mix(static_cast<std::size_t>(desc.stencil_format));
+  mix(static_cast<std::size_t>(desc.cull_mode));
+  mix(static_cast<std::size_t>(desc.winding));
+  mix(static_cast<std::size_t>(desc.polygon_mode));
+  for (const auto* stencil : { &desc.back_face_stencil,
+                               &desc.front_face_stencil }) {
+    mix(static_cast<std::size_t>(stencil->enabled));
+    mix(static_cast<std::size_t>(stencil->stencil_failure_operation));
+    mix(static_cast<std::size_t>(stencil->depth_failure_operation));
+    mix(static_cast<std::size_t>(stencil->depth_stencil_pass_operation));
+    mix(static_cast<std::size_t>(stencil->stencil_compare_op));
+    mix(stencil->read_mask);
+    mix(stencil->write_mask);
+  }
+  mix(desc.sample_count);
+  mix(desc.patch_control_points);
+  mix(std::bit_cast<std::uint32_t>(desc.min_sample_shading));
+  return h;
+}
+
+auto
+PipelineDescriptionCache::equal(const GraphicsPipelineDescription& a,
+                                const GraphicsPipelineDescription& b) -> bool
+{
+  return a.topology == b.topology && a.vertex_input == b.vertex_input &&
+         a.shader == b.shader &&
+         equal_specialisation(a.specialisation_constants,
+                              b.specialisation_constants) &&
+         std::ranges::equal(a.color, b.color, equal_attachments) &&
+         a.depth_format == b.depth_format &&
+         a.stencil_format == b.stencil_format && a.cull_mode == b.cull_mode &&
+         a.winding == b.winding && a.polygon_mode == b.polygon_mode &&
+         equal_stencil(a.back_face_stencil, b.back_face_stencil) &&
+         equal_stencil(a.front_face_stencil, b.front_face_stencil) &&
+         a.sample_count == b.sample_count &&
+         a.patch_control_points == b.patch_control_points &&
+         a.min_sample_shading == b.min_sample_shading;
+}
+
+auto
+PipelineDescriptionCache::find(const GraphicsPipelineDescription& desc)
+  -> GraphicsPipelineHandle
+{
+  const auto it = buckets.find(hash(desc));
+  if (it == buckets.end())
+    return {};
+
+  for (auto& entry : it->second) {
+    if (equal(entry.description, desc)) {
+      entry.references++;
+      return entry.handle;
+    }
+  }
+  return {};
+}
+
+auto
+PipelineDescriptionCache::insert(const GraphicsPipelineDescription& desc,
+                                 GraphicsPipelineHandle handle) -> void
+{
+  if (!handle.valid())
+    return;
+
+  const auto h = hash(desc);
+  auto& entry = buckets[h].emplace_back(Entry{
+    .description = desc,
+    .specialisation_data = { desc.specialisation_constants.data.begin(),
+                             desc.specialisation_constants.data.end() },
+    .handle = handle,
+    .references = 1,
+  });
+  entry.description.specialisation_constants.data = entry.specialisation_data;
+  by_slot[handle.index()] = h;
+}
+
+auto
+PipelineDescriptionCache::release(GraphicsPipelineHandle handle) -> bool
+{
+  const auto slot = by_slot.find(handle.index());
+  if (slot == by_slot.end())
+    return true;
+
+  auto& bucket = buckets[slot->second];
+  const auto it = std::ranges::find_if(
+    bucket, [&](const Entry& e) { return e.handle == handle; });
+  if (it == bucket.end())
+    return true;
+
+  if (--it->references > 0)
+    return false;
+
+  bucket.erase(it);
+  if (bucket.empty())
+    buckets.erase(slot->second);
+  by_slot.erase(slot);
+  return true;
+}
+
+auto
+PipelineDescriptionCache::clear() -> void
+{
+  buckets.clear();
+  by_slot.clear();
+}
+
+}
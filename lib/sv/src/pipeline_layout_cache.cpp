@@ -0,0 +1,56 @@
+#include "sv/pipeline_layout_cache.hpp"
+
+#include <algorithm>
+
+namespace sv {
+
+auto
+PipelineLayoutCache::find(const Key& key) -> VkPipelineLayout
+{
+  const auto it = std::ranges::find(entries, key, &Entry::key);
+  if (it == entries.end())
+    return VK_NULL_HANDLE;
+
+  it->references++;
+  return it->layout;
+}
+
+auto
+PipelineLayoutCache::insert(const Key& key, VkPipelineLayout layout) -> void
+{
+  if (layout == VK_NULL_HANDLE)
+    return;
+
+  entries.push_back({ .key = key, .layout = layout, .references = 1 });
+}
+
+auto
+PipelineLayoutCache::release(VkPipelineLayout layout) -> bool
+{
+  if (layout == VK_NULL_HANDLE)
+    return false;
+
+  const auto it = std::ranges::find(entries, layout, &Entry::layout);
+  if (it == entries.end())
+    return true;
+
+  if (--it->references > 0)
+    return false;
+
+  entries.erase(it);
+  return true;
+}
+
+auto
+PipelineLayoutCache::clear() -> std::vector<VkPipelineLayout>
+{
+  std::vector<VkPipelineLayout> layouts;
+  layouts.reserve(entries.size());
+  for (const auto& entry : entries) {
+    layouts.push_back(entry.layout);
+  }
+  entries.clear();
+  return layouts;
+}
+
+}
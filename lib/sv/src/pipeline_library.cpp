@@ -0,0 +1,80 @@
+#include "sv/pipeline_library.hpp"
+
+#include <algorithm>
+
+namespace sv {
+
+auto
+PipelineLibraryCache::find(Part part, std::string_view key) -> VkPipeline
+{
+  std::scoped_lock lock{ mutex };
+  auto& entries = parts.at(static_cast<std::size_t>(part));
+  const auto it = entries.find(std::string{ key });
+  return it == entries.end() ? VK_NULL_HANDLE : it->second.library;
+}
+
+auto
+PipelineLibraryCache::insert(Part part,
+                             std::string_view key,
+                             std::span<const std::uint64_t> dependencies,
+                             VkPipeline library) -> VkPipeline
+{
+  if (library == VK_NULL_HANDLE)
+    return VK_NULL_HANDLE;
+
+  std::scoped_lock lock{ mutex };
+  auto& entries = parts.at(static_cast<std::size_t>(part));
+  const auto it = entries
+                    .try_emplace(std::string{ key },
+                                 Entry{
+                                   .library = library,
+                                   .dependencies = { dependencies.begin(),
+                                                     dependencies.end() },
+                                 })
+                    .first;
+  return it->second.library;
+}
+
+auto
+PipelineLibraryCache::evict(std::uint64_t dependency) -> std::vector<VkPipeline>
+{
+  std::vector<VkPipeline> evicted;
+  std::scoped_lock lock{ mutex };
+  for (auto& entries : parts) {
+    std::erase_if(entries, [&](const auto& kv) {
+      const auto& uses = kv.second.dependencies;
+      if (std::ranges::find(uses, dependency) == uses.end())
+        return false;
+      evicted.push_back(kv.second.library);
+      return true;
+    });
+  }
+  return evicted;
+}
+
+auto
+PipelineLibraryCache::clear() -> std::vector<VkPipeline>
+{
+  std::vector<VkPipeline> libraries;
+  std::scoped_lock lock{ mutex };
+  for (auto& entries : parts) {
+    for (const auto& [key, entry] : entries) {
+      libraries.push_back(entry.library);
+    }
+    entries.clear();
+  }
+  return libraries;
+}
+
+auto
+PipelineLibraryCache::size() const -> std::size_t
+{
+  std::scoped_lock lock{ mutex };
+  std::size_t n = 0;
+  for (const auto& entries : parts) {
+    n += entries.size();
+  }
+  return n;
+}
+
+}
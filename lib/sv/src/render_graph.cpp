@@ -0,0 +1,285 @@
+#include "sv/render_graph.hpp"
+
+#include "sv/context.hpp"
+
+#include <cassert>
+#include <format>
+#include <utility>
+
+namespace sv {
+
+namespace {
+
+// Loaded and not stored, e.g. depth tested against but never written.
+auto
+only_reads(const RenderPass::AttachmentDescription& attachment) -> bool
+{
+  return attachment.load_op == LoadOp::Load &&
+         (attachment.store_op == StoreOp::DontCare ||
+          attachment.store_op == StoreOp::None);
+}
+
+}
+
+auto
+RenderGraph::PassBuilder::colour(
+  GraphResource resource,
+  const RenderPass::AttachmentDescription& attachment) -> PassBuilder&
+{
+  auto& pass = graph->passes[index];
+  assert(pass.colour_count < max_colour_attachments);
+  pass.render_pass.color[pass.colour_count] = attachment;
+  pass.colour[pass.colour_count++] = resource;
+  return *this;
+}
+
+auto
+RenderGraph::PassBuilder::depth(
+  GraphResource resource,
+  const RenderPass::AttachmentDescription& attachment) -> PassBuilder&
+{
+  auto& pass = graph->passes[index];
+  pass.render_pass.depth = attachment;
+  pass.depth = resource;
+  return *this;
+}
+
+auto
+RenderGraph::PassBuilder::sample(GraphResource resource) -> PassBuilder&
+{
+  auto& pass = graph->passes[index];
+  assert(pass.sampled.size() < Dependencies::max_dependencies);
+  pass.sampled.push_back(resource);
+  return *this;
+}
+
+auto
+RenderGraph::PassBuilder::side_effects() -> PassBuilder&
+{
+  graph->passes[index].has_side_effects = true;
+  return *this;
+}
+
+auto
+RenderGraph::PassBuilder::record(Record callback) -> void
+{
+  graph->passes[index].record = std::move(callback);
+}
+
+RenderGraph::RenderGraph(IContext& ctx)
+  : context(&ctx)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+  // The textures go first; their memory once the GPU is done with them.
+  resources.clear();
+  for (auto allocation : memory) {
+    context->defer_task([allocation](IContext&) {
+      vmaFreeMemory(DeviceAllocator::the(), allocation);
+    });
+  }
+}
+
+auto
+RenderGraph::create_texture(const TextureDescription& description)
+  -> GraphResource
+{
+  const GraphResource resource{ static_cast<std::uint32_t>(
+    resources.size()) };
+  resources.push_back({
+    .name = std::string{ description.debug_name },
+    .imported = false,
+    .description = description,
+  });
+  return resource;
+}
+
+auto
+RenderGraph::import_texture(std::string_view name) -> GraphResource
+{
+  const GraphResource resource{ static_cast<std::uint32_t>(
+    resources.size()) };
+  resources.push_back({ .name = std::string{ name }, .imported = true });
+  return resource;
+}
+
+auto
+RenderGraph::bind(GraphResource resource, TextureHandle texture) -> void
+{
+  assert(resources.at(resource.get()).imported);
+  resources[resource.get()].texture = texture;
+}
+
+auto
+RenderGraph::add_pass(std::string_view name) -> PassBuilder
+{
+  passes.push_back({ .name = std::string{ name } });
+  return PassBuilder{ *this, static_cast<std::uint32_t>(passes.size() - 1) };
+}
+
+auto
+RenderGraph::planned_passes() const -> std::vector<PlannedPass>
+{
+  std::vector<PlannedPass> planned(passes.size());
+  for (std::uint32_t i = 0; i < passes.size(); ++i) {
+    const auto& pass = passes[i];
+    auto& out = planned[i];
+    out.has_side_effects = pass.has_side_effects;
+    out.reads = pass.sampled;
+    for (std::uint32_t c = 0; c < pass.colour_count; ++c) {
+      if (pass.render_pass.color[c].load_op == LoadOp::Load)
+        out.reads.push_back(pass.colour[c]);
+      out.writes.push_back(pass.colour[c]);
+    }
+    if (pass.depth) {
+      const auto& depth = pass.render_pass.depth;
+      if (depth.load_op == LoadOp::Load)
+        out.reads.push_back(*pass.depth);
+      if (!only_reads(depth))
+        out.writes.push_back(*pass.depth);
+    }
+  }
+  return planned;
+}
+
+auto
+RenderGraph::compile() -> Expected<void, std::string>
+{
+  assert(memory.empty() && "A render graph compiles once");
+
+  planned_resources.clear();
+  for (auto& resource : resources) {
+    resource.description.debug_name = resource.name;
+    planned_resources.push_back({
+      .imported = resource.imported,
+      .requirements =
+        resource.imported ? VkMemoryRequirements{}
+                          : VulkanTextureND::memory_requirements(
+                              *context, resource.description),
+    });
+  }
+
+  auto built = RenderGraphPlan::build(planned_passes(), planned_resources);
+  if (!built)
+    return unexpected<std::string>(std::move(built.error()));
+  plan = std::move(*built);
+
+  for (std::uint32_t slot = 0; slot < plan.memory.size(); ++slot) {
+    const auto& memory_slot = plan.memory[slot];
+    const VkMemoryRequirements requirements{
+      .size = memory_slot.size,
+      .alignment = memory_slot.alignment,
+      .memoryTypeBits = memory_slot.memory_type_bits,
+    };
+    VmaAllocationCreateInfo alloc_info = {};
+    alloc_info.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    alloc_info.priority = 1.0F;
+
+    VmaAllocation allocation{ VK_NULL_HANDLE };
+    VmaAllocationInfo info{};
+    if (vmaAllocateMemory(DeviceAllocator::the(),
+                          &requirements,
+                          &alloc_info,
+                          &allocation,
+                          &info) != VK_SUCCESS)
+      return unexpected<std::string>(std::format(
+        "Could not allocate {} bytes for render graph memory slot {}",
+        memory_slot.size,
+        slot));
+    memory.push_back(allocation);
+    set_name(*context,
+             info.deviceMemory,
+             VK_OBJECT_TYPE_DEVICE_MEMORY,
+             "DeviceMemory::RenderGraph::Slot{}",
+             slot);
+  }
+  slot_users.assign(plan.memory.size(), std::nullopt);
+
+  for (std::uint32_t i = 0; i < resources.size(); ++i) {
+    auto& resource = resources[i];
+    const auto slot = plan.slots[i];
+    if (resource.imported || slot == RenderGraphPlan::no_slot)
+      continue;
+    resource.description.aliased_memory = { memory[slot], 0 };
+    resource.owned = VulkanTextureND::create(*context, resource.description);
+    resource.texture = *resource.owned;
+  }
+  return {};
+}
+
+// Memory last used by another texture starts out undefined, once whatever
+// that texture was used for has finished.
+auto
+RenderGraph::hand_over_memory(GraphResource resource) -> void
+{
+  const auto slot = plan.slots[resource.get()];
+  if (slot == RenderGraphPlan::no_slot)
+    return;
+  const auto previous = std::exchange(slot_users[slot], resource);
+  if (!previous || *previous == resource)
+    return;
+
+  auto& pool = context->get_texture_pool();
+  const auto* before = pool.get(resources[previous->get()].texture);
+  auto* after = pool.get(resources[resource.get()].texture);
+  ImageState state{};
+  for (std::uint32_t level = 0; level < before->states.get_level_count();
+       ++level) {
+    for (std::uint32_t layer = 0; layer < before->states.get_layer_count();
+         ++layer) {
+      const auto& used = before->states.get(level, layer);
+      state.stage |= used.stage;
+      state.write_access |= used.write_access;
+    }
+  }
+  // States are tracked per level and layer, not per aspect.
+  after->states.set(
+    { 0, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS }, state);
+}
+
+auto
+RenderGraph::execute(ICommandBuffer& buf) -> void
+{
+  for (std::uint32_t position = 0; position < plan.order.size(); ++position) {
+    for (std::uint32_t i = 0; i < resources.size(); ++i) {
+      if (plan.slots[i] != RenderGraphPlan::no_slot &&
+          plan.lifetimes[i].first == position)
+        hand_over_memory(GraphResource{ i });
+    }
+
+    const auto& pass = passes[plan.order[position]];
+    Framebuffer framebuffer{ .debug_name = pass.name };
+    for (std::uint32_t c = 0; c < pass.colour_count; ++c)
+      framebuffer.color[c] = get_texture(pass.colour[c]);
+    if (pass.depth)
+      framebuffer.depth_stencil = get_texture(*pass.depth);
+
+    Dependencies dependencies{};
+    for (std::uint32_t d = 0; d < pass.sampled.size(); ++d)
+      dependencies.textures[d] = get_texture(pass.sampled[d]);
+
+    buf.cmd_begin_rendering(pass.render_pass, framebuffer, dependencies);
+    if (pass.record)
+      pass.record(buf, framebuffer);
+    buf.cmd_end_rendering();
+  }
+}
+
+auto
+RenderGraph::get_texture(GraphResource resource) const -> TextureHandle
+{
+  return resources.at(resource.get()).texture;
+}
+
+auto
+RenderGraph::get_memory_footprint() const -> MemoryFootprint
+{
+  return {
+    .aliased = plan.aliased_size(),
+    .unaliased = plan.unaliased_size(planned_resources),
+  };
+}
+
+}
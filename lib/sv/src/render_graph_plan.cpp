@@ -0,0 +1,148 @@
+#include "sv/render_graph_plan.hpp"
+
+#include <algorithm>
+#include <format>
+#include <numeric>
+
+namespace sv {
+
+namespace {
+
+auto
+overlaps(const RenderGraphPlan::Lifetime& a, const RenderGraphPlan::Lifetime& b)
+  -> bool
+{
+  return a.first <= b.last && b.first <= a.last;
+}
+
+}
+
+auto
+RenderGraphPlan::build(std::span<const PlannedPass> passes,
+                       std::span<const PlannedResource> resources)
+  -> Expected<RenderGraphPlan, std::string>
+{
+  std::vector<bool> written(resources.size(), false);
+  for (std::uint32_t i = 0; i < passes.size(); ++i) {
+    for (const auto resource : passes[i].reads) {
+      if (resource.get() >= resources.size())
+        return unexpected<std::string>(std::format(
+          "Pass {} reads unknown resource {}", i, resource.get()));
+      if (!resources[resource.get()].imported && !written[resource.get()])
+        return unexpected<std::string>(std::format(
+          "Pass {} reads resource {} before any pass writes it",
+          i,
+          resource.get()));
+    }
+    for (const auto resource : passes[i].writes) {
+      if (resource.get() >= resources.size())
+        return unexpected<std::string>(std::format(
+          "Pass {} writes unknown resource {}", i, resource.get()));
+      written[resource.get()] = true;
+    }
+  }
+
+  // Walk back from the outputs, keeping every pass whose writes are read by
+  // a pass already kept.
+  std::vector<bool> live(passes.size(), false);
+  std::vector<bool> read_later(resources.size(), false);
+  for (auto i = passes.size(); i-- > 0;) {
+    const auto& pass = passes[i];
+    live[i] = pass.has_side_effects ||
+              std::ranges::any_of(pass.writes, [&](GraphResource resource) {
+                return resources[resource.get()].imported ||
+                       read_later[resource.get()];
+              });
+    if (!live[i])
+      continue;
+    for (const auto resource : pass.reads)
+      read_later[resource.get()] = true;
+  }
+
+  RenderGraphPlan plan;
+  for (std::uint32_t i = 0; i < passes.size(); ++i) {
+    if (live[i])
+      plan.order.push_back(i);
+  }
+
+  plan.lifetimes.resize(resources.size());
+  plan.slots.assign(resources.size(), no_slot);
+  std::vector<bool> used(resources.size(), false);
+  for (std::uint32_t position = 0; position < plan.order.size(); ++position) {
+    const auto touch = [&](GraphResource resource) {
+      auto& lifetime = plan.lifetimes[resource.get()];
+      if (!used[resource.get()])
+        lifetime.first = position;
+      lifetime.last = position;
+      used[resource.get()] = true;
+    };
+    const auto& pass = passes[plan.order[position]];
+    std::ranges::for_each(pass.reads, touch);
+    std::ranges::for_each(pass.writes, touch);
+  }
+
+  // Largest first, each into the first slot it fits without overlapping.
+  std::vector<std::uint32_t> transients;
+  for (std::uint32_t i = 0; i < resources.size(); ++i) {
+    if (used[i] && !resources[i].imported)
+      transients.push_back(i);
+  }
+  std::ranges::stable_sort(transients, std::greater{}, [&](std::uint32_t i) {
+    return resources[i].requirements.size;
+  });
+
+  std::vector<std::vector<std::uint32_t>> members;
+  for (const auto resource : transients) {
+    const auto& requirements = resources[resource].requirements;
+    const auto& lifetime = plan.lifetimes[resource];
+    std::uint32_t slot = 0;
+    for (; slot < plan.memory.size(); ++slot) {
+      const auto fits =
+        (plan.memory[slot].memory_type_bits & requirements.memoryTypeBits) !=
+          0 &&
+        std::ranges::none_of(members[slot], [&](std::uint32_t other) {
+          return overlaps(plan.lifetimes[other], lifetime);
+        });
+      if (fits)
+        break;
+    }
+    if (slot == plan.memory.size()) {
+      plan.memory.emplace_back();
+      members.emplace_back();
+    }
+
+    auto& memory = plan.memory[slot];
+    memory.size = std::max(memory.size, requirements.size);
+    memory.alignment = std::max(memory.alignment, requirements.alignment);
+    memory.memory_type_bits &= requirements.memoryTypeBits;
+    members[slot].push_back(resource);
+    plan.slots[resource] = slot;
+  }
+
+  return plan;
+}
+
+auto
+RenderGraphPlan::unaliased_size(
+  std::span<const PlannedResource> resources) const -> VkDeviceSize
+{
+  VkDeviceSize size = 0;
+  for (std::uint32_t i = 0; i < slots.size(); ++i) {
+    if (slots[i] != no_slot)
+      size += resources[i].requirements.size;
+  }
+  return size;
+}
+
+auto
+RenderGraphPlan::aliased_size() const -> VkDeviceSize
+{
+  return std::accumulate(memory.begin(),
+                         memory.end(),
+                         VkDeviceSize{ 0 },
+                         [](VkDeviceSize total, const MemorySlot& slot) {
+                           return total + slot.size;
+                         });
+}
+
+}
@@ -7,11 +7,11 @@
 #include "sv/mesh_definition.hpp"
 #include "sv/object_handle.hpp"
 #include "sv/pipeline.hpp"
+#include "sv/render_graph.hpp"
 #include "sv/shader/shader.hpp"
 #include "sv/strong.hpp"
 #include "sv/texture.hpp"
 #include "sv/tracing.hpp"
-#include "sv/transitions.hpp"
 
 #include <sv/simple-mesh.hpp>
 
@@ -20,6 +20,16 @@
 #include <GLFW/glfw3.h>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <tuple>
 
 namespace sv {
 
@@ -36,9 +46,67 @@ make_device_buffer(IContext& ctx,
                                       .usage = usage,
                                       .storage = StorageType::Device,
                                       .size = data.size_bytes(),
-                                      .debug_name = std::string{ name },
+                                      .debug_name = name,
                                     });
 }
+
+// Grows the buffer when the frame needs more than it holds.
+auto
+upload_frame_buffer(IContext& ctx,
+                    Holder<BufferHandle>& buffer,
+                    const std::span<const std::byte> data,
+                    BufferUsageBits usage,
+                    std::string_view name) -> void
+{
+  if (!buffer.valid()) {
+    buffer = make_device_buffer(
+      ctx, data, usage | BufferUsageBits::Destination, name);
+    return;
+  }
+  ctx.recreate_buffer(buffer, data.size_bytes(), data, 0, false);
+}
+
+// Orders by mesh first, so the keys of one mesh are drawn together.
+auto
+draws_before(const DrawKey& a, const DrawKey& b) -> bool
+{
+  if (a.mesh != b.mesh)
+    return std::less{}(a.mesh, b.mesh);
+  return std::tie(a.lod, a.material_index) < std::tie(b.lod, b.material_index);
+}
+}
+
+auto
+InstanceData::create(const glm::mat4& model, const std::uint32_t material_index)
+  -> InstanceData
+{
+  const auto rows = glm::transpose(model);
+  InstanceData data{
+    .model_rows = { rows[0], rows[1], rows[2] },
+    .material_index = material_index,
+  };
+
+  // The cofactor matrix is the inverse transpose scaled by the determinant.
+  // Shaders normalise, so only its direction and the determinant's sign
+  // matter, and it is scaled to fit the snorm range.
+  const glm::mat3 m{ model };
+  const std::array normal{
+    glm::cross(m[1], m[2]),
+    glm::cross(m[2], m[0]),
+    glm::cross(m[0], m[1]),
+  };
+  float largest = 0.0F;
+  for (const auto& column : normal) {
+    const auto magnitude = glm::abs(column);
+    largest = std::max({ largest, magnitude.x, magnitude.y, magnitude.z });
+  }
+  const auto sign = glm::dot(m[0], normal[0]) < 0.0F ? -1.0F : 1.0F;
+  const auto scale = largest > 0.0F ? sign / largest : 0.0F;
+  std::ranges::transform(
+    normal, data.normal_columns.begin(), [scale](const glm::vec3& column) {
+      return glm::packSnorm3x10_1x2(glm::vec4{ column * scale, 0.0F });
+    });
+  return data;
 }
 
 struct Renderer::Impl
@@ -73,8 +141,14 @@ Renderer::Renderer(IContext& ctx,
     VertexFormat::Int_2_10_10_10_REV,
   });
 
-  deferred_mrt.shader =
-    VulkanShader::create(ctx, "shaders/gbuffer_object.glsl");
+  const std::array<std::filesystem::path, 5> shader_paths{
+    "shaders/gbuffer_object.glsl",     "shaders/gbuffer_lighting.glsl",
+    "shaders/tonemap_hdr_to_sdr.glsl", "shaders/grid.shader",
+    "shaders/directional_shadow.shader",
+  };
+  auto shaders = VulkanShader::create_batch(ctx, shader_paths);
+
+  deferred_mrt.shader = std::move(shaders[0]);
   deferred_mrt.pipeline = VulkanGraphicsPipeline::create(
     ctx,
     {
@@ -95,8 +169,7 @@ Renderer::Renderer(IContext& ctx,
       .debug_name = "MRT GBuffer"
     });
 
-  deferred_hdr_gbuffer.shader =
-    VulkanShader::create(ctx, "shaders/gbuffer_lighting.glsl");
+  deferred_hdr_gbuffer.shader = std::move(shaders[1]);
   deferred_hdr_gbuffer.pipeline =
   VulkanGraphicsPipeline::create(
     ctx,
@@ -108,7 +181,7 @@ Renderer::Renderer(IContext& ctx,
       .debug_name = "Lighting GBuffer"
     });
 
-  tonemap.shader = VulkanShader::create(ctx, "shaders/tonemap_hdr_to_sdr.glsl");
+  tonemap.shader = std::move(shaders[2]);
   tonemap.pipeline =VulkanGraphicsPipeline::create(
     ctx,
     {
@@ -119,7 +192,7 @@ Renderer::Renderer(IContext& ctx,
       .debug_name = "Tonemap"
     });
 
-  grid.shader = VulkanShader::create(*context, "shaders/grid.shader");
+  grid.shader = std::move(shaders[3]);
   grid.pipeline = VulkanGraphicsPipeline::create(
     *context,
     {
@@ -134,8 +207,7 @@ Renderer::Renderer(IContext& ctx,
       .debug_name = "Grid Pipeline",
     });
 
-  directional_shadow.shader =
-    VulkanShader::create(*context, "shaders/directional_shadow.shader");
+  directional_shadow.shader = std::move(shaders[4]);
   directional_shadow.pipeline =
     VulkanGraphicsPipeline::create(*context,
                                    {
@@ -183,53 +255,57 @@ auto
 Renderer::build_frame_batches(const std::uint32_t frame_index) -> void
 {
   auto& fd = frame_draws[frame_index % frames_in_flight];
+  if (fd.submissions.empty())
+    return;
 
-  for (auto&& [key, batch] : fd.batches) {
-    const auto index_count =
-      key.mesh->get_file().mesh.meshes.at(0).get_lod_index_count(key.lod);
-    const auto first_index =
-      key.mesh->get_file().mesh.meshes.at(0).lod_offset.at(key.lod);
-    const auto vertex_offset = static_cast<std::int32_t>(
-      key.mesh->get_file().mesh.meshes.at(0).vertex_offset);
-
-    batch.base_instance = 0;
-
-    VkDrawIndexedIndirectCommand cmd{};
-    cmd.indexCount = index_count;
-    cmd.instanceCount = static_cast<std::uint32_t>(batch.instances_cpu.size());
-    cmd.firstIndex = first_index;
-    cmd.vertexOffset = vertex_offset;
-    cmd.firstInstance = batch.base_instance;
-    batch.draws_cpu = { cmd };
-
-    const auto instances_bytes =
-      std::as_bytes(std::span{ batch.instances_cpu });
-    const auto draws_bytes = std::as_bytes(std::span{ batch.draws_cpu });
-
-    if (!batch.instances_ssbo.valid()) {
-      batch.instances_ssbo = make_device_buffer(*context,
-                                                instances_bytes,
-                                                BufferUsageBits::Storage |
-                                                  BufferUsageBits::Destination,
-                                                "InstancesSSBO");
-    } else {
-      context->recreate_buffer(batch.instances_ssbo,
-                               instances_bytes.size_bytes(),
-                               instances_bytes,
-                               0,
-                               false);
+  // Instances of one key end up next to each other, and keys of one mesh too.
+  std::ranges::sort(fd.submissions, draws_before, &FrameDraws::Submission::key);
+
+  const auto same_key = [](const auto& a, const auto& b) {
+    return a.key == b.key;
+  };
+  for (const auto group : fd.submissions | std::views::chunk_by(same_key)) {
+    const auto& key = group.front().key;
+    if (fd.meshes.empty() || fd.meshes.back().mesh != key.mesh) {
+      fd.meshes.push_back({
+        .mesh = key.mesh,
+        .first_command = static_cast<std::uint32_t>(fd.commands.size()),
+      });
     }
-    if (!batch.indirect_buffer.valid()) {
-      batch.indirect_buffer = make_device_buffer(*context,
-                                                 draws_bytes,
-                                                 BufferUsageBits::Indirect |
-                                                   BufferUsageBits::Destination,
-                                                 "IndirectBuffer");
-    } else {
-      context->recreate_buffer(
-        batch.indirect_buffer, draws_bytes.size_bytes(), draws_bytes, 0, false);
+
+    // Every submesh draws the same run of instances; its material is added
+    // per command through draw_materials.
+    const auto first_instance = static_cast<std::uint32_t>(fd.instances.size());
+    for (const auto& [_, instance] : group)
+      fd.instances.push_back(instance);
+
+    const auto& submeshes = key.mesh->get_file().mesh.meshes;
+    const auto commands = key.mesh->get_draw_commands(key.lod);
+    for (std::size_t i = 0; i < commands.size(); ++i) {
+      auto command = commands[i];
+      command.instanceCount = static_cast<std::uint32_t>(group.size());
+      command.firstInstance = first_instance;
+      fd.commands.push_back(command);
+      fd.draw_materials.push_back(submeshes[i].material_index);
+      fd.meshes.back().command_count++;
     }
   }
+
+  upload_frame_buffer(*context,
+                      fd.instance_buffer,
+                      std::as_bytes(std::span{ fd.instances }),
+                      BufferUsageBits::Storage,
+                      "FrameInstances");
+  upload_frame_buffer(*context,
+                      fd.indirect_buffer,
+                      std::as_bytes(std::span{ fd.commands }),
+                      BufferUsageBits::Indirect,
+                      "FrameIndirectCommands");
+  upload_frame_buffer(*context,
+                      fd.draw_material_buffer,
+                      std::as_bytes(std::span{ fd.draw_materials }),
+                      BufferUsageBits::Storage,
+                      "FrameDrawMaterials");
 }
 
 auto
@@ -239,13 +315,10 @@ Renderer::submit(const RenderMesh& mesh,
                  const std::uint32_t lod) -> void
 {
   auto& fd = frame_draws[current_frame % frames_in_flight];
-  const DrawKey key{ &mesh, lod, material_index };
-  auto& batch = fd.batches[key];
-
-  InstanceData inst{};
-  inst.model = model;
-  inst.material_index = material_index;
-  batch.instances_cpu.emplace_back(inst);
+  fd.submissions.push_back({
+    .key = { &mesh, lod, material_index },
+    .instance = InstanceData::create(model, material_index),
+  });
 }
 
 auto
@@ -253,101 +326,97 @@ Renderer::resize(const std::uint32_t width, const std::uint32_t height) -> void
 {
   vkDeviceWaitIdle(context->get_device());
 
-  const auto ensure = [this](auto& h, const TextureDescription& d) {
-    if (h.valid())
-      context->recreate_texture(h, d);
-    else
-      h = VulkanTextureND::create(*context, d);
-  };
+  deferred_extent = { width, height };
+  graph.reset();
+  graph = std::make_unique<RenderGraph>(*context);
+  auto& g = *graph;
 
-  const auto hdr_desc = TextureDescription{
+  swapchain = g.import_texture("Swapchain");
+  deferred_hdr_gbuffer.hdr = g.create_texture({
     .format = Format::RGBA_F32,
     .dimensions = { width, height },
     .usage_bits = TextureUsageBits::Sampled | TextureUsageBits::Attachment,
     .debug_name = "GBuffer_Lighting_HDR_RGBA_F32",
-  };
-  ensure(deferred_hdr_gbuffer.hdr, hdr_desc);
-
-  const auto depth_desc = TextureDescription{
+  });
+  deferred_mrt.depth_32 = g.create_texture({
     .format = Format::Z_F32_S_UI8,
     .dimensions = { width, height },
     .usage_bits = TextureUsageBits::Sampled | TextureUsageBits::Attachment,
     .debug_name = "MRT_Depth_F32_S_UI8",
-  };
-  ensure(deferred_mrt.depth_32, depth_desc);
-
-  const auto material_id_desc = TextureDescription{
+  });
+  deferred_mrt.material_id = g.create_texture({
     .format = Format::R_UI32,
     .dimensions = { width, height },
     .usage_bits = TextureUsageBits::Sampled | TextureUsageBits::Attachment,
     .debug_name = "MRT_Material_R32",
-  };
-  ensure(deferred_mrt.material_id, material_id_desc);
-
-  const auto uvs_desc = TextureDescription{
+  });
+  deferred_mrt.uvs = g.create_texture({
     .format = Format::RG_F16,
     .dimensions = { width, height },
     .usage_bits = TextureUsageBits::Sampled | TextureUsageBits::Attachment,
     .debug_name = "MRT_UVS_RGF16",
-  };
-  ensure(deferred_mrt.uvs, uvs_desc);
-
-  const auto normals_desc = TextureDescription{
+  });
+  deferred_mrt.oct_normals_extras_tbd = g.create_texture({
     .format = Format::A2R10G10B10_UN,
     .dimensions = { width, height },
     .usage_bits = TextureUsageBits::Sampled | TextureUsageBits::Attachment,
     .debug_name = "MRT_Normals_A1R5G5B5",
-  };
-  ensure(deferred_mrt.oct_normals_extras_tbd, normals_desc);
-
+  });
   constexpr auto shadow_map_size = 1 << 12;
-  const auto shadow_map_desc = TextureDescription{
+  directional_shadow.texture = g.create_texture({
     .format = Format::Z_F32_S_UI8,
     .dimensions = { shadow_map_size, shadow_map_size },
     .layer_count = 4,
     .usage_bits = TextureUsageBits::Sampled | TextureUsageBits::Attachment,
     .debug_name = "Directional_Shadow_Map_F32",
-  };
-  ensure(directional_shadow.texture, shadow_map_desc);
+  });
 
-  deferred_extent = { width, height };
+  // Phases run in the order they are added.
+  add_gbuffer_pass(g);
+  add_shadow_passes(g);
+  add_lighting_pass(g);
+  add_forward_pass(g);
+  add_tonemap_pass(g);
+  add_ui_pass(g);
+
+  if (auto compiled = g.compile(); !compiled) {
+    std::cerr << "Render graph: " << compiled.error() << std::endl;
+    assert(false);
+  }
 
   vkDeviceWaitIdle(context->get_device());
 }
 
 auto
-clear_depth_image(VkCommandBuffer cmd,
-                  VkImage image,
-                  VkImageLayout current_layout,
-                  float depth_value,
-                  uint32_t layer_count,
-                  uint32_t mip_levels = 1) -> void
+Renderer::draw_frame_batches(
+  ICommandBuffer& buf,
+  const std::function<void(const FrameDraws::MeshRange&)>& before_range)
+  -> void
 {
-  VkClearDepthStencilValue clear{};
-  clear.depth = depth_value;
-  clear.stencil = 0xFF;
-
-  VkImageSubresourceRange range{};
-  range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
-  range.baseMipLevel = 0;
-  range.levelCount = mip_levels;
-  range.baseArrayLayer = 0;
-  range.layerCount = layer_count;
-
-  vkCmdClearDepthStencilImage(
-    cmd,
-    image,
-    current_layout, // must be GENERAL or TRANSFER_DST_OPTIMAL
-    &clear,
-    1,
-    &range);
+  const auto& fd = frame_draws[current_frame % frames_in_flight];
+  constexpr auto stride =
+    static_cast<std::uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+
+  for (const auto& range : fd.meshes) {
+    buf.cmd_bind_vertex_buffer(0, *range.mesh->get_vertex_buffer(), 0);
+    buf.cmd_bind_index_buffer(
+      *range.mesh->get_index_buffer(), IndexFormat::UI32, 0);
+    if (before_range)
+      before_range(range);
+    buf.cmd_draw_indexed_indirect(*fd.indirect_buffer,
+                                  range.first_command * stride,
+                                  range.command_count,
+                                  stride);
+  }
 }
 
 auto
 Renderer::draw_gbuffer_batches_shadow(ICommandBuffer& buf,
                                       const CascadeIndex cascade_index) -> void
 {
-  auto& fd = frame_draws[current_frame % frames_in_flight];
+  const auto& fd = frame_draws[current_frame % frames_in_flight];
+  if (fd.commands.empty())
+    return;
 
   buf.cmd_bind_graphics_pipeline(*directional_shadow.pipeline);
   buf.cmd_bind_depth_state({
@@ -355,346 +424,297 @@ Renderer::draw_gbuffer_batches_shadow(ICommandBuffer& buf,
     .is_depth_write_enabled = true,
   });
 
-  struct PC
+  const struct PC
   {
     std::uint64_t ubo_ref;
     std::uint64_t instances_addr;
     std::uint32_t cascade_index{ 0 };
     std::uint32_t _pad{ 0 };
-  } pc{ shadow_ubo.get(current_frame), 0, cascade_index.get() };
-
-  for (auto& [key, batch] : fd.batches) {
-    pc.instances_addr = context->get_buffer_pool()
-                          .get(*batch.instances_ssbo)
-                          ->get_device_address();
-    buf.cmd_push_constants(pc, 0);
-
-    buf.cmd_bind_vertex_buffer(0, *key.mesh->get_vertex_buffer(), 0);
-    buf.cmd_bind_index_buffer(
-      *key.mesh->get_index_buffer(), IndexFormat::UI32, 0);
-
-    buf.cmd_draw_indexed_indirect(
-      *batch.indirect_buffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
-  }
+  } pc{
+    shadow_ubo.get(current_frame),
+    context->get_buffer_pool().get(*fd.instance_buffer)->get_device_address(),
+    cascade_index.get(),
+  };
+  buf.cmd_push_constants(pc, 0);
+  draw_frame_batches(buf);
 }
 
 auto
 Renderer::draw_gbuffer_batches(ICommandBuffer& buf) -> void
 {
-  auto& fd = frame_draws[current_frame % frames_in_flight];
+  const auto& fd = frame_draws[current_frame % frames_in_flight];
+  if (fd.commands.empty())
+    return;
 
   buf.cmd_bind_graphics_pipeline(*deferred_mrt.pipeline);
   buf.cmd_bind_depth_state({ .compare_operation = CompareOp::Greater,
                              .is_depth_write_enabled = true });
 
+  // gl_DrawID restarts at every multi-draw, so each mesh range pushes the
+  // index of its first command into draw_materials.
   struct PC
   {
     std::uint64_t ubo_ref;
     std::uint64_t instances_addr;
-  } pc{ ubo.get(current_frame), 0 };
-
-  for (auto& [key, batch] : fd.batches) {
-    pc.instances_addr = context->get_buffer_pool()
-                          .get(*batch.instances_ssbo)
-                          ->get_device_address();
+    std::uint64_t draw_materials_addr;
+    std::uint32_t first_command{ 0 };
+    std::uint32_t _pad{ 0 };
+  } pc{
+    ubo.get(current_frame),
+    context->get_buffer_pool().get(*fd.instance_buffer)->get_device_address(),
+    context->get_buffer_pool()
+      .get(*fd.draw_material_buffer)
+      ->get_device_address(),
+  };
+  draw_frame_batches(buf, [&](const FrameDraws::MeshRange& range) {
+    pc.first_command = range.first_command;
     buf.cmd_push_constants(pc, 0);
-
-    buf.cmd_bind_vertex_buffer(0, *key.mesh->get_vertex_buffer(), 0);
-    buf.cmd_bind_index_buffer(
-      *key.mesh->get_index_buffer(), IndexFormat::UI32, 0);
-
-    buf.cmd_draw_indexed_indirect(
-      *batch.indirect_buffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
-  }
+  });
 }
 
 auto
-Renderer::record(ICommandBuffer& buf, TextureHandle present) -> void
+Renderer::add_gbuffer_pass(RenderGraph& g) -> void
 {
-  // Couple of phases.
-  // 1: GBuffer static meshes, fully multidraw indirect
-  // 1*: Shadows somehow
-  // 2: Resolve lighting, sample gbuffer
-  // 3: Forward rendering into the resolved lighting
-  // 4: Sample resolved lighting in the swapchain
-
-  build_frame_batches(current_frame);
-
-  {
-    ZoneScopedNC("GBuffer", 0xFF00FF);
-    const RenderPass gbuffer_render_pass{
-      .color{
-        RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Clear,
-          .store_op = StoreOp::Store,
-          .clear_colour = { std::array<float, 4>{ 0, 0, 0, 0 } },
-        },
-        RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Clear,
-          .store_op = StoreOp::Store,
-          .clear_colour = { std::array<float, 4>{ 0, 0, 0, 0 } },
-        },
-        RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Clear,
-          .store_op = StoreOp::Store,
-          .clear_colour = { std::array<float, 4>{ 0, 0, 0, 0 } },
-        },
-      },
-      .depth =
-        RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Clear,
-          .store_op = StoreOp::Store,
-          .clear_depth = 0.0F, // Reverse Z
-        },
-    };
-
-    const Framebuffer gbuffer_framebuffer{
-    .color = {
-      Framebuffer::AttachmentDescription{deferred_mrt.material_id},
-      Framebuffer::AttachmentDescription{deferred_mrt.oct_normals_extras_tbd},
-      Framebuffer::AttachmentDescription{deferred_mrt.uvs},
-    },
-    .depth_stencil = {
-          deferred_mrt.depth_32,
-    },
-    .debug_name = "MRT_GBuffer"
+  const RenderPass::AttachmentDescription cleared{
+    .load_op = LoadOp::Clear,
+    .store_op = StoreOp::Store,
+    .clear_colour = { std::array<float, 4>{ 0, 0, 0, 0 } },
   };
+  g.add_pass("MRT_GBuffer")
+    .colour(deferred_mrt.material_id, cleared)
+    .colour(deferred_mrt.oct_normals_extras_tbd, cleared)
+    .colour(deferred_mrt.uvs, cleared)
+    .depth(deferred_mrt.depth_32,
+           {
+             .load_op = LoadOp::Clear,
+             .store_op = StoreOp::Store,
+             .clear_depth = 0.0F, // Reverse Z
+           })
+    .record([this](ICommandBuffer& buf, const Framebuffer&) {
+      ZoneScopedNC("GBuffer", 0xFF00FF);
+      draw_gbuffer_batches(buf);
+    });
+}
 
-    buf.cmd_begin_rendering(gbuffer_render_pass, gbuffer_framebuffer, {});
-    draw_gbuffer_batches(buf);
-    buf.cmd_end_rendering();
+auto
+Renderer::add_shadow_passes(RenderGraph& g) -> void
+{
+  // One pass per cascade, each clearing and drawing its own layer.
+  for (std::uint8_t c = 0; c < 4; ++c) {
+    g.add_pass("Directional_Shadow")
+      .depth(directional_shadow.texture,
+             {
+               .load_op = LoadOp::Clear,
+               .store_op = StoreOp::Store,
+               .layer = c,
+               .clear_depth = 0.0F,
+               .clear_stencil = 0xFF,
+             })
+      .record([this, c](ICommandBuffer& buf, const Framebuffer&) {
+        ZoneScopedNC("Directional shadow pass", 0x0F0F0F);
+        draw_gbuffer_batches_shadow(buf, CascadeIndex{ c });
+      });
   }
+}
 
-  {
-    ZoneScopedNC("Directional shadow pass", 0x0F0F0F);
-    ImageTransition::transition_layout(
-      buf.get_command_buffer(),
-      context->get_texture_pool().get(*directional_shadow.texture)->image,
-      VK_IMAGE_LAYOUT_UNDEFINED,
-      VK_IMAGE_LAYOUT_GENERAL,
-      { VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT,
-        0,
-        VK_REMAINING_MIP_LEVELS,
+auto
+Renderer::add_lighting_pass(RenderGraph& g) -> void
+{
+  g.add_pass("GBuffer_Resolve")
+    .colour(deferred_hdr_gbuffer.hdr,
+            {
+              .load_op = LoadOp::Clear,
+              .store_op = StoreOp::Store,
+              .clear_colour = std::array<float, 4>{ 0, 0, 0, 0 },
+            })
+    .sample(deferred_mrt.oct_normals_extras_tbd)
+    .sample(deferred_mrt.depth_32)
+    .sample(deferred_mrt.material_id)
+    .sample(deferred_mrt.uvs)
+    .sample(directional_shadow.texture)
+    .record([this](ICommandBuffer& buf, const Framebuffer&) {
+      ZoneScopedNC("GBuffer Resolve", 0x00FFFF);
+      buf.cmd_bind_graphics_pipeline(*deferred_hdr_gbuffer.pipeline);
+      struct PC
+      {
+        std::uint32_t normals_tex;
+        std::uint32_t depth_tex;
+        std::uint32_t material_tex;
+        std::uint32_t uvs_tex;
+        std::uint32_t sampler_id;
+
+        std::uint32_t shadow_tex;
+        std::uint32_t shadow_sampler_id;
+        std::uint32_t shadow_layers;
+        std::uint64_t ubo;
+      } pc{
+        graph->get_texture(deferred_mrt.oct_normals_extras_tbd).index(),
+        graph->get_texture(deferred_mrt.depth_32).index(),
+        graph->get_texture(deferred_mrt.material_id).index(),
+        graph->get_texture(deferred_mrt.uvs).index(),
         0,
-        VK_REMAINING_ARRAY_LAYERS });
-
-    clear_depth_image(
-      buf.get_command_buffer(),
-      context->get_texture_pool().get(*directional_shadow.texture)->image,
-      VK_IMAGE_LAYOUT_GENERAL,
-      0.0F,
-      context->get_texture_pool()
-        .get(*directional_shadow.texture)
-        ->layer_count);
-
-    for (std::uint8_t c = 0; c < 4; ++c) {
-      RenderPass rp{
-      .depth = {
-        .load_op = LoadOp::Clear,
-        .store_op = StoreOp::Store,
-        .layer = c,
-        .clear_depth = 0.0F,
-        .clear_stencil = 0xFF,
-      },
-    };
-      Framebuffer fb{
-        .depth_stencil =
-          Framebuffer::AttachmentDescription{ *directional_shadow.texture },
+        graph->get_texture(directional_shadow.texture).index(),
+        directional_shadow.sampler.index(),
+        4,
+        ubo.get(current_frame),
       };
+      buf.cmd_bind_depth_state({
+        .compare_operation = CompareOp::AlwaysPass,
+      });
+      buf.cmd_push_constants(pc, 0);
+      buf.cmd_draw(3, 1, 0, 0);
+    });
+}
 
-      buf.cmd_begin_rendering(rp, fb, {});
-      draw_gbuffer_batches_shadow(buf, CascadeIndex{ c });
-      buf.cmd_end_rendering();
-    }
-  }
+auto
+Renderer::add_forward_pass(RenderGraph& g) -> void
+{
+  g.add_pass("Forward FB")
+    .colour(deferred_hdr_gbuffer.hdr,
+            {
+              .load_op = LoadOp::Load,
+              .store_op = StoreOp::Store,
+            })
+    .depth(deferred_mrt.depth_32,
+           {
+             .load_op = LoadOp::Load,
+             .store_op = StoreOp::DontCare,
+           })
+    .record([this](ICommandBuffer& buf, const Framebuffer& framebuffer) {
+      ZoneScopedNC("Forward pass", 0x22FF22);
+      buf.cmd_bind_graphics_pipeline(*grid.pipeline);
+      buf.cmd_bind_depth_state({
+        .compare_operation = CompareOp::Greater,
+      });
+      struct GridPC
+      {
+        std::uint64_t ubo_address; // matches UBO pc
+        std::uint64_t padding{ 0 };
+        alignas(16) glm::vec4 origin;
+        alignas(16) glm::vec4 grid_colour_thin;
+        alignas(16) glm::vec4 grid_colour_thick;
+        alignas(16) glm::vec4 grid_params;
+      };
+      GridPC grid_pc{
+        .ubo_address = ubo.get(current_frame),
+        .origin = glm::vec4{ 0.0f },
+        .grid_colour_thin = glm::vec4{ 0.5f, 0.5f, 0.5f, 1.0f },
+        .grid_colour_thick = glm::vec4{ 0.15f, 0.15f, 0.15f, 1.0f },
+        .grid_params = glm::vec4{ 100.0f, 0.025f, 2.0f, 0.0f },
+      };
+      buf.cmd_push_constants<GridPC>(grid_pc, 0);
+      buf.cmd_draw(6, 1, 0, 0);
+
+      canvas_3d.clear();
+
+      canvas_3d.box(glm::translate(glm::mat4{ 1.0F }, glm::vec3{ 5, 5, 0 }),
+                    BoundingBox(glm::vec3(-2), glm::vec3(+2)),
+                    glm::vec4(1, 1, 0, 1));
+      static auto initial_pos = -8.F;
+      auto&& [w, h] = deferred_extent;
+      canvas_3d.frustum(
+        glm::lookAt(
+          glm::vec3(cos(glfwGetTime()), initial_pos, sin(glfwGetTime())),
+          glm::vec3{ 0, 7, -4 },
+          glm::vec3(0.0f, 1.0f, 0.0f)),
+        glm::perspective(
+          glm::radians(60.0f), static_cast<float>(w) / h, 10.0f, 30.0f),
+        glm::vec4(1, 1, 1, 1));
+      canvas_3d.render(*context, framebuffer, buf, 1);
+    });
+}
 
-  {
-    ZoneScopedNC("GBuffer Resolve", 0x00FFFF);
-    buf.cmd_begin_rendering(
-      { .color = { RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Clear,
-          .store_op = StoreOp::Store,
-          .clear_colour = std::array<float, 4>{ 0, 0, 0, 0 },
-        } } },
-      { .color = { Framebuffer::AttachmentDescription{
-          *deferred_hdr_gbuffer.hdr, }, }, },
-      {});
-    buf.cmd_bind_graphics_pipeline(*deferred_hdr_gbuffer.pipeline);
-    struct PC
-    {
-      std::uint32_t normals_tex;
-      std::uint32_t depth_tex;
-      std::uint32_t material_tex;
-      std::uint32_t uvs_tex;
-      std::uint32_t sampler_id;
-
-      std::uint32_t shadow_tex;
-      std::uint32_t shadow_sampler_id;
-      std::uint32_t shadow_layers;
-      std::uint64_t ubo;
-    } pc{
-      deferred_mrt.oct_normals_extras_tbd.index(),
-      deferred_mrt.depth_32.index(),
-      deferred_mrt.material_id.index(),
-      deferred_mrt.uvs.index(),
-      0,
-      directional_shadow.texture.index(),
-      directional_shadow.sampler.index(),
-      4,
-      ubo.get(current_frame),
-    };
-    buf.cmd_bind_depth_state({
-      .compare_operation = CompareOp::AlwaysPass,
+auto
+Renderer::add_tonemap_pass(RenderGraph& g) -> void
+{
+  g.add_pass("Swapchain_Tonemap")
+    .colour(swapchain,
+            {
+              .load_op = LoadOp::Clear,
+              .store_op = StoreOp::Store,
+              .clear_colour = { std::array<float, 4>{ 0, 0, 0, 0 } },
+            })
+    .sample(deferred_hdr_gbuffer.hdr)
+    .record([this](ICommandBuffer& buf, const Framebuffer&) {
+      buf.cmd_bind_graphics_pipeline(*tonemap.pipeline);
+      buf.cmd_bind_depth_state({});
+      const struct TonemapPC
+      {
+        std::uint32_t hdr_tex;
+        std::uint32_t sampler_id;
+        float exposure;
+      } tonemap_pc{
+        .hdr_tex = graph->get_texture(deferred_hdr_gbuffer.hdr).index(),
+        .sampler_id = 0,
+        .exposure = 1.0F,
+      };
+      buf.cmd_push_constants(tonemap_pc, 0);
+      buf.cmd_draw(3, 1, 0, 0);
     });
-    buf.cmd_push_constants(pc, 0);
-    buf.cmd_draw(3, 1, 0, 0);
-    buf.cmd_end_rendering();
-  }
+}
 
-  {
-    ZoneScopedNC("Forward pass", 0x22FF22);
-    RenderPass forward_pass{
-    .color = {
-        RenderPass::AttachmentDescription{
-            .load_op = LoadOp::Load,
-            .store_op = StoreOp::Store,
-        },
-    },
-    .depth = {.load_op = LoadOp::Load, .store_op = StoreOp::DontCare,},
-    .stencil = {},
-    .layer_count = 1,
-    .view_mask = 0,
-    };
-
-    Framebuffer forward_framebuffer{
-    .color = {
-        Framebuffer::AttachmentDescription{  *deferred_hdr_gbuffer.hdr },
-    },
-    .depth_stencil = {
-      *deferred_mrt.depth_32
-    },
-    .debug_name = "Forward FB",
-};
-    buf.cmd_begin_rendering(forward_pass, forward_framebuffer, {});
-    buf.cmd_bind_graphics_pipeline(*grid.pipeline);
-    buf.cmd_bind_depth_state({
-      .compare_operation = CompareOp::Greater,
+auto
+Renderer::add_ui_pass(RenderGraph& g) -> void
+{
+  g.add_pass("Swapchain_UI")
+    .colour(swapchain,
+            {
+              .load_op = LoadOp::Load,
+              .store_op = StoreOp::Store,
+            })
+    .depth(deferred_mrt.depth_32,
+           {
+             .load_op = LoadOp::Load,
+             .store_op = StoreOp::DontCare,
+           })
+    .record([this](ICommandBuffer& buf, const Framebuffer& framebuffer) {
+      imgui->begin_frame(framebuffer);
+      ImGui::Begin("Light direction");
+      ImGui::SliderAngle("Light Direction (phi)",
+                         &rad_phi,
+                         0.0F,
+                         360.0F,
+                         "%.1f",
+                         ImGuiSliderFlags_AlwaysClamp);
+      ImGui::SliderAngle("Light Direction (theta)",
+                         &rad_theta,
+                         -180.0F,
+                         180.0F,
+                         "%.1f",
+                         ImGuiSliderFlags_AlwaysClamp);
+      ImGui::End();
+
+      ImGui::Begin("Caches");
+      const auto& pipelines = context->get_pipeline_cache().get_telemetry();
+      ImGui::Text("Pipelines: %u compiled in %.2f ms, %u deduplicated",
+                  pipelines.compiled,
+                  std::chrono::duration<double, std::milli>(
+                    pipelines.compile_time)
+                    .count(),
+                  pipelines.deduplicated);
+      ImGui::Text("Pipeline cache: %zu bytes loaded", pipelines.bytes_loaded);
+      const auto shaders = context->get_shader_cache().get_telemetry();
+      ImGui::Text("Shader stages: %u loaded in %.2f ms, %u compiled in %.2f ms",
+                  shaders.hits,
+                  std::chrono::duration<double, std::milli>(shaders.load_time)
+                    .count(),
+                  shaders.misses,
+                  std::chrono::duration<double, std::milli>(
+                    shaders.compile_time)
+                    .count());
+      ImGui::End();
+      imgui->end_frame(buf);
     });
-    struct GridPC
-    {
-      std::uint64_t ubo_address; // matches UBO pc
-      std::uint64_t padding{ 0 };
-      alignas(16) glm::vec4 origin;
-      alignas(16) glm::vec4 grid_colour_thin;
-      alignas(16) glm::vec4 grid_colour_thick;
-      alignas(16) glm::vec4 grid_params;
-    };
-    GridPC grid_pc{
-      .ubo_address = ubo.get(current_frame),
-      .origin = glm::vec4{ 0.0f },
-      .grid_colour_thin = glm::vec4{ 0.5f, 0.5f, 0.5f, 1.0f },
-      .grid_colour_thick = glm::vec4{ 0.15f, 0.15f, 0.15f, 1.0f },
-      .grid_params = glm::vec4{ 100.0f, 0.025f, 2.0f, 0.0f },
-    };
-    buf.cmd_push_constants<GridPC>(grid_pc, 0);
-    buf.cmd_draw(6, 1, 0, 0);
-
-    canvas_3d.clear();
-
-    canvas_3d.box(glm::translate(glm::mat4{ 1.0F }, glm::vec3{ 5, 5, 0 }),
-                  BoundingBox(glm::vec3(-2), glm::vec3(+2)),
-                  glm::vec4(1, 1, 0, 1));
-    static auto initial_pos = -8.F;
-    auto&& [w, h] = deferred_extent;
-    canvas_3d.frustum(
-      glm::lookAt(
-        glm::vec3(cos(glfwGetTime()), initial_pos, sin(glfwGetTime())),
-        glm::vec3{ 0, 7, -4 },
-        glm::vec3(0.0f, 1.0f, 0.0f)),
-      glm::perspective(
-        glm::radians(60.0f), static_cast<float>(w) / h, 10.0f, 30.0f),
-      glm::vec4(1, 1, 1, 1));
-    canvas_3d.render(*context, forward_framebuffer, buf, 1);
-
-    buf.cmd_end_rendering();
-  }
+}
 
-  {
-    const RenderPass tonemap_render_pass{
-      .color{
-        RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Clear,
-          .store_op = StoreOp::Store,
-          .clear_colour = { std::array<float, 4>{ 0, 0, 0, 0 } },
-        },
-      },
-    };
-
-    const Framebuffer tonemap_framebuffer{
-      .color = { Framebuffer::AttachmentDescription{ present } },
-      .debug_name = "Swapchain_Tonemap"
-    };
-
-    buf.cmd_begin_rendering(tonemap_render_pass, tonemap_framebuffer, {});
-    buf.cmd_bind_graphics_pipeline(*tonemap.pipeline);
-    buf.cmd_bind_depth_state({});
-    const struct TonemapPC
-    {
-      std::uint32_t hdr_tex;
-      std::uint32_t sampler_id;
-      float exposure;
-    } tonemap_pc{
-      .hdr_tex = deferred_hdr_gbuffer.hdr.index(),
-      .sampler_id = 0,
-      .exposure = 1.0F,
-    };
-    buf.cmd_push_constants(tonemap_pc, 0);
-    buf.cmd_draw(3, 1, 0, 0);
-    buf.cmd_end_rendering();
-  }
+auto
+Renderer::record(ICommandBuffer& buf, TextureHandle present) -> void
+{
+  build_frame_batches(current_frame);
+
+  graph->bind(swapchain, present);
+  graph->execute(buf);
 
-  {
-    const RenderPass ui_render_pass{
-      .color{
-        RenderPass::AttachmentDescription{
-          .load_op = LoadOp::Load,
-          .store_op = StoreOp::Store,
-        },
-      },
-      .depth = {
-                .load_op = LoadOp::Load, 
-                .store_op = StoreOp::DontCare,
-            },
-    };
-
-    const Framebuffer ui_framebuffer{
-      .color = { Framebuffer::AttachmentDescription{ present } },
-      .depth_stencil = { Framebuffer::AttachmentDescription{
-        deferred_mrt.depth_32 } },
-      .debug_name = "Swapchain_UI"
-    };
-
-    buf.cmd_begin_rendering(ui_render_pass, ui_framebuffer, {});
-
-    imgui->begin_frame(ui_framebuffer);
-    ImGui::Begin("Light direction");
-    ImGui::SliderAngle("Light Direction (phi)",
-                       &rad_phi,
-                       0.0F,
-                       360.0F,
-                       "%.1f",
-                       ImGuiSliderFlags_AlwaysClamp);
-    ImGui::SliderAngle("Light Direction (theta)",
-                       &rad_theta,
-                       -180.0F,
-                       180.0F,
-                       "%.1f",
-                       ImGuiSliderFlags_AlwaysClamp);
-    ImGui::End();
-    imgui->end_frame(buf);
-
-    buf.cmd_end_rendering();
-  }
   auto& fd = frame_draws[current_frame % frames_in_flight];
   fd.clear();
 
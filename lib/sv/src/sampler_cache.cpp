@@ -0,0 +1,117 @@
+#include "sv/sampler_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace sv {
+
+auto
+SamplerCache::is_cacheable(const VkSamplerCreateInfo& info) -> bool
+{
+  return info.pNext == nullptr;
+}
+
+auto
+SamplerCache::hash(const VkSamplerCreateInfo& info) -> std::size_t
+{
+  std::size_t h = 0xcbf29ce484222325ULL;
+  const auto mix = [&](std::size_t x) {
+    h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  };
+  mix(static_cast<std::size_t>(info.flags));
+  mix(static_cast<std::size_t>(info.magFilter));
+  mix(static_cast<std::size_t>(info.minFilter));
+  mix(static_cast<std::size_t>(info.mipmapMode));
+  mix(static_cast<std::size_t>(info.addressModeU));
+  mix(static_cast<std::size_t>(info.addressModeV));
+  mix(static_cast<std::size_t>(info.addressModeW));
+  mix(std::bit_cast<std::uint32_t>(info.mipLodBias));
+  mix(static_cast<std::size_t>(info.anisotropyEnable));
+  mix(std::bit_cast<std::uint32_t>(info.maxAnisotropy));
+  mix(static_cast<std::size_t>(info.compareEnable));
+  mix(static_cast<std::size_t>(info.compareOp));
+  mix(std::bit_cast<std::uint32_t>(info.minLod));
+  mix(std::bit_cast<std::uint32_t>(info.maxLod));
+  mix(static_cast<std::size_t>(info.borderColor));
+  mix(static_cast<std::size_t>(info.unnormalizedCoordinates));
+  return h;
+}
+
+auto
+SamplerCache::equal(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b)
+  -> bool
+{
+  return a.flags == b.flags && a.magFilter == b.magFilter &&
+         a.minFilter == b.minFilter && a.mipmapMode == b.mipmapMode &&
+         a.addressModeU == b.addressModeU && a.addressModeV == b.addressModeV &&
+         a.addressModeW == b.addressModeW && a.mipLodBias == b.mipLodBias &&
+         a.anisotropyEnable == b.anisotropyEnable &&
+         a.maxAnisotropy == b.maxAnisotropy &&
+         a.compareEnable == b.compareEnable && a.compareOp == b.compareOp &&
+         a.minLod == b.minLod && a.maxLod == b.maxLod &&
+         a.borderColor == b.borderColor &&
+         a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+auto
+SamplerCache::find(const VkSamplerCreateInfo& info) -> SamplerHandle
+{
+  if (!is_cacheable(info))
+    return {};
+
+  const auto it = buckets.find(hash(info));
+  if (it == buckets.end())
+    return {};
+
+  for (auto& entry : it->second) {
+    if (equal(entry.info, info)) {
+      entry.references++;
+      return entry.handle;
+    }
+  }
+  return {};
+}
+
+auto
+SamplerCache::insert(const VkSamplerCreateInfo& info, SamplerHandle handle)
+  -> void
+{
+  if (!is_cacheable(info) || !handle.valid())
+    return;
+
+  const auto h = hash(info);
+  buckets[h].push_back({ .info = info, .handle = handle, .references = 1 });
+  by_slot[handle.index()] = h;
+}
+
+auto
+SamplerCache::release(SamplerHandle handle) -> bool
+{
+  const auto slot = by_slot.find(handle.index());
+  if (slot == by_slot.end())
+    return true;
+
+  auto& bucket = buckets[slot->second];
+  const auto it = std::ranges::find_if(
+    bucket, [&](const Entry& e) { return e.handle == handle; });
+  if (it == bucket.end())
+    return true;
+
+  if (--it->references > 0)
+    return false;
+
+  bucket.erase(it);
+  if (bucket.empty())
+    buckets.erase(slot->second);
+  by_slot.erase(slot);
+  return true;
+}
+
+auto
+SamplerCache::clear() -> void
+{
+  buckets.clear();
+  by_slot.clear();
+}
+
+}
@@ -6,6 +6,7 @@
 
 #include <glslang/Include/glslang_c_interface.h>
 #include <glslang/Include/glslang_c_shader_types.h>
+#include <format>
 #include <iostream>
 
 namespace sv {
@@ -64,6 +65,69 @@ ShaderParser::destroy_context() -> void
   glslang_finalize_process();
 }
 
+auto
+ShaderParser::select_variant(const ParsedShader& parsed, std::string_view key)
+  -> Expected<std::string, ParseError>
+{
+  std::vector<std::string_view> selected(parsed.variants.size());
+  while (!key.empty()) {
+    const auto comma = std::min(key.find(','), key.size());
+    const auto pair = trim(key.substr(0, comma));
+    key.remove_prefix(std::min(comma + 1, key.size()));
+
+    const auto equals = pair.find('=');
+    if (equals == std::string_view::npos) {
+      return unexpected<ParseError>(ParseError::unknown_variant);
+    }
+    const auto name = trim(pair.substr(0, equals));
+    const auto value = trim(pair.substr(equals + 1));
+
+    const auto declaration = std::ranges::find(
+      parsed.variants, name, &ShaderVariantDeclaration::name);
+    if (declaration == parsed.variants.end() ||
+        std::ranges::find(declaration->values, value) ==
+          declaration->values.end()) {
+      return unexpected<ParseError>(ParseError::unknown_variant);
+    }
+    auto& slot = selected[declaration - parsed.variants.begin()];
+    if (!slot.empty()) {
+      return unexpected<ParseError>(ParseError::unknown_variant);
+    }
+    slot = value;
+  }
+
+  std::string normalised;
+  for (auto i = 0U; i < parsed.variants.size(); ++i) {
+    const auto& declaration = parsed.variants[i];
+    if (i > 0) {
+      normalised += ',';
+    }
+    normalised += std::format(
+      "{}={}",
+      declaration.name,
+      selected[i].empty() ? declaration.values.front() : selected[i]);
+  }
+  return normalised;
+}
+
+auto
+ShaderParser::define_variant(ParsedShader& parsed, std::string_view key) -> void
+{
+  std::string defines;
+  while (!key.empty()) {
+    const auto comma = std::min(key.find(','), key.size());
+    const auto pair = key.substr(0, comma);
+    key.remove_prefix(std::min(comma + 1, key.size()));
+
+    const auto equals = pair.find('=');
+    defines += std::format(
+      "#define {} {}\n", pair.substr(0, equals), pair.substr(equals + 1));
+  }
+  for (auto& entry : parsed.entries) {
+    entry.source_code = defines + entry.source_code;
+  }
+}
+
 auto
 ShaderParser::prepend_preamble(ParsedShader& parsed) -> bool
 {
@@ -2,80 +2,86 @@
 
 #include "sv/expected.hpp"
 #include "sv/scope_exit.hpp"
+#include "sv/shader/include_cache.hpp"
 
 #include <filesystem>
-#include <fstream>
+#include <format>
 #include <glslang/Include/glslang_c_interface.h>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace {
 // Context structure to manage include result lifetimes
 struct IncludeContext
 {
-  std::unordered_map<void*, std::unique_ptr<glsl_include_result_t>> results;
-  std::unordered_map<void*, std::string> header_names;
-  std::unordered_map<void*, std::string> contents;
+  sv::IncludeCache& cache;
+  // The top-level shader file; `"name"` includes in its source resolve here.
+  std::filesystem::path root;
+
+  struct Result
+  {
+    glsl_include_result_t result{};
+    std::string header_name;
+    std::shared_ptr<const sv::IncludeCache::File> file;
+  };
+  std::unordered_map<glsl_include_result_t*, std::unique_ptr<Result>> results;
+  // Every file resolved while compiling, nested includes included.
+  std::vector<std::filesystem::path> includes;
 };
 
 auto
-read_file_to_string(const std::filesystem::path& file_path) -> std::string
+resolve_include(void* ctx,
+                const char* header_name,
+                const char* includer_name,
+                bool system) -> glsl_include_result_t*
 {
-  std::ifstream file(file_path, std::ios::binary);
+  auto* context = static_cast<IncludeContext*>(ctx);
+
+  const std::filesystem::path includer =
+    includer_name && *includer_name ? std::filesystem::path{ includer_name }
+                                    : context->root;
+  auto file = context->cache.resolve(header_name, includer, system);
   if (!file) {
-    return {};
+    return nullptr;
   }
+  context->includes.push_back(file->path);
+
+  // The resolved path becomes the includer of any nested include.
+  auto result = std::make_unique<IncludeContext::Result>();
+  result->header_name = file->path.string();
+  result->file = std::move(file);
+  result->result = {
+    .header_name = result->header_name.c_str(),
+    .header_data = result->file->contents.c_str(),
+    .header_length = result->file->contents.length(),
+  };
 
-  std::ostringstream contents;
-  contents << file.rdbuf();
-  return contents.str();
+  auto* raw = &result->result;
+  context->results[raw] = std::move(result);
+  return raw;
 }
 
 // Callback for system includes: #include <file.glsl>
 auto
-include_system_callback(void* ctx, const char* header_name, const char*, size_t)
-  -> glsl_include_result_t*
+include_system_callback(void* ctx,
+                        const char* header_name,
+                        const char* includer_name,
+                        size_t) -> glsl_include_result_t*
 {
-  auto* context = static_cast<IncludeContext*>(ctx);
-
-  // Resolve system includes from assets/shaders/include/
-  std::filesystem::path include_path = "shaders/include";
-  std::filesystem::path full_path = include_path / header_name;
-
-  std::string content = read_file_to_string(full_path);
-  if (content.empty()) {
-    return nullptr; // File not found or empty
-  }
-
-  auto result = std::make_unique<glsl_include_result_t>();
-  std::string header_name_str(header_name);
-
-  void* result_ptr = result.get();
-  context->header_names[result_ptr] = std::move(header_name_str);
-  context->contents[result_ptr] = std::move(content);
-
-  result->header_name = context->header_names[result_ptr].c_str();
-  result->header_data = context->contents[result_ptr].c_str();
-  result->header_length = context->contents[result_ptr].length();
-
-  glsl_include_result_t* result_raw = result.release();
-  context->results[result_raw] =
-    std::unique_ptr<glsl_include_result_t>(result_raw);
-
-  return result_raw;
+  return resolve_include(ctx, header_name, includer_name, true);
 }
 
+// Callback for local includes: #include "file.glsl"
 auto
 include_local_callback(void* ctx,
                        const char* header_name,
                        const char* includer_name,
-                       size_t include_depth) -> glsl_include_result_t*
+                       size_t) -> glsl_include_result_t*
 {
-  // You could modify this to be relative to the includer_name if needed
-  return include_system_callback(
-    ctx, header_name, includer_name, include_depth);
+  return resolve_include(ctx, header_name, includer_name, false);
 }
 
 // Callback to free include result
@@ -87,24 +93,16 @@ free_include_result_callback(void* ctx, glsl_include_result_t* result)
   }
 
   auto* context = static_cast<IncludeContext*>(ctx);
-
-  // Clean up the stored strings and result
-  context->header_names.erase(result);
-  context->contents.erase(result);
   context->results.erase(result);
-
   return 1; // Success
 }
 
 auto
-compile_shader(glslang_stage_t stage,
-               const std::string& source_code,
-               std::vector<std::uint8_t>& output,
-               const glslang_resource_t* resources)
-  -> sv::Expected<void, std::string>
+make_input(glslang_stage_t stage,
+           const std::string& source_code,
+           const glslang_resource_t* resources,
+           IncludeContext& include_ctx) -> glslang_input_t
 {
-  IncludeContext include_ctx;
-
   // Setup include callbacks
   static glsl_include_callbacks_t include_callbacks = {
     .include_system = include_system_callback,
@@ -112,7 +110,7 @@ compile_shader(glslang_stage_t stage,
     .free_include_result = free_include_result_callback
   };
 
-  const glslang_input_t input = {
+  return {
     .language = GLSLANG_SOURCE_GLSL,
     .stage = stage,
     .client = GLSLANG_CLIENT_VULKAN,
@@ -129,6 +127,56 @@ compile_shader(glslang_stage_t stage,
     .callbacks = include_callbacks,
     .callbacks_ctx = &include_ctx, // Pass our context
   };
+}
+
+// Part of the shader cache key. The target and SPIR-V options set in
+// make_input and compile_shader change the output too; keep them in sync.
+auto
+compiler_identity() -> const std::string&
+{
+  static const std::string identity = [] {
+    glslang_version_t version{};
+    glslang_get_version(&version);
+    return std::format("glslang {}.{}.{}{} vulkan1.4 spv1.6 debug-info",
+                       version.major,
+                       version.minor,
+                       version.patch,
+                       version.flavor ? version.flavor : "");
+  }();
+  return identity;
+}
+
+// The source glslang actually compiles: includes resolved, macros expanded.
+auto
+preprocess_shader(glslang_stage_t stage,
+                  const std::string& source_code,
+                  const glslang_resource_t* resources,
+                  IncludeContext& include_ctx)
+  -> sv::Expected<std::string, std::string>
+{
+  const auto input = make_input(stage, source_code, resources, include_ctx);
+
+  glslang_shader_t* shader = glslang_shader_create(&input);
+  SCOPE_EXIT
+  {
+    glslang_shader_delete(shader);
+  };
+
+  if (!glslang_shader_preprocess(shader, &input)) {
+    return sv::unexpected<std::string>(glslang_shader_get_info_log(shader));
+  }
+  return std::string{ glslang_shader_get_preprocessed_code(shader) };
+}
+
+auto
+compile_shader(glslang_stage_t stage,
+               const std::string& source_code,
+               std::vector<std::uint8_t>& output,
+               const glslang_resource_t* resources,
+               IncludeContext& include_ctx)
+  -> sv::Expected<void, std::string>
+{
+  const auto input = make_input(stage, source_code, resources, include_ctx);
 
   glslang_shader_t* shader = glslang_shader_create(&input);
   SCOPE_EXIT
@@ -0,0 +1,163 @@
+#include "sv/shader/include_cache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace sv {
+
+namespace {
+
+auto
+fnv1a(std::string_view bytes) -> std::uint64_t
+{
+  auto h = 0xcbf29ce484222325ULL;
+  for (const auto c : bytes) {
+    h ^= static_cast<std::uint8_t>(c);
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+}
+
+IncludeCache::IncludeCache(std::filesystem::path directory)
+  : include_directory(std::move(directory))
+{
+}
+
+auto
+IncludeCache::key(const std::filesystem::path& path) -> std::filesystem::path
+{
+  std::error_code ec;
+  auto canonical = std::filesystem::weakly_canonical(path, ec);
+  return ec ? path.lexically_normal() : canonical;
+}
+
+auto
+IncludeCache::load(const std::filesystem::path& path)
+  -> std::shared_ptr<const File>
+{
+  std::error_code ec;
+  const auto modified = std::filesystem::last_write_time(path, ec);
+  if (ec)
+    return nullptr;
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec)
+    return nullptr;
+
+  const auto file_key = key(path);
+  {
+    std::scoped_lock lock{ mutex };
+    if (const auto it = files.find(file_key);
+        it != files.end() && it->second->modified == modified &&
+        it->second->size == size)
+      return it->second;
+  }
+
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream)
+    return nullptr;
+  std::ostringstream contents;
+  contents << stream.rdbuf();
+
+  auto file = std::make_shared<File>(File{
+    .path = file_key,
+    .contents = std::move(contents).str(),
+    .modified = modified,
+    .size = size,
+  });
+  file->hash = fnv1a(file->contents);
+
+  std::scoped_lock lock{ mutex };
+  auto& slot = files[file_key];
+  slot = std::move(file);
+  return slot;
+}
+
+auto
+IncludeCache::resolve(std::string_view name,
+                      const std::filesystem::path& includer,
+                      bool system) -> std::shared_ptr<const File>
+{
+  if (!system && !includer.empty()) {
+    if (auto file = load(includer.parent_path() / name))
+      return file;
+  }
+  return load(include_directory / name);
+}
+
+auto
+IncludeCache::get(const std::filesystem::path& path)
+  -> std::shared_ptr<const File>
+{
+  return load(path);
+}
+
+auto
+IncludeCache::refresh(const std::filesystem::path& path) -> bool
+{
+  const auto file_key = key(path);
+  std::shared_ptr<const File> previous;
+  {
+    std::scoped_lock lock{ mutex };
+    if (const auto it = files.find(file_key); it != files.end())
+      previous = it->second;
+  }
+
+  const auto current = load(file_key);
+  if (!current) {
+    std::scoped_lock lock{ mutex };
+    return files.erase(file_key) > 0;
+  }
+  return !previous || previous->hash != current->hash;
+}
+
+auto
+IncludeCache::clear_dependencies(const std::filesystem::path& shader) -> void
+{
+  const auto shader_key = key(shader);
+  std::scoped_lock lock{ mutex };
+  dependencies.erase(shader_key);
+}
+
+auto
+IncludeCache::dependencies_of(const std::filesystem::path& shader) const
+  -> std::vector<std::filesystem::path>
+{
+  const auto shader_key = key(shader);
+  std::scoped_lock lock{ mutex };
+  const auto it = dependencies.find(shader_key);
+  if (it == dependencies.end())
+    return {};
+  std::vector<std::filesystem::path> files{ it->second.begin(),
+                                            it->second.end() };
+  std::ranges::sort(files);
+  return files;
+}
+
+auto
+IncludeCache::add_dependency(const std::filesystem::path& shader,
+                             const std::filesystem::path& file) -> void
+{
+  auto shader_key = key(shader);
+  auto file_key = key(file);
+  std::scoped_lock lock{ mutex };
+  dependencies[std::move(shader_key)].insert(std::move(file_key));
+}
+
+auto
+IncludeCache::dependents(const std::filesystem::path& file) const
+  -> std::vector<std::filesystem::path>
+{
+  const auto file_key = key(file);
+  std::vector<std::filesystem::path> shaders;
+  std::scoped_lock lock{ mutex };
+  for (const auto& [shader, includes] : dependencies) {
+    if (includes.contains(file_key))
+      shaders.push_back(shader);
+  }
+  return shaders;
+}
+
+}
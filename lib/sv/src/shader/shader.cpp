@@ -1,10 +1,19 @@
 #include "sv/shader/shader.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <expected>
 #include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include "sv/context.hpp"
 #include "sv/scope_exit.hpp"
+#include "sv/shader/include_cache.hpp"
+#include "sv/shader/shader_cache.hpp"
 
 #include "./compilation_impl.inl"
 
@@ -133,6 +142,41 @@ static constexpr glslang_resource_t
 namespace sv {
 
 namespace {
+auto
+reflect_push_constant_size(const std::vector<std::uint8_t>& spirv)
+  -> std::uint32_t
+{
+  SpvReflectShaderModule reflect_module{};
+  if (spvReflectCreateShaderModule(
+        spirv.size(), spirv.data(), &reflect_module) !=
+      SPV_REFLECT_RESULT_SUCCESS) {
+    return 0;
+  }
+  SCOPE_EXIT
+  {
+    spvReflectDestroyShaderModule(&reflect_module);
+  };
+
+  auto count = 0U;
+  if (auto res =
+        spvReflectEnumeratePushConstantBlocks(&reflect_module, &count, nullptr);
+      res != SPV_REFLECT_RESULT_SUCCESS || count == 0) {
+    return 0;
+  }
+
+  std::vector<SpvReflectBlockVariable*> blocks(count);
+  if (spvReflectEnumeratePushConstantBlocks(
+        &reflect_module, &count, blocks.data()) != SPV_REFLECT_RESULT_SUCCESS) {
+    return 0;
+  }
+
+  std::uint32_t size{ 0 };
+  for (const auto* block : blocks) {
+    size = std::max(size, block->size);
+  }
+  return size;
+}
+
 auto
 to_glslang_stage(const ShaderStage stage) -> glslang_stage_t
 {
@@ -159,26 +203,300 @@ to_glslang_stage(const ShaderStage stage) -> glslang_stage_t
 auto
 VulkanShader::create(IContext& context, const std::filesystem::path& path)
   -> Holder<ShaderModuleHandle>
+{
+  auto handles = create_batch(context, std::span{ &path, 1 });
+  return std::move(handles.front());
+}
+
+auto
+VulkanShader::create_batch(IContext& context,
+                           std::span<const std::filesystem::path> paths)
+  -> std::vector<Holder<ShaderModuleHandle>>
+{
+  // Files packed at build time skip GLSL entirely, unless they declare
+  // variants, which are still compiled from the parsed source on demand.
+  // An entry whose source or includes changed since packing is compiled as if
+  // it were not packed.
+  const auto* archive = context.get_shader_archive();
+  std::vector<Expected<ParsedShader, ShaderError>> declared(paths.size());
+  std::vector<Expected<std::vector<CompiledStage>, ShaderError>> compiled(
+    paths.size());
+  std::vector<std::size_t> unpacked;
+  std::vector<std::filesystem::path> unpacked_paths;
+  std::vector<Expected<ParsedShader, ShaderError>> sources;
+  auto& include_cache = context.get_include_cache();
+  for (auto i = 0U; i < paths.size(); ++i) {
+    if (const auto* packed = archive ? archive->find(paths[i]) : nullptr;
+        packed && archive->is_current(*packed, include_cache)) {
+      // Recorded as a compile would, so include edits still hot reload.
+      include_cache.clear_dependencies(paths[i]);
+      for (const auto& include : packed->includes) {
+        include_cache.add_dependency(paths[i], archive->path_of(include.name));
+      }
+      compiled[i] = packed->stages;
+      if (packed->has_variants) {
+        declared[i] = load_source(paths[i]);
+      }
+      continue;
+    }
+
+    const auto& parsed = declared[i] = load_source(paths[i]);
+    sources.push_back(parsed ? prepare_source(*parsed, {})
+                             : unexpected<ShaderError>(parsed.error()));
+    unpacked.push_back(i);
+    unpacked_paths.push_back(paths[i]);
+    include_cache.clear_dependencies(paths[i]);
+  }
+
+  auto results = compile_sources(context, unpacked_paths, sources);
+  for (auto i = 0U; i < unpacked.size(); ++i) {
+    compiled[unpacked[i]] = std::move(results[i]);
+  }
+
+  // Vulkan objects and pool slots are only touched on the owning thread.
+  auto* vulkan_context = dynamic_cast<VulkanContext*>(&context);
+  auto* watcher =
+    vulkan_context ? vulkan_context->get_shader_watcher() : nullptr;
+  std::vector<Holder<ShaderModuleHandle>> handles;
+  handles.reserve(paths.size());
+  for (auto i = 0U; i < paths.size(); ++i) {
+    const auto report = [&](const ShaderError& error) {
+      std::cerr << std::format("File {} - ", paths[i].filename().string())
+                << error.error << "\n";
+      handles.emplace_back();
+    };
+    if (!compiled[i]) {
+      report(compiled[i].error());
+      continue;
+    }
+
+    auto shader = create_modules(context, std::move(*compiled[i]));
+    if (!shader) {
+      report(shader.error());
+      continue;
+    }
+    shader->path = paths[i];
+    if (declared[i] && !declared[i]->variants.empty()) {
+      shader->variant_source =
+        std::make_shared<const ParsedShader>(std::move(*declared[i]));
+    }
+
+    const auto handle =
+      context.get_shader_module_pool().insert(std::move(*shader));
+    if (!handle.valid()) {
+      handles.emplace_back();
+      continue;
+    }
+    if (watcher) {
+      watcher->track(paths[i], handle);
+    }
+    handles.emplace_back(&context, handle);
+  }
+  return handles;
+}
+
+auto
+VulkanShader::get_variant(IContext& context,
+                          ShaderModuleHandle handle,
+                          std::string_view key) -> ShaderModuleHandle
 {
   auto& pool = context.get_shader_module_pool();
-  auto compiled = VulkanShader::compile(context, path);
-  if (!compiled) {
-    std::cerr << std::format("File {} - ", path.filename().string())
-              << compiled.error().error << "\n";
+  const auto* base = pool.get(handle);
+  if (!base) {
+    return {};
+  }
+
+  const auto path = base->path;
+  const auto report = [&](std::string_view error) {
+    std::cerr << std::format(
+      "File {} - variant {}: {}\n", path.filename().string(), key, error);
+  };
+  if (!base->variant_source) {
+    report("no variants declared");
     return {};
   }
+  const auto normalised =
+    ShaderParser::select_variant(*base->variant_source, key);
+  if (!normalised) {
+    report(ShaderUtils::error_to_string(normalised.error()));
+    return {};
+  }
+  if (const auto defaults =
+        ShaderParser::select_variant(*base->variant_source, {});
+      defaults && *normalised == *defaults) {
+    return handle;
+  }
+  if (const auto it = base->variants.find(*normalised);
+      it != base->variants.end()) {
+    return it->second;
+  }
 
-  const auto handle = pool.insert(std::move(compiled.value()));
-  if (!handle.valid()) {
+  const std::array sources{ prepare_source(*base->variant_source,
+                                           *normalised) };
+  auto compiled = compile_sources(context, std::span{ &path, 1 }, sources);
+  if (!compiled.front()) {
+    report(compiled.front().error().error);
     return {};
   }
+  auto shader = create_modules(context, std::move(*compiled.front()));
+  if (!shader) {
+    report(shader.error().error);
+    return {};
+  }
+  shader->path = path;
 
-  return Holder{ &context, handle };
+  // Inserting may move the base shader.
+  const auto variant = pool.insert(std::move(*shader));
+  if (!variant.valid()) {
+    return {};
+  }
+  pool.get(handle)->variants.emplace(*normalised, variant);
+  if (auto* vulkan_context = dynamic_cast<VulkanContext*>(&context);
+      vulkan_context && vulkan_context->get_shader_watcher()) {
+    vulkan_context->get_shader_watcher()->track(path, variant, *normalised);
+  }
+  return variant;
 }
 
 auto
-VulkanShader::compile(IContext& context, const std::filesystem::path& path)
-  -> Expected<VulkanShader, ShaderError>
+VulkanShader::compile_offline(const std::filesystem::path& path,
+                              const std::filesystem::path& root,
+                              ShaderCache& cache,
+                              IncludeCache& include_cache)
+  -> Expected<ShaderArchive::Entry, ShaderError>
+{
+  initialise_glslang();
+
+  const auto declared = load_source(path);
+  if (!declared) {
+    return unexpected<ShaderError>(declared.error());
+  }
+  const auto source = prepare_source(*declared, {});
+  if (!source) {
+    return unexpected<ShaderError>(source.error());
+  }
+
+  const auto relative = [&](const std::filesystem::path& file) {
+    return IncludeCache::key(file)
+      .lexically_relative(IncludeCache::key(root))
+      .generic_string();
+  };
+  const auto file = include_cache.get(path);
+  if (!file) {
+    return unexpected<ShaderError>(ShaderError(
+      ShaderError::Code::file_read_failed,
+      std::format("Failed to read shader file: {}", path.string())));
+  }
+  ShaderArchive::Entry entry{
+    .name = relative(path),
+    .source_hash = file->hash,
+    .has_variants = !declared->variants.empty(),
+  };
+
+  include_cache.clear_dependencies(path);
+  for (const auto& stage : source->entries) {
+    auto compiled = compile_stage(cache, include_cache, path, stage);
+    if (!compiled) {
+      return unexpected<ShaderError>(compiled.error());
+    }
+    entry.stages.push_back(std::move(*compiled));
+  }
+  for (const auto& include : include_cache.dependencies_of(path)) {
+    const auto included = include_cache.get(include);
+    if (!included) {
+      return unexpected<ShaderError>(ShaderError(
+        ShaderError::Code::file_read_failed,
+        std::format("Failed to read include: {}", include.string())));
+    }
+    entry.includes.push_back(
+      { .name = relative(include), .hash = included->hash });
+  }
+  return entry;
+}
+
+auto
+VulkanShader::compile_sources(
+  IContext& context,
+  std::span<const std::filesystem::path> paths,
+  std::span<const Expected<ParsedShader, ShaderError>> sources)
+  -> std::vector<Expected<std::vector<CompiledStage>, ShaderError>>
+{
+  initialise_glslang();
+
+  struct Job
+  {
+    std::size_t shader;
+    const ShaderEntry* entry;
+    std::optional<Expected<CompiledStage, ShaderError>> result{};
+  };
+  std::vector<Job> jobs;
+  for (auto i = 0U; i < sources.size(); ++i) {
+    if (!sources[i]) {
+      continue;
+    }
+    for (const auto& entry : sources[i]->entries) {
+      jobs.push_back({ .shader = i, .entry = &entry });
+    }
+  }
+
+  // glslang is thread-safe once the process is initialised, so every stage of
+  // every file is its own job; the calling thread works through them too.
+  auto& cache = context.get_shader_cache();
+  auto& include_cache = context.get_include_cache();
+  std::atomic<std::size_t> next{ 0 };
+  const auto work = [&] {
+    for (auto j = next++; j < jobs.size(); j = next++) {
+      jobs[j].result = compile_stage(
+        cache, include_cache, paths[jobs[j].shader], *jobs[j].entry);
+    }
+  };
+  {
+    const auto threads = std::min<std::size_t>(
+      jobs.size(), std::max(1U, std::thread::hardware_concurrency()));
+    std::vector<std::jthread> workers;
+    for (auto i = 1U; i < threads; ++i) {
+      workers.emplace_back(work);
+    }
+    work();
+  }
+
+  std::vector<Expected<std::vector<CompiledStage>, ShaderError>> compiled;
+  compiled.reserve(sources.size());
+  auto job = jobs.begin();
+  for (auto i = 0U; i < sources.size(); ++i) {
+    if (!sources[i]) {
+      compiled.push_back(unexpected<ShaderError>(sources[i].error()));
+      continue;
+    }
+
+    std::vector<CompiledStage> stages;
+    std::optional<ShaderError> failed;
+    for (; job != jobs.end() && job->shader == i; ++job) {
+      if (!*job->result) {
+        failed = failed.value_or(job->result->error());
+        continue;
+      }
+      stages.push_back(std::move(**job->result));
+    }
+    if (failed) {
+      compiled.push_back(unexpected<ShaderError>(std::move(*failed)));
+      continue;
+    }
+    compiled.push_back(std::move(stages));
+  }
+  return compiled;
+}
+
+auto
+VulkanShader::initialise_glslang() -> void
+{
+  static std::once_flag once;
+  std::call_once(once, [] { glslang_initialize_process(); });
+}
+
+auto
+VulkanShader::load_source(const std::filesystem::path& path)
+  -> Expected<ParsedShader, ShaderError>
 {
   auto stream = std::ifstream{ path };
   if (!stream) {
@@ -204,36 +522,108 @@ VulkanShader::compile(IContext& context, const std::filesystem::path& path)
                   std::format("Failed to parse shader: {}",
                               ShaderUtils::error_to_string(parsed.error()))));
   }
+  return std::move(*parsed);
+}
+
+auto
+VulkanShader::prepare_source(const ParsedShader& parsed, std::string_view key)
+  -> Expected<ParsedShader, ShaderError>
+{
+  const auto normalised = ShaderParser::select_variant(parsed, key);
+  if (!normalised) {
+    const auto error = ShaderUtils::error_to_string(normalised.error());
+    return unexpected<ShaderError>(ShaderError(
+      ShaderError::Code::parse_failed,
+      std::format("Failed to select variant {}: {}", key, error)));
+  }
 
-  if (!ShaderParser::prepend_preamble(*parsed)) {
+  auto prepared = parsed;
+  ShaderParser::define_variant(prepared, *normalised);
+  if (!ShaderParser::prepend_preamble(prepared)) {
     return unexpected<ShaderError>(ShaderError(
       ShaderError::Code::preamble_failed, "Failed to prepend shader preamble"));
   }
+  return prepared;
+}
+
+auto
+VulkanShader::compile_stage(ShaderCache& cache,
+                            IncludeCache& include_cache,
+                            const std::filesystem::path& path,
+                            const ShaderEntry& entry)
+  -> Expected<CompiledStage, ShaderError>
+{
+  const auto stage = to_glslang_stage(entry.stage);
+  IncludeContext include_ctx{ .cache = include_cache, .root = path };
+  const auto preprocessed = preprocess_shader(
+    stage, entry.source_code, &default_resource, include_ctx);
+  // Recorded even on failure so fixing the include recompiles this shader.
+  for (const auto& file : include_ctx.includes) {
+    include_cache.add_dependency(path, file);
+  }
+  if (!preprocessed) {
+    return unexpected<ShaderError>(
+      ShaderError(ShaderError::Code::compilation_failed,
+                  std::format("Compilation failed for stage {}: {}",
+                              to_string(entry.stage),
+                              preprocessed.error())));
+  }
+
+  CompiledStage compiled{
+    .stage = entry.stage,
+    .entry_name = entry.entry_name.empty() ? "main" : entry.entry_name,
+  };
 
+  const auto key =
+    ShaderCache::make_key(*preprocessed, entry.stage, compiler_identity());
+  auto start = std::chrono::steady_clock::now();
+  if (auto cached = cache.load(key)) {
+    cache.record_load(std::chrono::steady_clock::now() - start);
+    compiled.spirv = std::move(cached->spirv);
+    compiled.push_constant_size = cached->push_constant_size;
+    return compiled;
+  }
+
+  start = std::chrono::steady_clock::now();
+  auto result = compile_shader(
+    stage, entry.source_code, compiled.spirv, &default_resource, include_ctx);
+  if (!result) {
+    return unexpected<ShaderError>(
+      ShaderError(ShaderError::Code::compilation_failed,
+                  std::format("Compilation failed for stage {}: {}",
+                              to_string(entry.stage),
+                              result.error())));
+  }
+  compiled.push_constant_size = reflect_push_constant_size(compiled.spirv);
+  cache.record_compile(std::chrono::steady_clock::now() - start);
+  cache.store(key,
+              {
+                .spirv = compiled.spirv,
+                .push_constant_size = compiled.push_constant_size,
+              });
+  return compiled;
+}
+
+auto
+VulkanShader::create_modules(IContext& context,
+                             std::vector<CompiledStage>&& stages)
+  -> Expected<VulkanShader, ShaderError>
+{
   std::vector<VulkanShader::StageModule> modules;
   PushConstantInfo push_constant_info{};
 
-  for (const auto& entry : parsed->entries) {
-    std::vector<std::uint8_t> spirv;
-    auto result = compile_shader(to_glslang_stage(entry.stage),
-                                 entry.source_code,
-                                 spirv,
-                                 &default_resource);
-
-    if (!result) {
-      return unexpected<ShaderError>(
-        ShaderError(ShaderError::Code::compilation_failed,
-                    std::format("Compilation failed for stage {}: {}",
-                                to_string(entry.stage),
-                                result.error())));
-    }
+  auto* vulkan_context = dynamic_cast<VulkanContext*>(&context);
+  const bool keep_spirv =
+    vulkan_context != nullptr && vulkan_context->uses_shader_objects();
 
+  std::uint32_t total_stages{};
+  for (auto& compiled : stages) {
     const VkShaderModuleCreateInfo create_info{
       .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
       .pNext = nullptr,
       .flags = 0,
-      .codeSize = spirv.size(),
-      .pCode = reinterpret_cast<const std::uint32_t*>(spirv.data()),
+      .codeSize = compiled.spirv.size(),
+      .pCode = reinterpret_cast<const std::uint32_t*>(compiled.spirv.data()),
     };
 
     VkShaderModule module;
@@ -242,52 +632,36 @@ VulkanShader::compile(IContext& context, const std::filesystem::path& path)
       return unexpected<ShaderError>(
         ShaderError(ShaderError::Code::module_creation_failed,
                     std::format("vkCreateShaderModule failed for stage {}",
-                                to_string(entry.stage))));
+                                to_string(compiled.stage))));
     }
 
-    // Reflection handling
-    SpvReflectShaderModule reflect_module{};
-    if (spvReflectCreateShaderModule(
-          spirv.size(), spirv.data(), &reflect_module) ==
-        SPV_REFLECT_RESULT_SUCCESS) {
-
-      auto count = 0U;
-      if (auto res = spvReflectEnumeratePushConstantBlocks(
-            &reflect_module, &count, nullptr);
-          res == SPV_REFLECT_RESULT_SUCCESS && count > 0) {
-
-        std::vector<SpvReflectBlockVariable*> blocks(count);
-        res = spvReflectEnumeratePushConstantBlocks(
-          &reflect_module, &count, blocks.data());
-
-        if (res == SPV_REFLECT_RESULT_SUCCESS) {
-          for (auto* block : blocks) {
-            if (block->size > push_constant_info.size) {
-              push_constant_info.size = block->size;
-            }
-            push_constant_info.stages |= to_vk_stage(entry.stage);
-          }
-        }
-      }
-      spvReflectDestroyShaderModule(&reflect_module);
+    if (compiled.push_constant_size > 0) {
+      push_constant_info.size =
+        std::max<std::size_t>(push_constant_info.size,
+                              compiled.push_constant_size);
     }
+    total_stages |= to_vk_stage(compiled.stage);
 
-    modules.emplace_back(entry.stage,
-                         entry.entry_name.empty() ? "main" : entry.entry_name,
-                         module);
-  }
-
-  std::uint32_t total_stages{};
-  for (const auto& stage :
-       parsed->entries |
-         std::views::transform([](const auto& e) { return e.stage; })) {
-    total_stages |= to_vk_stage(stage);
+    const bool graphics = compiled.stage != ShaderStage::compute;
+    modules.emplace_back(compiled.stage,
+                         std::move(compiled.entry_name),
+                         module,
+                         keep_spirv && graphics
+                           ? std::move(compiled.spirv)
+                           : std::vector<std::uint8_t>{});
   }
 
   auto flags = static_cast<VkShaderStageFlagBits>(total_stages);
   push_constant_info.stages = flags;
 
-  return VulkanShader(context, std::move(modules), push_constant_info, flags);
+  VulkanShader shader(context, std::move(modules), push_constant_info, flags);
+  if (keep_spirv && !vulkan_context->create_shader_objects(shader)) {
+    return unexpected<ShaderError>(
+      ShaderError(ShaderError::Code::module_creation_failed,
+                  "vkCreateShadersEXT failed"));
+  }
+
+  return shader;
 }
 
 VulkanShader::VulkanShader(IContext& ctx,
@@ -299,11 +673,5 @@ VulkanShader::VulkanShader(IContext& ctx,
   , modules(std::move(mods))
   , flags(flag_bits)
 {
-
-  static bool glslang_is_initialised = false;
-  if (!glslang_is_initialised) {
-    glslang_initialize_process();
-    glslang_is_initialised = true;
-  }
 }
 }
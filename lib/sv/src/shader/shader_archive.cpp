@@ -0,0 +1,189 @@
+#include "sv/shader/shader_archive.hpp"
+
+#include "sv/shader/include_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace sv {
+
+namespace {
+
+constexpr std::array<char, 4> magic{ 'S', 'V', 'S', 'A' };
+constexpr std::uint32_t format_version = 2;
+
+// Counts and sizes are u32, hashes u64; strings and blobs are
+// length-prefixed.
+struct Writer
+{
+  std::ofstream& file;
+
+  auto u32(std::uint32_t value) -> void
+  {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  auto u64(std::uint64_t value) -> void
+  {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  auto bytes(const void* data, std::size_t size) -> void
+  {
+    u32(static_cast<std::uint32_t>(size));
+    file.write(static_cast<const char*>(data),
+               static_cast<std::streamsize>(size));
+  }
+};
+
+struct Reader
+{
+  std::ifstream& file;
+
+  auto u32() -> std::optional<std::uint32_t>
+  {
+    std::uint32_t value{};
+    if (!file.read(reinterpret_cast<char*>(&value), sizeof(value)))
+      return std::nullopt;
+    return value;
+  }
+  auto u64() -> std::optional<std::uint64_t>
+  {
+    std::uint64_t value{};
+    if (!file.read(reinterpret_cast<char*>(&value), sizeof(value)))
+      return std::nullopt;
+    return value;
+  }
+  template<typename T>
+  auto bytes(T& out) -> bool
+  {
+    const auto size = u32();
+    if (!size)
+      return false;
+    out.resize(*size);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()),
+                                       static_cast<std::streamsize>(*size)));
+  }
+};
+
+}
+
+ShaderArchive::ShaderArchive(std::filesystem::path directory)
+  : root(std::move(directory))
+{
+}
+
+auto
+ShaderArchive::read(const std::filesystem::path& file)
+  -> std::optional<ShaderArchive>
+{
+  std::ifstream stream(file, std::ios::binary);
+  if (!stream)
+    return std::nullopt;
+
+  std::array<char, 4> header{};
+  Reader in{ stream };
+  if (!stream.read(header.data(), header.size()) || header != magic ||
+      in.u32() != format_version)
+    return std::nullopt;
+
+  const auto count = in.u32();
+  if (!count)
+    return std::nullopt;
+
+  ShaderArchive archive{ file.parent_path() };
+  archive.entries.resize(*count);
+  for (auto& entry : archive.entries) {
+    const auto flags = in.u32();
+    const auto stages = in.u32();
+    const auto source_hash = in.u64();
+    const auto includes = in.u32();
+    if (!in.bytes(entry.name) || !flags || !stages || !source_hash ||
+        !includes)
+      return std::nullopt;
+    entry.has_variants = (*flags & 1U) != 0;
+    entry.source_hash = *source_hash;
+
+    entry.includes.resize(*includes);
+    for (auto& include : entry.includes) {
+      const auto hash = in.u64();
+      if (!hash || !in.bytes(include.name))
+        return std::nullopt;
+      include.hash = *hash;
+    }
+
+    entry.stages.resize(*stages);
+    for (auto& stage : entry.stages) {
+      const auto kind = in.u32();
+      const auto push_constant_size = in.u32();
+      if (!kind || *kind > static_cast<std::uint32_t>(ShaderStage::mesh) ||
+          !push_constant_size || !in.bytes(stage.entry_name) ||
+          !in.bytes(stage.spirv) ||
+          stage.spirv.size() % sizeof(std::uint32_t) != 0)
+        return std::nullopt;
+      stage.stage = static_cast<ShaderStage>(*kind);
+      stage.push_constant_size = *push_constant_size;
+    }
+  }
+  return archive;
+}
+
+auto
+ShaderArchive::write(const std::filesystem::path& file) const -> bool
+{
+  std::error_code ec;
+  if (file.has_parent_path())
+    std::filesystem::create_directories(file.parent_path(), ec);
+
+  std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+  if (!stream)
+    return false;
+
+  Writer out{ stream };
+  stream.write(magic.data(), magic.size());
+  out.u32(format_version);
+  out.u32(static_cast<std::uint32_t>(entries.size()));
+  for (const auto& entry : entries) {
+    out.u32(entry.has_variants ? 1U : 0U);
+    out.u32(static_cast<std::uint32_t>(entry.stages.size()));
+    out.u64(entry.source_hash);
+    out.u32(static_cast<std::uint32_t>(entry.includes.size()));
+    out.bytes(entry.name.data(), entry.name.size());
+    for (const auto& include : entry.includes) {
+      out.u64(include.hash);
+      out.bytes(include.name.data(), include.name.size());
+    }
+    for (const auto& stage : entry.stages) {
+      out.u32(static_cast<std::uint32_t>(stage.stage));
+      out.u32(stage.push_constant_size);
+      out.bytes(stage.entry_name.data(), stage.entry_name.size());
+      out.bytes(stage.spirv.data(), stage.spirv.size());
+    }
+  }
+  return static_cast<bool>(stream);
+}
+
+auto
+ShaderArchive::find(const std::filesystem::path& path) const -> const Entry*
+{
+  const auto name = path.lexically_normal()
+                      .lexically_relative(root.lexically_normal())
+                      .generic_string();
+  const auto it = std::ranges::find(entries, name, &Entry::name);
+  return it == entries.end() ? nullptr : &*it;
+}
+
+auto
+ShaderArchive::is_current(const Entry& entry,
+                          IncludeCache& include_cache) const -> bool
+{
+  const auto matches = [&](std::string_view name, std::uint64_t hash) {
+    const auto file = include_cache.get(path_of(name));
+    return file && file->hash == hash;
+  };
+  return matches(entry.name, entry.source_hash) &&
+         std::ranges::all_of(entry.includes, [&](const Include& include) {
+           return matches(include.name, include.hash);
+         });
+}
+
+}
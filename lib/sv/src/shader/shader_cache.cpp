@@ -0,0 +1,134 @@
+#include "sv/shader/shader_cache.hpp"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace sv {
+
+namespace {
+
+constexpr std::array<char, 4> magic{ 'S', 'V', 'S', 'C' };
+constexpr std::uint32_t format_version = 1;
+
+struct Header
+{
+  std::array<char, 4> magic{};
+  std::uint32_t version{ 0 };
+  std::uint64_t key{ 0 };
+  std::uint32_t push_constant_size{ 0 };
+  std::uint32_t spirv_size{ 0 };
+};
+
+auto
+fnv1a(std::uint64_t h, std::string_view bytes) -> std::uint64_t
+{
+  for (const auto c : bytes) {
+    h ^= static_cast<std::uint8_t>(c);
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+}
+
+ShaderCache::ShaderCache(std::filesystem::path dir)
+  : directory(std::move(dir))
+{
+}
+
+auto
+ShaderCache::make_key(std::string_view preprocessed_source,
+                      ShaderStage stage,
+                      std::string_view compiler) -> std::uint64_t
+{
+  // Length-prefix each part so no two splits of the same bytes collide.
+  const auto stage_name = to_string(stage);
+  auto h = 0xcbf29ce484222325ULL;
+  for (const std::string_view part :
+       { preprocessed_source, std::string_view{ stage_name }, compiler }) {
+    const auto size = part.size();
+    h = fnv1a(h, { reinterpret_cast<const char*>(&size), sizeof(size) });
+    h = fnv1a(h, part);
+  }
+  return h;
+}
+
+auto
+ShaderCache::path_for(std::uint64_t key) const -> std::filesystem::path
+{
+  return directory / std::format("{:016x}.spv", key);
+}
+
+auto
+ShaderCache::load(std::uint64_t key) -> std::optional<Stage>
+{
+  if (directory.empty())
+    return std::nullopt;
+
+  std::ifstream file(path_for(key), std::ios::binary);
+  if (!file)
+    return std::nullopt;
+
+  Header header{};
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      header.magic != magic || header.version != format_version ||
+      header.key != key || header.spirv_size == 0 ||
+      header.spirv_size % sizeof(std::uint32_t) != 0)
+    return std::nullopt;
+
+  Stage stage{
+    .spirv = std::vector<std::uint8_t>(header.spirv_size),
+    .push_constant_size = header.push_constant_size,
+  };
+  if (!file.read(reinterpret_cast<char*>(stage.spirv.data()),
+                 static_cast<std::streamsize>(stage.spirv.size())))
+    return std::nullopt;
+  return stage;
+}
+
+auto
+ShaderCache::store(std::uint64_t key, const Stage& stage) -> bool
+{
+  if (directory.empty() || stage.spirv.empty())
+    return false;
+
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+
+  const auto path = path_for(key);
+  // Two threads may compile the same stage; each writes its own file and the
+  // last rename wins with identical contents.
+  auto temporary = path;
+  temporary += std::format(
+    ".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  {
+    const Header header{
+      .magic = magic,
+      .version = format_version,
+      .key = key,
+      .push_constant_size = stage.push_constant_size,
+      .spirv_size = static_cast<std::uint32_t>(stage.spirv.size()),
+    };
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ||
+        !file.write(reinterpret_cast<const char*>(stage.spirv.data()),
+                    static_cast<std::streamsize>(stage.spirv.size())))
+      return false;
+  }
+
+  std::filesystem::rename(temporary, path, ec);
+  if (ec) {
+    std::cerr << std::format(
+      "Could not write shader cache {}: {}\n", path.string(), ec.message());
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+  return true;
+}
+
+}
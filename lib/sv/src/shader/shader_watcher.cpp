@@ -0,0 +1,252 @@
+#include "sv/shader/shader_watcher.hpp"
+
+#include "sv/context.hpp"
+#include "sv/scope_exit.hpp"
+#include "sv/shader/include_cache.hpp"
+#include "sv/shader/shader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <iostream>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace sv {
+
+#if defined(__linux__)
+namespace {
+// Editors save through temporary and swap files next to the real one; only
+// shader sources and includes are worth reading.
+auto
+is_shader_source(const std::filesystem::path& path) -> bool
+{
+  const auto extension = path.extension();
+  return extension == ".glsl" || extension == ".shader";
+}
+}
+#endif
+
+struct ShaderWatcher::Reload
+{
+  std::filesystem::path path;
+  std::shared_ptr<const ParsedShader> variant_source;
+  std::unordered_map<std::string, std::vector<VulkanShader::CompiledStage>>
+    variants;
+};
+
+ShaderWatcher::ShaderWatcher(VulkanContext& ctx, std::filesystem::path dir)
+  : context(ctx)
+  , directory(std::move(dir))
+{
+#if defined(__linux__)
+  thread = std::jthread{ [this](std::stop_token stop) { watch(stop); } };
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher() = default;
+
+auto
+ShaderWatcher::track(const std::filesystem::path& path,
+                     ShaderModuleHandle handle,
+                     std::string variant) -> void
+{
+  auto key = IncludeCache::key(path);
+  std::scoped_lock lock{ mutex };
+  tracked[std::move(key)].push_back({ handle, std::move(variant) });
+}
+
+auto
+ShaderWatcher::untrack(ShaderModuleHandle handle) -> void
+{
+  std::scoped_lock lock{ mutex };
+  for (auto& [path, shaders] : tracked) {
+    std::erase_if(shaders, [handle](const Tracked& shader) {
+      return shader.handle == handle;
+    });
+  }
+}
+
+auto
+ShaderWatcher::apply() -> void
+{
+  std::vector<Reload> reloads;
+  {
+    std::scoped_lock lock{ mutex };
+    reloads.swap(ready);
+  }
+
+  for (auto& reload : reloads) {
+    std::vector<Tracked> shaders;
+    {
+      std::scoped_lock lock{ mutex };
+      if (const auto it = tracked.find(reload.path); it != tracked.end()) {
+        shaders = it->second;
+      }
+    }
+
+    const auto name = reload.path.filename().string();
+    for (auto& [handle, variant] : shaders) {
+      const auto compiled = reload.variants.find(variant);
+      if (compiled == reload.variants.end()) {
+        continue;
+      }
+      auto stages = compiled->second;
+      auto shader = VulkanShader::create_modules(context, std::move(stages));
+      if (!shader) {
+        std::cerr << std::format("File {} - ", name) << shader.error().error
+                  << "\n";
+        continue;
+      }
+      shader->path = reload.path;
+      if (variant.empty()) {
+        shader->variant_source = reload.variant_source;
+      }
+      // Replacing destroys the old modules, which untracks the handle.
+      if (context.replace_shader(handle, std::move(*shader))) {
+        track(reload.path, handle, std::move(variant));
+      }
+    }
+  }
+}
+
+auto
+ShaderWatcher::reload(const std::filesystem::path& shader) -> void
+{
+  std::vector<std::string> variants;
+  {
+    std::scoped_lock lock{ mutex };
+    const auto it = tracked.find(shader);
+    if (it == tracked.end()) {
+      return;
+    }
+    for (const auto& tracked_shader : it->second) {
+      if (std::ranges::find(variants, tracked_shader.variant) ==
+          variants.end()) {
+        variants.push_back(tracked_shader.variant);
+      }
+    }
+  }
+
+  const auto report = [&shader](const ShaderError& error) {
+    std::cerr << std::format("File {} - ", shader.filename().string())
+              << error.error << "\n";
+  };
+
+  auto declared = VulkanShader::load_source(shader);
+  if (!declared) {
+    report(declared.error());
+    return;
+  }
+  context.get_include_cache().clear_dependencies(shader);
+
+  std::vector<Expected<ParsedShader, ShaderError>> sources;
+  for (const auto& variant : variants) {
+    sources.push_back(VulkanShader::prepare_source(*declared, variant));
+  }
+  const std::vector paths(variants.size(), shader);
+  auto compiled = VulkanShader::compile_sources(context, paths, sources);
+
+  Reload reload{ .path = shader };
+  if (!declared->variants.empty()) {
+    reload.variant_source =
+      std::make_shared<const ParsedShader>(std::move(*declared));
+  }
+  for (auto i = 0U; i < variants.size(); ++i) {
+    if (!compiled[i]) {
+      report(compiled[i].error());
+      continue;
+    }
+    reload.variants.emplace(variants[i], std::move(*compiled[i]));
+  }
+
+  std::scoped_lock lock{ mutex };
+  ready.push_back(std::move(reload));
+}
+
+auto
+ShaderWatcher::watch(std::stop_token stop) -> void
+{
+#if defined(__linux__)
+  const auto fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << "Shader hot reload disabled: inotify_init1 failed\n";
+    return;
+  }
+  SCOPE_EXIT
+  {
+    close(fd);
+  };
+
+  // inotify is not recursive; directories created later are not watched.
+  std::unordered_map<int, std::filesystem::path> directories;
+  const auto add_watch = [&](const std::filesystem::path& path) {
+    const auto wd =
+      inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd >= 0) {
+      directories.emplace(wd, path);
+    }
+  };
+  add_watch(directory);
+  std::error_code ec;
+  for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+       !ec && it != std::filesystem::recursive_directory_iterator{};
+       it.increment(ec)) {
+    if (it->is_directory(ec)) {
+      add_watch(it->path());
+    }
+  }
+
+  VulkanShader::initialise_glslang();
+  alignas(inotify_event) std::array<char, 4096> buffer{};
+  while (!stop.stop_requested()) {
+    pollfd descriptor{ .fd = fd, .events = POLLIN, .revents = 0 };
+    if (poll(&descriptor, 1, 100) <= 0) {
+      continue;
+    }
+
+    std::vector<std::filesystem::path> changed;
+    for (auto length = read(fd, buffer.data(), buffer.size()); length > 0;
+         length = read(fd, buffer.data(), buffer.size())) {
+      for (auto offset = 0L; offset < length;) {
+        const auto* event =
+          reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+        offset += static_cast<long>(sizeof(inotify_event) + event->len);
+        if (const auto it = directories.find(event->wd);
+            event->len > 0 && it != directories.end() &&
+            is_shader_source(event->name)) {
+          changed.push_back(it->second / event->name);
+        }
+      }
+    }
+
+    // Editors often write a file several times per save; the hash check in
+    // refresh() drops the writes that did not change anything.
+    auto& includes = context.get_include_cache();
+    std::vector<std::filesystem::path> shaders;
+    for (const auto& file : changed) {
+      if (!includes.refresh(file)) {
+        continue;
+      }
+      auto affected = includes.dependents(file);
+      affected.push_back(IncludeCache::key(file));
+      for (auto& shader : affected) {
+        if (std::ranges::find(shaders, shader) == shaders.end()) {
+          shaders.push_back(std::move(shader));
+        }
+      }
+    }
+    for (const auto& shader : shaders) {
+      reload(shader);
+    }
+  }
+#else
+  (void)stop;
+#endif
+}
+
+}
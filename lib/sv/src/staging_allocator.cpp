@@ -117,6 +117,16 @@ struct StageAccess
   VkAccessFlags2 access;
 };
 
+// Uploads end with a barrier to every stage, so the next use of the image
+// only waits for a layout change.
+constexpr ImageState uploaded_state{
+  .layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+  .stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+  .write_access = VK_ACCESS_2_NONE,
+  .visible_stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+  .visible_access = VK_ACCESS_2_MEMORY_READ_BIT,
+};
+
 void
 imageMemoryBarrier2(VkCommandBuffer buffer,
                     VkImage image,
@@ -495,6 +505,8 @@ StagingAllocator::generate_mipmaps(VulkanTextureND& texture,
 
     vkCmdPipelineBarrier2(wrapper.command_buffer, &dependency_info);
   }
+  texture.states.set(
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, mip_levels, 0, layers }, uploaded_state);
 
   // Submit command buffer and wait
   context.immediate_commands->wait(context.immediate_commands->submit(wrapper));
@@ -540,8 +552,7 @@ StagingAllocator::upload_blob_with_regions(
     image.image,
     { VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, VK_ACCESS_2_NONE },
     { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT },
-    image.image_layout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_IMAGE_LAYOUT_UNDEFINED
-                                                    : image.image_layout,
+    image.states.get(0, 0).layout,
     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
     range);
 
@@ -561,8 +572,7 @@ StagingAllocator::upload_blob_with_regions(
     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
     range);
-
-  // image.set_layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  image.states.set(range, uploaded_state);
 
   desc.handle = context.immediate_commands->submit(w);
   this->regions.push_back(desc);
@@ -699,7 +709,8 @@ StagingAllocator::upload(VulkanTextureND& image,
                      .access = VK_ACCESS_2_NONE },
         StageAccess{ .stage = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
                      .access = VK_ACCESS_2_TRANSFER_WRITE_BIT },
-        covers_full_image ? VK_IMAGE_LAYOUT_UNDEFINED : image.image_layout,
+        covers_full_image ? VK_IMAGE_LAYOUT_UNDEFINED
+                          : image.states.get(currentMipLevel, layer + l).layout,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         VkImageSubresourceRange{
           imageAspect,
@@ -781,7 +792,9 @@ StagingAllocator::upload(VulkanTextureND& image,
     }
   }
 
-  //  image.set_layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  image.states.set(
+    { imageAspect, base_mip_level, mip_level_count, layer, num_layers },
+    uploaded_state);
 
   desc.handle = context.immediate_commands->submit(wrapper);
   regions.push_back(desc);
@@ -846,8 +859,8 @@ StagingAllocator::upload(VulkanTextureND& image,
     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
     VkImageSubresourceRange{
       aspect, 0, image.level_count, 0, image.layer_count });
-
-  // image.set_layout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  image.states.set({ aspect, 0, image.level_count, 0, image.layer_count },
+                   uploaded_state);
 
   desc.handle = context.immediate_commands->submit(wrapper);
   regions.push_back(desc);
@@ -891,7 +904,8 @@ StagingAllocator::ensure_size(std::uint32_t size_needed)
 
   staging_buffer_size = size_needed;
 
-  auto name = std::format("Staging Buffer {}", staging_buffer_count++);
+  const auto name =
+    format_debug_name(context, "Staging Buffer {}", staging_buffer_count++);
 
   staging_buffer = VulkanDeviceBuffer::create(
     context,
@@ -899,7 +913,7 @@ StagingAllocator::ensure_size(std::uint32_t size_needed)
       .usage = BufferUsageBits::Destination | BufferUsageBits::Source,
       .storage = StorageType::Device,
       .size = staging_buffer_size,
-      .debug_name = "Staging buffer",
+      .debug_name = name,
     });
 
   assert(!staging_buffer.empty());
@@ -210,20 +210,33 @@ auto
 VulkanTextureND::create(IContext& ctx, const VkSamplerCreateInfo& info)
   -> Holder<SamplerHandle>
 {
-  VkSampler smp;
   VkSamplerCreateInfo copy{ info };
   copy.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+
+  auto& cache = ctx.get_sampler_cache();
+  if (const auto cached = cache.find(copy); cached.valid())
+    return Holder{ &ctx, cached };
+
+  VkSampler smp;
   vkCreateSampler(ctx.get_device(), &copy, nullptr, &smp);
 
-  return Holder{ &ctx, ctx.get_sampler_pool().insert(std::move(smp)) };
+  const auto handle = ctx.get_sampler_pool().insert(std::move(smp));
+  cache.insert(copy, handle);
+  ctx.update_resources(handle);
+  return Holder{ &ctx, handle };
 }
 
-auto
-VulkanTextureND::build(IContext& ctx, const TextureDescription& desc)
-  -> VulkanTextureND
+namespace {
+
+struct ImageCreation
 {
-  assert(!desc.debug_name.empty());
+  VkImageCreateInfo info;
+  VkImageViewType view_type;
+};
 
+auto
+image_creation(const TextureDescription& desc) -> ImageCreation
+{
   VkImageUsageFlags usage_flags =
     (desc.storage & StorageType::Device) != StorageType{ 0 }
       ? VK_IMAGE_USAGE_TRANSFER_DST_BIT
@@ -243,12 +256,6 @@ VulkanTextureND::build(IContext& ctx, const TextureDescription& desc)
   if (desc.storage != StorageType::Transient)
     usage_flags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-  const VkMemoryPropertyFlags memory_flags =
-    storage_type_to_vk_memory_property_flags(desc.storage);
-
-  const auto image_debug_name = std::format("Image::{}", desc.debug_name);
-  const auto view_debug_name = std::format("ImageView::{}", desc.debug_name);
-
   VkImageCreateFlags create_flags = 0;
   VkImageViewType image_view_type{ VK_IMAGE_VIEW_TYPE_2D };
   VkImageType image_type{ VK_IMAGE_TYPE_2D };
@@ -273,41 +280,81 @@ VulkanTextureND::build(IContext& ctx, const TextureDescription& desc)
       break;
   }
 
-  const VkExtent3D extent{ desc.dimensions.width,
-                           desc.dimensions.height,
-                           desc.dimensions.depth };
-  const auto level_count = desc.mip_count;
-  const auto vulkan_format = format_to_vk_format(desc.format);
+  return {
+    .info = {
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = create_flags,
+      .imageType = image_type,
+      .format = format_to_vk_format(desc.format),
+      .extent = { desc.dimensions.width,
+                  desc.dimensions.height,
+                  desc.dimensions.depth },
+      .mipLevels = desc.mip_count,
+      .arrayLayers = layer_count,
+      .samples = sample_count,
+      .tiling = static_cast<VkImageTiling>(desc.tiling),
+      .usage = usage_flags,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices = nullptr,
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    },
+    .view_type = image_view_type,
+  };
+}
+
+}
+
+auto
+VulkanTextureND::memory_requirements(IContext& ctx,
+                                     const TextureDescription& desc)
+  -> VkMemoryRequirements
+{
+  const auto creation = image_creation(desc);
+  const VkDeviceImageMemoryRequirements info{
+    .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+    .pNext = nullptr,
+    .pCreateInfo = &creation.info,
+    .planeAspect = VK_IMAGE_ASPECT_NONE,
+  };
+  VkMemoryRequirements2 requirements{
+    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+    .pNext = nullptr,
+    .memoryRequirements = {},
+  };
+  vkGetDeviceImageMemoryRequirements(ctx.get_device(), &info, &requirements);
+  return requirements.memoryRequirements;
+}
+
+auto
+VulkanTextureND::build(IContext& ctx, const TextureDescription& desc)
+  -> VulkanTextureND
+{
+  assert(!desc.debug_name.empty());
+
+  const auto [ci, image_view_type] = image_creation(desc);
+  const auto vulkan_format = ci.format;
+  const auto layer_count = ci.arrayLayers;
+
+  const VkMemoryPropertyFlags memory_flags =
+    storage_type_to_vk_memory_property_flags(desc.storage);
+
+  const auto view_debug_name =
+    format_debug_name(ctx, "ImageView::{}", desc.debug_name);
 
   VulkanTextureND image{
-    .usage_flags = usage_flags,
-    .extent = extent,
-    .type = image_type,
+    .usage_flags = ci.usage,
+    .extent = ci.extent,
+    .type = ci.imageType,
     .format = vulkan_format,
-    .samples = sample_count,
-    .level_count = level_count,
+    .samples = ci.samples,
+    .level_count = ci.mipLevels,
     .layer_count = layer_count,
     .is_depth_format = format_is_depth(vulkan_format),
     .is_stencil_format = format_is_stencil(vulkan_format),
-    .debug_name = std::string{ desc.debug_name },
-  };
-
-  const VkImageCreateInfo ci = {
-    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-    .pNext = nullptr,
-    .flags = create_flags,
-    .imageType = image_type,
-    .format = vulkan_format,
-    .extent = extent,
-    .mipLevels = level_count,
-    .arrayLayers = layer_count,
-    .samples = sample_count,
-    .tiling = static_cast<VkImageTiling>(desc.tiling),
-    .usage = usage_flags,
-    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    .queueFamilyIndexCount = 0,
-    .pQueueFamilyIndices = nullptr,
-    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    .debug_name = format_debug_name(ctx, "{}", desc.debug_name),
+    .states = ImageStates{ ci.mipLevels, layer_count },
   };
 
   VmaAllocationCreateInfo alloc_info = {};
@@ -319,15 +366,23 @@ VulkanTextureND::build(IContext& ctx, const TextureDescription& desc)
                        : VmaAllocationCreateFlags{ 0 };
   alloc_info.priority = 1.0F;
 
-  vmaCreateImage(DeviceAllocator::the(),
-                 &ci,
-                 &alloc_info,
-                 &image.image,
-                 &image.allocation,
-                 &image.allocation_info);
+  if (desc.aliased_memory.allocation) {
+    vmaCreateAliasingImage2(DeviceAllocator::the(),
+                            desc.aliased_memory.allocation,
+                            desc.aliased_memory.offset,
+                            &ci,
+                            &image.image);
+  } else {
+    vmaCreateImage(DeviceAllocator::the(),
+                   &ci,
+                   &alloc_info,
+                   &image.image,
+                   &image.allocation,
+                   &image.allocation_info);
+  }
 
   set_name(
-    ctx, image.image, VK_OBJECT_TYPE_IMAGE, "{}_Image", image_debug_name);
+    ctx, image.image, VK_OBJECT_TYPE_IMAGE, "Image::{}_Image", desc.debug_name);
   vkGetPhysicalDeviceFormatProperties(
     ctx.get_physical_device(), image.format, &image.format_properties);
 
@@ -383,13 +438,15 @@ VulkanTextureND::create(IContext& ctx, const TextureDescription& desc)
   TextureHandle handle = ctx.get_texture_pool().insert(std::move(image));
 
   auto* image_ptr = ctx.get_texture_pool().get(handle);
-  set_name(ctx,
-           image_ptr->allocation_info.deviceMemory,
-           VK_OBJECT_TYPE_DEVICE_MEMORY,
-           "DeviceMemory::Image::{}",
-           desc.debug_name);
+  if (image_ptr->allocation) {
+    set_name(ctx,
+             image_ptr->allocation_info.deviceMemory,
+             VK_OBJECT_TYPE_DEVICE_MEMORY,
+             "DeviceMemory::Image::{}",
+             desc.debug_name);
+  }
 
-  ctx.update_resources();
+  ctx.update_resources(handle);
 
   if (!desc.pixel_data.empty()) {
     ctx.get_staging_allocator().upload(
@@ -423,7 +480,7 @@ VulkanTextureND::create_image_view(IContext& ctx,
                                    const VkSamplerYcbcrConversionInfo* ycbcr)
   -> VkImageView
 {
-  assert(!name.empty());
+  assert(!names_objects(ctx) || !name.empty());
   const VkImageViewCreateInfo ci = {
     .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
     .pNext = ycbcr,
@@ -467,8 +524,8 @@ VulkanTextureND::get_or_create_image_view_for_framebuffer(IContext& ctx,
       ctx,
       format,
       aspect,
-      std::format(
-        "ImageView::Framebuffer_{}_{}_::{}", level, layer, debug_name),
+      format_debug_name(
+        ctx, "ImageView::Framebuffer_{}_{}_::{}", level, layer, debug_name),
       1);
   }
 
@@ -0,0 +1,53 @@
+#include "sv/worker_pool.hpp"
+
+#include <algorithm>
+
+namespace sv {
+
+WorkerPool::WorkerPool(const std::uint32_t thread_count)
+{
+  threads.reserve(std::max(thread_count, 1U));
+  for (auto i = 0U; i < std::max(thread_count, 1U); ++i) {
+    threads.emplace_back([this](std::stop_token stop) { work(stop); });
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  for (auto& thread : threads) {
+    thread.request_stop();
+  }
+  // Wakes the waiting workers; each drains the queue before returning.
+  available.notify_all();
+  threads.clear();
+}
+
+auto
+WorkerPool::push(std::function<void()>&& job) -> void
+{
+  {
+    std::scoped_lock lock{ mutex };
+    jobs.push_back(std::move(job));
+  }
+  available.notify_one();
+}
+
+auto
+WorkerPool::work(const std::stop_token& stop) -> void
+{
+  for (;;) {
+    std::function<void()> job;
+    {
+      std::unique_lock lock{ mutex };
+      available.wait(lock, stop, [this] { return !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    job();
+  }
+}
+
+}
@@ -0,0 +1,65 @@
+#include "doctest/doctest.h"
+#include "sv/bound_state.hpp"
+
+#include <array>
+#include <bit>
+
+using namespace sv;
+
+TEST_CASE("bound_state_skips_repeated_state")
+{
+  const auto vertices = std::bit_cast<VkBuffer>(std::uintptr_t{ 0x10 });
+  const auto indices = std::bit_cast<VkBuffer>(std::uintptr_t{ 0x20 });
+  const VkViewport viewport{ 0, 0, 640, 480, 1, 0 };
+  const VkRect2D scissor{ { 0, 0 }, { 640, 480 } };
+
+  BoundState bound;
+  for (auto draw = 0; draw < 3; ++draw) {
+    CHECK(bound.vertex_buffer(0, vertices, 0) == (draw == 0));
+    CHECK(bound.index_buffer(indices, 0, VK_INDEX_TYPE_UINT32) ==
+          (draw == 0));
+    CHECK(bound.depth_test(VK_TRUE) == (draw == 0));
+    CHECK(bound.depth_write(VK_TRUE) == (draw == 0));
+    CHECK(bound.viewport(viewport) == (draw == 0));
+    CHECK(bound.scissor(scissor) == (draw == 0));
+  }
+  CHECK(bound.vertex_buffer(0, vertices, 64));
+  CHECK(bound.index_buffer(indices, 0, VK_INDEX_TYPE_UINT16));
+
+  const auto& skipped = bound.get_skipped();
+  CHECK(skipped.vertex_buffers == 2);
+  CHECK(skipped.index_buffers == 2);
+  CHECK(skipped.depth_state == 4);
+  CHECK(skipped.viewports == 2);
+  CHECK(skipped.scissors == 2);
+  CHECK(skipped.total() == 12);
+
+  // A new pass records everything again.
+  bound.begin_pass();
+  CHECK(bound.vertex_buffer(0, vertices, 64));
+  CHECK(bound.depth_test(VK_TRUE));
+  CHECK(bound.viewport(viewport));
+}
+
+TEST_CASE("bound_state_push_constants_follow_the_layout")
+{
+  const auto layout = std::bit_cast<VkPipelineLayout>(std::uintptr_t{ 0x30 });
+  const auto other = std::bit_cast<VkPipelineLayout>(std::uintptr_t{ 0x40 });
+  constexpr VkShaderStageFlags stages = 0x11;
+  const std::array<std::byte, 8> data{ std::byte{ 1 }, std::byte{ 2 } };
+  auto changed = data;
+  changed[7] = std::byte{ 3 };
+
+  BoundState bound;
+  CHECK(bound.graphics_layout(layout));
+  CHECK(bound.push_constants(layout, stages, data));
+  CHECK_FALSE(bound.push_constants(layout, stages, data));
+  CHECK(bound.push_constants(layout, stages, changed));
+
+  // Rebinding the same layout keeps them; another one disturbs them.
+  CHECK_FALSE(bound.graphics_layout(layout));
+  CHECK_FALSE(bound.push_constants(layout, stages, changed));
+  CHECK(bound.graphics_layout(other));
+  CHECK(bound.push_constants(other, stages, changed));
+  CHECK(bound.get_skipped().push_constants == 2);
+}
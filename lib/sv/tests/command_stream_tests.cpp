@@ -0,0 +1,361 @@
+#include "doctest/doctest.h"
+#include "sv/command_stream.hpp"
+#include "sv/null_context.hpp"
+
+#include <array>
+#include <bit>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace sv;
+
+namespace {
+// A live handle, as if a pool had handed it out.
+template<typename H>
+auto
+live(std::uint32_t index) -> H
+{
+  return std::bit_cast<H>(std::array<std::uint32_t, 2>{ index, 1 });
+}
+
+auto
+record_frame(ICommandBuffer& buf) -> void
+{
+  RenderPass pass{};
+  pass.color[0] = { .load_op = LoadOp::Clear };
+  Framebuffer framebuffer{ .debug_name = "GBuffer" };
+  framebuffer.color[0] = live<TextureHandle>(1);
+  Dependencies deps{};
+  deps.textures[0] = live<TextureHandle>(2);
+
+  buf.cmd_begin_rendering(pass, framebuffer, deps);
+  buf.cmd_bind_graphics_pipeline(live<GraphicsPipelineHandle>(3));
+  buf.cmd_bind_viewport({ .width = 640.0F, .height = 480.0F });
+  buf.cmd_bind_vertex_buffer(0, live<BufferHandle>(4), 64);
+  buf.cmd_bind_index_buffer(live<BufferHandle>(5), IndexFormat::UI32, 0);
+  const std::array<std::uint32_t, 3> constants{ 7, 8, 9 };
+  buf.cmd_push_constants(constants, 0);
+  buf.cmd_draw_indexed(36, 1, 0, 0, 0);
+  buf.cmd_draw(3, 1, 0, 0);
+  buf.cmd_end_rendering();
+}
+
+// Writes every call down with its arguments, so a replay that swaps, drops
+// or truncates one no longer matches the calls that were recorded.
+struct CallLog final : ICommandBuffer
+{
+  std::vector<std::string> calls;
+
+  template<typename... Args>
+  auto log(std::string_view name, const Args&... args) -> void
+  {
+    auto& call = calls.emplace_back(name);
+    ((call += std::format(" {}", args)), ...);
+  }
+  template<typename H>
+  static auto id(H handle) -> std::string
+  {
+    return std::format("{}:{}", handle.index(), handle.generation());
+  }
+
+  auto get_command_buffer() const -> VkCommandBuffer override
+  {
+    return VK_NULL_HANDLE;
+  }
+  auto cmd_begin_rendering(const RenderPass& pass,
+                           const Framebuffer& framebuffer,
+                           const Dependencies& deps) -> void override
+  {
+    log("begin_rendering",
+        framebuffer.debug_name,
+        pass.layer_count,
+        pass.view_mask);
+    for (std::uint32_t i = 0; i != pass.get_colour_attachment_count(); i++) {
+      const auto& desc = pass.color[i];
+      log("  colour",
+          std::to_underlying(desc.load_op),
+          std::to_underlying(desc.store_op),
+          desc.level,
+          desc.layer,
+          std::get<std::array<float, 4>>(desc.clear_colour)[0],
+          id(framebuffer.color[i].texture),
+          id(framebuffer.color[i].resolve_texture));
+    }
+    log("  depth",
+        std::to_underlying(pass.depth.load_op),
+        std::to_underlying(pass.depth.store_op),
+        pass.depth.clear_depth,
+        id(framebuffer.depth_stencil.texture));
+    for (const auto texture : deps.textures)
+      log("  texture dependency", id(texture));
+    for (const auto buffer : deps.buffers)
+      log("  buffer dependency", id(buffer));
+  }
+  auto cmd_end_rendering() -> void override { log("end_rendering"); }
+  auto cmd_transition_image(TextureHandle texture, const ImageUsage& usage)
+    -> void override
+  {
+    log("transition_image",
+        id(texture),
+        std::to_underlying(usage.layout),
+        usage.stage,
+        usage.access,
+        usage.discard);
+  }
+  auto cmd_bind_viewport(const Viewport& v) -> void override
+  {
+    log("bind_viewport", v.x, v.y, v.width, v.height, v.minDepth, v.maxDepth);
+  }
+  auto cmd_bind_scissor_rect(const ScissorRect& r) -> void override
+  {
+    log("bind_scissor_rect", r.x, r.y, r.width, r.height);
+  }
+  auto cmd_bind_graphics_pipeline(GraphicsPipelineHandle handle)
+    -> void override
+  {
+    log("bind_graphics_pipeline", id(handle));
+  }
+  auto cmd_bind_compute_pipeline(ComputePipelineHandle handle)
+    -> void override
+  {
+    log("bind_compute_pipeline", id(handle));
+  }
+  auto cmd_bind_depth_state(const DepthState& state) -> void override
+  {
+    log("bind_depth_state",
+        std::to_underlying(state.compare_operation),
+        state.is_depth_test_enabled,
+        state.is_depth_write_enabled);
+  }
+  auto cmd_set_cull_mode(CullMode mode) -> void override
+  {
+    log("set_cull_mode", std::to_underlying(mode));
+  }
+  auto cmd_set_winding(WindingMode mode) -> void override
+  {
+    log("set_winding", std::to_underlying(mode));
+  }
+  auto cmd_set_polygon_mode(PolygonMode mode) -> void override
+  {
+    log("set_polygon_mode", std::to_underlying(mode));
+  }
+  auto cmd_set_blend_state(std::uint32_t attachment,
+                           const ColourAttachment& blend) -> void override
+  {
+    log("set_blend_state",
+        attachment,
+        std::to_underlying(blend.format),
+        blend.blend_enabled,
+        std::to_underlying(blend.rgb_blend_op),
+        std::to_underlying(blend.alpha_blend_op),
+        std::to_underlying(blend.src_rgb_blend_factor),
+        std::to_underlying(blend.src_alpha_blend_factor),
+        std::to_underlying(blend.dst_rgb_blend_factor),
+        std::to_underlying(blend.dst_alpha_blend_factor));
+  }
+  auto cmd_set_colour_write_mask(std::uint32_t attachment,
+                                 ColourWriteMask mask) -> void override
+  {
+    log("set_colour_write_mask", attachment, std::to_underlying(mask));
+  }
+  auto cmd_draw(std::uint32_t vertex_count,
+                std::uint32_t instance_count,
+                std::uint32_t first_vertex,
+                std::uint32_t base_instance) -> void override
+  {
+    log("draw", vertex_count, instance_count, first_vertex, base_instance);
+  }
+  auto cmd_draw_indexed(std::uint32_t index_count,
+                        std::uint32_t instance_count,
+                        std::uint32_t first_index,
+                        std::int32_t vertex_offset,
+                        std::uint32_t base_instance) -> void override
+  {
+    log("draw_indexed",
+        index_count,
+        instance_count,
+        first_index,
+        vertex_offset,
+        base_instance);
+  }
+  auto cmd_draw_indexed_indirect(BufferHandle buffer,
+                                 std::size_t offset,
+                                 std::uint32_t draw_count,
+                                 std::uint32_t stride) -> void override
+  {
+    log("draw_indexed_indirect", id(buffer), offset, draw_count, stride);
+  }
+  auto cmd_draw_indexed_indirect_count(BufferHandle buffer,
+                                       std::size_t offset,
+                                       BufferHandle count_buffer,
+                                       std::size_t count_offset,
+                                       std::uint32_t max_draw_count,
+                                       std::uint32_t stride) -> void override
+  {
+    log("draw_indexed_indirect_count",
+        id(buffer),
+        offset,
+        id(count_buffer),
+        count_offset,
+        max_draw_count,
+        stride);
+  }
+  auto cmd_draw_multi_indexed(std::span<const MultiDrawIndexed> draws,
+                              std::uint32_t instance_count,
+                              std::uint32_t first_instance) -> void override
+  {
+    log("draw_multi_indexed", draws.size(), instance_count, first_instance);
+    for (const auto& draw : draws)
+      log("  draw", draw.first_index, draw.index_count, draw.vertex_offset);
+  }
+  auto cmd_dispatch_thread_groups(const Dimensions& groups) -> void override
+  {
+    log("dispatch_thread_groups", groups.width, groups.height, groups.depth);
+  }
+  auto cmd_push_constants(std::span<const std::byte> data) -> void override
+  {
+    log("push_constants", data.size());
+    for (const auto byte : data)
+      log("  byte", std::to_integer<int>(byte));
+  }
+  auto cmd_bind_index_buffer(BufferHandle buffer,
+                             IndexFormat format,
+                             std::uint64_t offset) -> void override
+  {
+    log("bind_index_buffer", id(buffer), std::to_underlying(format), offset);
+  }
+  auto cmd_bind_vertex_buffer(std::uint32_t index,
+                              BufferHandle buffer,
+                              std::uint64_t offset) -> void override
+  {
+    log("bind_vertex_buffer", index, id(buffer), offset);
+  }
+};
+
+auto
+record_state(ICommandBuffer& buf) -> void
+{
+  buf.cmd_transition_image(live<TextureHandle>(6), dependency_usage);
+  buf.cmd_bind_scissor_rect({ .x = 1, .y = 2, .width = 3, .height = 4 });
+  buf.cmd_bind_depth_state({ .compare_operation = CompareOp::Less,
+                             .is_depth_write_enabled = true });
+  buf.cmd_set_cull_mode(CullMode::Back);
+  buf.cmd_set_winding(WindingMode::CW);
+  buf.cmd_set_polygon_mode(PolygonMode::Line);
+  buf.cmd_set_blend_state(1,
+                          { .format = Format::RGBA_UN8,
+                            .blend_enabled = true,
+                            .src_rgb_blend_factor = BlendFactor::SrcAlpha });
+  buf.cmd_set_colour_write_mask(1, ColourWriteMask::R);
+  buf.cmd_draw_indexed_indirect(live<BufferHandle>(7), 32, 5, 20);
+  buf.cmd_bind_compute_pipeline(live<ComputePipelineHandle>(8));
+  buf.cmd_dispatch_thread_groups({ .width = 8, .height = 4, .depth = 2 });
+}
+
+// What reaches a command buffer when `calls` record straight into it, and
+// when they go through a CommandStream first.
+template<typename F>
+auto
+direct_and_replayed(F&& calls) -> std::pair<CallLog, CallLog>
+{
+  CallLog direct;
+  calls(direct);
+
+  CommandRecorder recorder;
+  calls(recorder);
+  CallLog replayed;
+  recorder.take().replay(replayed);
+  return { std::move(direct), std::move(replayed) };
+}
+}
+
+TEST_CASE("command_recorder_counts_draws_binds_and_transitions")
+{
+  CommandRecorder recorder;
+  record_frame(recorder);
+
+  const auto& counts = recorder.get_stream().get_counts();
+  CHECK(counts.draws() == 2);
+  CHECK(counts.binds() == 4);
+  CHECK(counts[CommandType::PushConstants] == 1);
+  CHECK(counts[CommandType::BeginRendering] == 1);
+  // The colour attachment and the sampled dependency leave UNDEFINED,
+  // together.
+  CHECK(counts.image_barriers == 2);
+  CHECK(counts.barrier_batches == 1);
+
+  const auto stream = recorder.take();
+  CHECK_FALSE(stream.empty());
+  CHECK(recorder.get_stream().empty());
+
+  // Next frame both are already GENERAL: the cleared attachment still needs
+  // its write-after-write barrier, the dependency's read is already visible.
+  record_frame(recorder);
+  const auto& next = recorder.get_stream().get_counts();
+  CHECK(next.image_barriers == 1);
+  CHECK(next.barrier_batches == 1);
+}
+
+TEST_CASE("command_stream_replays_what_was_recorded")
+{
+  const auto [direct, replayed] = direct_and_replayed(record_frame);
+  CHECK(replayed.calls == direct.calls);
+
+  CommandRecorder recorder;
+  record_frame(recorder);
+  const auto stream = recorder.take();
+  CommandRecorder rerecorded;
+  stream.replay(rerecorded);
+  CHECK(rerecorded.get_stream().get_counts().by_type ==
+        stream.get_counts().by_type);
+  CHECK(rerecorded.get_stream().size_bytes() == stream.size_bytes());
+}
+
+TEST_CASE("command_stream_replays_state_commands")
+{
+  const auto [direct, replayed] = direct_and_replayed(record_state);
+  CHECK(direct.calls.size() == 11);
+  CHECK(replayed.calls == direct.calls);
+}
+
+TEST_CASE("command_stream_replays_multi_draws")
+{
+  const std::array draws{
+    MultiDrawIndexed{ .first_index = 0, .index_count = 36 },
+    MultiDrawIndexed{ .first_index = 36, .index_count = 6, .vertex_offset = 8 },
+  };
+  const auto record = [&](ICommandBuffer& buf) {
+    buf.cmd_draw_multi_indexed(draws, 1, 4);
+    buf.cmd_draw_indexed_indirect_count(
+      live<BufferHandle>(1), 8, live<BufferHandle>(2), 16, 128, 20);
+  };
+
+  CommandRecorder recorder;
+  record(recorder);
+  CHECK(recorder.get_stream().get_counts().draws() == 2);
+
+  const auto [direct, replayed] = direct_and_replayed(record);
+  CHECK(replayed.calls == direct.calls);
+}
+
+TEST_CASE("null_context_keeps_submitted_streams")
+{
+  NullContext context;
+  bool deferred = false;
+  context.defer_task([&](IContext&) { deferred = true; });
+
+  for (int frame = 0; frame < 2; ++frame) {
+    auto& buf = context.acquire_command_buffer();
+    record_frame(buf);
+    context.submit(buf, {});
+  }
+
+  CHECK(deferred);
+  CHECK(context.get_submit_count() == 2);
+  CHECK(context.get_last_submitted().get_counts().draws() == 2);
+  CHECK(context.get_submitted_counts().draws() == 4);
+}
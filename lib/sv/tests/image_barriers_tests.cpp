@@ -0,0 +1,91 @@
+#include "doctest/doctest.h"
+#include "sv/image_barriers.hpp"
+
+#include <bit>
+
+using namespace sv;
+
+namespace {
+constexpr ImageUsage colour_attachment{
+  .layout = VK_IMAGE_LAYOUT_GENERAL,
+  .stage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+  .access = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+  .discard = true,
+};
+constexpr ImageUsage sampled{
+  .layout = VK_IMAGE_LAYOUT_GENERAL,
+  .stage = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+  .access = VK_ACCESS_2_SHADER_READ_BIT,
+  .discard = false,
+};
+constexpr VkImageSubresourceRange everything{
+  VK_IMAGE_ASPECT_COLOR_BIT,
+  0,
+  VK_REMAINING_MIP_LEVELS,
+  0,
+  VK_REMAINING_ARRAY_LAYERS,
+};
+}
+
+TEST_CASE("image_barriers_elide_repeated_reads")
+{
+  ImageState state{};
+  const auto first = ImageBarrierBatch::transition(state, colour_attachment);
+  REQUIRE(first);
+  CHECK(first->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+  CHECK(first->newLayout == VK_IMAGE_LAYOUT_GENERAL);
+
+  const auto read = ImageBarrierBatch::transition(state, sampled);
+  REQUIRE(read);
+  CHECK(read->oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+  CHECK(read->srcStageMask == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+  CHECK(read->srcAccessMask == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+  CHECK(read->dstAccessMask == VK_ACCESS_2_SHADER_READ_BIT);
+
+  CHECK_FALSE(ImageBarrierBatch::transition(state, sampled));
+
+  // Writing again waits for the reads, but has no writes to make available.
+  const auto overwrite =
+    ImageBarrierBatch::transition(state, colour_attachment);
+  REQUIRE(overwrite);
+  CHECK(overwrite->srcStageMask == VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+  CHECK(overwrite->srcAccessMask == VK_ACCESS_2_NONE);
+  CHECK(overwrite->oldLayout == VK_IMAGE_LAYOUT_GENERAL);
+}
+
+TEST_CASE("image_barriers_merge_subresources_into_one_barrier")
+{
+  const auto image = std::bit_cast<VkImage>(std::uintptr_t{ 0x10 });
+  const VkImageSubresourceRange one_layer{
+    VK_IMAGE_ASPECT_COLOR_BIT, 2, 1, 3, 1,
+  };
+  ImageStates states{ 4, 6 };
+
+  ImageBarrierBatch render;
+  render.require(image, states, everything, colour_attachment);
+  REQUIRE(render.pending().size() == 1);
+  const auto& range = render.pending().front().subresourceRange;
+  CHECK(range.baseMipLevel == 0);
+  CHECK(range.levelCount == 4);
+  CHECK(range.baseArrayLayer == 0);
+  CHECK(range.layerCount == 6);
+
+  ImageBarrierBatch read;
+  read.require(image, states, one_layer, sampled);
+  CHECK(read.pending().size() == 1);
+
+  // Nothing pending, so flushing records no barrier.
+  ImageBarrierBatch read_again;
+  read_again.require(image, states, one_layer, sampled);
+  CHECK(read_again.pending().empty());
+  BarrierTelemetry telemetry;
+  read_again.flush(VK_NULL_HANDLE, telemetry);
+  CHECK(telemetry.elided == 1);
+  CHECK(telemetry.emitted == 0);
+  CHECK(telemetry.batches == 0);
+
+  // The sampled layer now waits on a different stage, splitting level 2.
+  ImageBarrierBatch overwrite;
+  overwrite.require(image, states, everything, colour_attachment);
+  CHECK(overwrite.pending().size() == 5);
+}
@@ -0,0 +1,90 @@
+#include "doctest/doctest.h"
+#include "sv/shader/include_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace sv;
+
+namespace {
+auto
+write(const std::filesystem::path& path, std::string_view contents) -> void
+{
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream{ path, std::ios::binary | std::ios::trunc } << contents;
+}
+}
+
+TEST_CASE("include_cache_resolves_relative_to_includer_first")
+{
+  const auto root =
+    std::filesystem::temp_directory_path() / "sv_include_cache_tests";
+  std::filesystem::remove_all(root);
+  write(root / "include" / "common.glsl", "// shared");
+  write(root / "effects" / "common.glsl", "// local");
+
+  IncludeCache cache{ root / "include" };
+  const auto includer = root / "effects" / "blur.glsl";
+
+  const auto local = cache.resolve("common.glsl", includer, false);
+  REQUIRE(local);
+  CHECK(local->contents == "// local");
+
+  const auto system = cache.resolve("common.glsl", includer, true);
+  REQUIRE(system);
+  CHECK(system->contents == "// shared");
+
+  CHECK(cache.resolve("common.glsl", includer, true) == system);
+  CHECK_FALSE(cache.resolve("missing.glsl", includer, false));
+
+  std::filesystem::remove_all(root);
+}
+
+TEST_CASE("include_cache_refresh_reports_content_changes")
+{
+  const auto root =
+    std::filesystem::temp_directory_path() / "sv_include_cache_refresh";
+  std::filesystem::remove_all(root);
+  const auto header = root / "ubo.glsl";
+  write(header, "layout(binding = 0) uniform A {};");
+
+  IncludeCache cache{ root };
+  REQUIRE(cache.resolve("ubo.glsl", {}, true));
+
+  // Same bytes, new timestamp: re-read but not a change.
+  std::filesystem::last_write_time(
+    header,
+    std::filesystem::last_write_time(header) + std::chrono::seconds{ 1 });
+  CHECK_FALSE(cache.refresh(header));
+
+  write(header, "layout(binding = 0) uniform B {};");
+  std::filesystem::last_write_time(
+    header,
+    std::filesystem::last_write_time(header) + std::chrono::seconds{ 2 });
+  CHECK(cache.refresh(header));
+  CHECK(cache.resolve("ubo.glsl", {}, true)->contents ==
+        "layout(binding = 0) uniform B {};");
+
+  std::filesystem::remove(header);
+  CHECK(cache.refresh(header));
+  CHECK_FALSE(cache.resolve("ubo.glsl", {}, true));
+
+  std::filesystem::remove_all(root);
+}
+
+TEST_CASE("include_cache_tracks_dependent_shaders")
+{
+  IncludeCache cache{ "include" };
+  cache.add_dependency("a.shader", "include/ubo.glsl");
+  cache.add_dependency("a.shader", "include/math.glsl");
+  cache.add_dependency("b.shader", "include/ubo.glsl");
+
+  CHECK(cache.dependents("include/ubo.glsl").size() == 2);
+  REQUIRE(cache.dependents("include/math.glsl").size() == 1);
+  CHECK(cache.dependents("include/math.glsl").front() ==
+        IncludeCache::key("a.shader"));
+
+  cache.clear_dependencies("a.shader");
+  CHECK(cache.dependents("include/math.glsl").empty());
+  CHECK(cache.dependents("include/ubo.glsl").size() == 1);
+}
@@ -0,0 +1,123 @@
+#include "doctest/doctest.h"
+#include "sv/renderer.hpp"
+
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+using namespace sv;
+
+namespace {
+// ubo.glsl's unpack_snorm_3x10, bitfieldExtract's sign extension included.
+auto
+unpack_snorm_3x10(std::uint32_t v) -> glm::vec3
+{
+  const auto extract = [v](int offset) {
+    const auto bits = static_cast<std::int32_t>((v >> offset) & 0x3FFU);
+    return static_cast<float>(bits >= 512 ? bits - 1024 : bits);
+  };
+  return glm::max(
+    glm::vec3{ extract(0), extract(10), extract(20) } / 511.0F, -1.0F);
+}
+
+// ubo.glsl's instance_normal_matrix.
+auto
+instance_normal_matrix(const InstanceData& d) -> glm::mat3
+{
+  return { unpack_snorm_3x10(d.normal_columns[0]),
+           unpack_snorm_3x10(d.normal_columns[1]),
+           unpack_snorm_3x10(d.normal_columns[2]) };
+}
+
+const std::array normals{
+  glm::vec3{ 1, 0, 0 },  glm::vec3{ 0, 1, 0 },     glm::vec3{ 0, 0, 1 },
+  glm::vec3{ 0, 0, -1 }, glm::vec3{ 1, 1, 1 },     glm::vec3{ -2, 1, 0.5F },
+  glm::vec3{ 0, -3, 1 }, glm::vec3{ 0.2F, 0, -1 },
+};
+
+// What gbuffer_object.glsl computes against the textbook normal matrix; the
+// packed columns cost a little precision but never the direction.
+auto
+check_normals(const glm::mat4& model) -> void
+{
+  const auto data = InstanceData::create(model, 0);
+  const auto packed = instance_normal_matrix(data);
+  const auto reference = glm::transpose(glm::inverse(glm::mat3{ model }));
+  for (std::size_t i = 0; i < normals.size(); ++i) {
+    const auto expected = glm::normalize(reference * normals[i]);
+    const auto actual = glm::normalize(packed * normals[i]);
+    CAPTURE(i);
+    CHECK(glm::dot(expected, actual) > 0.999F);
+  }
+}
+}
+
+TEST_CASE("instance_data_keeps_model_rows")
+{
+  const auto model =
+    glm::translate(glm::mat4{ 1.0F }, glm::vec3{ 1.0F, 2.0F, 3.0F }) *
+    glm::rotate(glm::mat4{ 1.0F }, 0.5F, glm::vec3{ 0.0F, 1.0F, 0.0F });
+  const auto data = InstanceData::create(model, 7);
+  const glm::vec4 p{ 0.25F, -4.0F, 2.0F, 1.0F };
+  const auto expected = model * p;
+  for (auto row = 0; row < 3; ++row)
+    CHECK(glm::dot(data.model_rows[row], p) == doctest::Approx(expected[row]));
+  CHECK(data.material_index == 7);
+}
+
+TEST_CASE("instance_data_normal_matrix_identity")
+{
+  check_normals(glm::mat4{ 1.0F });
+}
+
+TEST_CASE("instance_data_normal_matrix_rotation")
+{
+  check_normals(
+    glm::rotate(glm::mat4{ 1.0F }, 1.1F, glm::normalize(glm::vec3{ 1, 2, 3 })));
+}
+
+TEST_CASE("instance_data_normal_matrix_non_uniform_scale")
+{
+  check_normals(
+    glm::scale(glm::mat4{ 1.0F }, glm::vec3{ 4.0F, 0.5F, 2.0F }) *
+    glm::rotate(glm::mat4{ 1.0F }, 0.7F, glm::vec3{ 0.0F, 0.0F, 1.0F }));
+}
+
+TEST_CASE("instance_data_normal_matrix_mirrored")
+{
+  // A negative determinant; the cofactor matrix alone would point inwards.
+  const auto mirrored =
+    glm::scale(glm::mat4{ 1.0F }, glm::vec3{ -1.0F, 2.0F, 1.0F });
+  REQUIRE(glm::determinant(glm::mat3{ mirrored }) < 0.0F);
+  check_normals(mirrored);
+  check_normals(
+    glm::translate(glm::mat4{ 1.0F }, glm::vec3{ 5.0F, 0.0F, 0.0F }) *
+    glm::scale(glm::mat4{ 1.0F }, glm::vec3{ 3.0F, -0.25F, 2.0F }) *
+    glm::rotate(glm::mat4{ 1.0F }, 0.3F, glm::vec3{ 1.0F, 0.0F, 0.0F }));
+}
+
+TEST_CASE("instance_data_snorm_3x10_round_trip")
+{
+  const std::array values{
+    glm::vec3{ 0.0F, 0.0F, 0.0F },    glm::vec3{ 1.0F, -1.0F, 0.5F },
+    glm::vec3{ -0.25F, 0.75F, -1.0F }, glm::vec3{ 0.001F, -0.999F, 0.3F },
+  };
+  for (std::size_t n = 0; n < values.size(); ++n) {
+    const auto& v = values[n];
+    const auto packed = glm::packSnorm3x10_1x2(glm::vec4{ v, 0.0F });
+    const auto unpacked = unpack_snorm_3x10(packed);
+    CAPTURE(n);
+    for (auto i = 0; i < 3; ++i)
+      CHECK(unpacked[i] == doctest::Approx(v[i]).epsilon(1.0 / 511.0));
+    // And the shader agrees with glm about the packing.
+    const auto glm_unpacked = glm::vec3{ glm::unpackSnorm3x10_1x2(packed) };
+    for (auto i = 0; i < 3; ++i)
+      CHECK(unpacked[i] == doctest::Approx(glm_unpacked[i]));
+  }
+
+  // -512 is the one code below -1; GLSL's snorm unpacking clamps it.
+  CHECK(unpack_snorm_3x10(0x200U).x == -1.0F);
+}
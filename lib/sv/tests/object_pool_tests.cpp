@@ -100,3 +100,34 @@ TEST_CASE("get_returns_null_for_invalid_generation_zero")
   pool.erase(h);
   CHECK(pool.get(h) == nullptr);
 }
+
+TEST_CASE("erase_retained_holds_index_until_recycled")
+{
+  DummyPool<> pool;
+  auto h1 = pool.emplace(1, "a");
+  auto h2 = pool.emplace(2, "b");
+  CHECK(pool.erase_retained(h1));
+  CHECK_FALSE(pool.is_valid(h1));
+  CHECK(pool.is_valid(h2));
+  CHECK(pool.get(h2.index())->v == 2);
+  CHECK(pool.slot_count() == 2);
+
+  auto h3 = pool.emplace(3, "c");
+  CHECK(h3.index() != h1.index());
+  CHECK(pool.slot_count() == 3);
+
+  pool.recycle_index(h1.index());
+  auto h4 = pool.emplace(4, "d");
+  CHECK(h4.index() == h1.index());
+  CHECK(h4.generation() != h1.generation());
+}
+
+TEST_CASE("recycle_index_ignores_live_slots")
+{
+  DummyPool<> pool;
+  auto h1 = pool.emplace(1, "a");
+  pool.recycle_index(h1.index());
+  auto h2 = pool.emplace(2, "b");
+  CHECK(h2.index() != h1.index());
+  CHECK(pool.is_valid(h1));
+}
@@ -0,0 +1,107 @@
+#include "doctest/doctest.h"
+#include "sv/object_pool.hpp"
+#include "sv/pipeline_description_cache.hpp"
+
+#include <array>
+
+using namespace sv;
+
+namespace {
+auto
+opaque(ShaderModuleHandle shader) -> GraphicsPipelineDescription
+{
+  return GraphicsPipelineDescription{
+    .shader = shader,
+    .color = { ColourAttachment{ .format = Format::RGBA_UN8 } },
+    .cull_mode = CullMode::Back,
+    .debug_name = "Opaque",
+  };
+}
+}
+
+TEST_CASE("pipeline_description_cache_shares_equal_descriptions")
+{
+  ShaderModulePool shaders;
+  GraphicsPipelinePool pipelines;
+  PipelineDescriptionCache cache;
+  const auto shader = shaders.insert(VulkanShader{});
+  const auto desc = opaque(shader);
+  CHECK(cache.find(desc).empty());
+
+  const auto h = pipelines.insert(VulkanGraphicsPipeline{});
+  cache.insert(desc, h);
+
+  auto renamed = desc;
+  renamed.debug_name = "Opaque2";
+  CHECK(cache.find(renamed) == h);
+  CHECK(cache.size() == 1);
+
+  auto culled = desc;
+  culled.cull_mode = CullMode::None;
+  CHECK(cache.find(culled).empty());
+
+  auto blended = desc;
+  blended.color[0].blend_enabled = true;
+  CHECK(cache.find(blended).empty());
+}
+
+TEST_CASE("pipeline_description_cache_compares_specialisation_bytes")
+{
+  ShaderModulePool shaders;
+  GraphicsPipelinePool pipelines;
+  PipelineDescriptionCache cache;
+  const auto shader = shaders.insert(VulkanShader{});
+
+  std::array<std::byte, 4> bytes{ std::byte{ 1 } };
+  auto desc = opaque(shader);
+  desc.specialisation_constants.entries[0] = { .constant_id = 0,
+                                               .offset = 0,
+                                               .size = bytes.size() };
+  desc.specialisation_constants.data = bytes;
+
+  const auto h = pipelines.insert(VulkanGraphicsPipeline{});
+  cache.insert(desc, h);
+
+  // The cache keeps its own copy of the constant data.
+  bytes[0] = std::byte{ 2 };
+  CHECK(cache.find(desc).empty());
+  bytes[0] = std::byte{ 1 };
+  CHECK(cache.find(desc) == h);
+}
+
+TEST_CASE("pipeline_description_cache_destroys_on_last_release")
+{
+  ShaderModulePool shaders;
+  GraphicsPipelinePool pipelines;
+  PipelineDescriptionCache cache;
+  const auto desc = opaque(shaders.insert(VulkanShader{}));
+  const auto h = pipelines.insert(VulkanGraphicsPipeline{});
+  cache.insert(desc, h);
+  CHECK(cache.find(desc) == h);
+
+  CHECK_FALSE(cache.release(h));
+  CHECK(cache.release(h));
+  CHECK(cache.size() == 0);
+  CHECK(cache.find(desc).empty());
+}
+
+TEST_CASE("pipeline_description_cache_keys_variants_without_dynamic_state")
+{
+  ShaderModulePool shaders;
+  GraphicsPipelinePool pipelines;
+  PipelineDescriptionCache cache;
+  const auto desc = opaque(shaders.insert(VulkanShader{}));
+  const auto h = pipelines.insert(VulkanGraphicsPipeline{});
+  cache.insert(desc.without_dynamic_state(), h);
+
+  auto transparent = desc;
+  transparent.color[0].blend_enabled = true;
+  transparent.color[0].src_rgb_blend_factor = BlendFactor::SrcAlpha;
+  transparent.cull_mode = CullMode::None;
+  transparent.polygon_mode = PolygonMode::Line;
+  CHECK(cache.find(transparent.without_dynamic_state()) == h);
+
+  auto other_format = desc;
+  other_format.color[0].format = Format::RGBA_F32;
+  CHECK(cache.find(other_format.without_dynamic_state()).empty());
+}
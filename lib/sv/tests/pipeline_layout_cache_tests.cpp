@@ -0,0 +1,57 @@
+#include "doctest/doctest.h"
+#include "sv/pipeline_layout_cache.hpp"
+
+#include <bit>
+
+using namespace sv;
+
+namespace {
+template<typename T>
+auto
+fake_handle(std::uintptr_t value) -> T
+{
+  return std::bit_cast<T>(value);
+}
+}
+
+TEST_CASE("pipeline_layout_cache_shares_layouts_with_equal_keys")
+{
+  PipelineLayoutCache cache;
+  const PipelineLayoutCache::Key key{
+    .set_layout = fake_handle<VkDescriptorSetLayout>(0x10),
+    .stages = VK_SHADER_STAGE_ALL_GRAPHICS,
+    .push_constant_size = 64,
+  };
+  CHECK(cache.find(key) == VK_NULL_HANDLE);
+
+  const auto layout = fake_handle<VkPipelineLayout>(0x20);
+  cache.insert(key, layout);
+  CHECK(cache.find(key) == layout);
+  CHECK(cache.size() == 1);
+
+  auto other = key;
+  other.push_constant_size = 128;
+  CHECK(cache.find(other) == VK_NULL_HANDLE);
+
+  other = key;
+  other.set_layout = fake_handle<VkDescriptorSetLayout>(0x11);
+  CHECK(cache.find(other) == VK_NULL_HANDLE);
+}
+
+TEST_CASE("pipeline_layout_cache_destroys_on_last_release")
+{
+  PipelineLayoutCache cache;
+  const PipelineLayoutCache::Key key{
+    .set_layout = fake_handle<VkDescriptorSetLayout>(0x10),
+    .stages = VK_SHADER_STAGE_COMPUTE_BIT,
+    .push_constant_size = 16,
+  };
+  const auto layout = fake_handle<VkPipelineLayout>(0x20);
+  cache.insert(key, layout);
+  CHECK(cache.find(key) == layout);
+
+  CHECK_FALSE(cache.release(layout));
+  CHECK(cache.release(layout));
+  CHECK(cache.size() == 0);
+  CHECK_FALSE(cache.release(VK_NULL_HANDLE));
+}
@@ -0,0 +1,49 @@
+#include "doctest/doctest.h"
+#include "sv/pipeline_library.hpp"
+
+#include <array>
+#include <bit>
+
+using namespace sv;
+
+namespace {
+auto
+fake_library(std::uintptr_t value) -> VkPipeline
+{
+  return std::bit_cast<VkPipeline>(value);
+}
+}
+
+TEST_CASE("pipeline_library_cache_keeps_first_insert")
+{
+  PipelineLibraryCache cache;
+  using Part = PipelineLibraryCache::Part;
+  CHECK(cache.find(Part::FragmentOutput, "rgba8") == VK_NULL_HANDLE);
+
+  const auto first = fake_library(0x10);
+  CHECK(cache.insert(Part::FragmentOutput, "rgba8", {}, first) == first);
+  CHECK(cache.find(Part::FragmentOutput, "rgba8") == first);
+  CHECK(cache.find(Part::VertexInput, "rgba8") == VK_NULL_HANDLE);
+
+  // A racing compile of the same part gets the cached library back.
+  CHECK(cache.insert(Part::FragmentOutput, "rgba8", {}, fake_library(0x20)) ==
+        first);
+  CHECK(cache.size() == 1);
+}
+
+TEST_CASE("pipeline_library_cache_evicts_by_dependency")
+{
+  PipelineLibraryCache cache;
+  using Part = PipelineLibraryCache::Part;
+  const std::array<std::uint64_t, 2> vertex{ 1, 7 };
+  const std::array<std::uint64_t, 2> fragment{ 2, 7 };
+  cache.insert(Part::PreRasterisation, "vs", vertex, fake_library(0x10));
+  cache.insert(Part::FragmentShader, "fs", fragment, fake_library(0x20));
+  cache.insert(Part::FragmentOutput, "out", {}, fake_library(0x30));
+
+  CHECK(cache.evict(1) == std::vector{ fake_library(0x10) });
+  CHECK(cache.find(Part::PreRasterisation, "vs") == VK_NULL_HANDLE);
+  CHECK(cache.evict(7) == std::vector{ fake_library(0x20) });
+  CHECK(cache.size() == 1);
+  CHECK(cache.clear() == std::vector{ fake_library(0x30) });
+}
@@ -0,0 +1,80 @@
+#include "doctest/doctest.h"
+#include "sv/render_graph_plan.hpp"
+
+#include <array>
+
+using namespace sv;
+
+namespace {
+auto
+transient(VkDeviceSize size) -> PlannedResource
+{
+  return { .imported = false, .requirements = { size, 256, 0b11 } };
+}
+}
+
+TEST_CASE("render_graph_plan_culls_passes_nothing_reads")
+{
+  const GraphResource gbuffer{ 0 };
+  const GraphResource debug_view{ 1 };
+  const GraphResource swapchain{ 2 };
+  const std::array resources{
+    transient(1024),
+    transient(1024),
+    PlannedResource{ .imported = true },
+  };
+  const std::array passes{
+    PlannedPass{ .writes = { gbuffer } },
+    PlannedPass{ .reads = { gbuffer }, .writes = { debug_view } },
+    PlannedPass{ .reads = { gbuffer }, .writes = { swapchain } },
+    PlannedPass{ .writes = { debug_view }, .has_side_effects = true },
+  };
+
+  const auto plan = RenderGraphPlan::build(passes, resources);
+  REQUIRE(plan);
+  CHECK(plan->order == std::vector<std::uint32_t>{ 0, 2, 3 });
+  CHECK(plan->slots[swapchain.get()] == RenderGraphPlan::no_slot);
+  CHECK(plan->lifetimes[gbuffer.get()].first == 0);
+  CHECK(plan->lifetimes[gbuffer.get()].last == 1);
+}
+
+TEST_CASE("render_graph_plan_aliases_disjoint_lifetimes")
+{
+  const GraphResource a{ 0 };
+  const GraphResource b{ 1 };
+  const GraphResource c{ 2 };
+  const GraphResource output{ 3 };
+  const std::array resources{
+    transient(4096),
+    transient(1024),
+    transient(2048),
+    PlannedResource{ .imported = true },
+  };
+  // a is dead once b is written, and b once c is.
+  const std::array passes{
+    PlannedPass{ .writes = { a } },
+    PlannedPass{ .reads = { a }, .writes = { b } },
+    PlannedPass{ .reads = { b }, .writes = { c } },
+    PlannedPass{ .reads = { c }, .writes = { output } },
+  };
+
+  const auto plan = RenderGraphPlan::build(passes, resources);
+  REQUIRE(plan);
+  CHECK(plan->order.size() == 4);
+  // a and c never overlap; b overlaps both.
+  CHECK(plan->slots[a.get()] == plan->slots[c.get()]);
+  CHECK(plan->slots[b.get()] != plan->slots[a.get()]);
+  REQUIRE(plan->memory.size() == 2);
+  CHECK(plan->memory[plan->slots[a.get()]].size == 4096);
+  CHECK(plan->aliased_size() == 4096 + 1024);
+  CHECK(plan->unaliased_size(resources) == 4096 + 1024 + 2048);
+}
+
+TEST_CASE("render_graph_plan_rejects_reads_before_writes")
+{
+  const std::array resources{ transient(64) };
+  const std::array passes{
+    PlannedPass{ .reads = { GraphResource{ 0 } }, .has_side_effects = true },
+  };
+  CHECK_FALSE(RenderGraphPlan::build(passes, resources));
+}
@@ -0,0 +1,77 @@
+#include "doctest/doctest.h"
+#include "sv/object_pool.hpp"
+#include "sv/sampler_cache.hpp"
+
+using namespace sv;
+
+namespace {
+auto
+linear_repeat() -> VkSamplerCreateInfo
+{
+  return VkSamplerCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+    .pNext = nullptr,
+    .flags = 0,
+    .magFilter = VK_FILTER_LINEAR,
+    .minFilter = VK_FILTER_LINEAR,
+    .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+    .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+    .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+    .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+    .mipLodBias = 0.0F,
+    .anisotropyEnable = VK_FALSE,
+    .maxAnisotropy = 0.0F,
+    .compareEnable = VK_FALSE,
+    .compareOp = VK_COMPARE_OP_ALWAYS,
+    .minLod = 0.0F,
+    .maxLod = 1.0F,
+    .borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK,
+    .unnormalizedCoordinates = VK_FALSE,
+  };
+}
+}
+
+TEST_CASE("sampler_cache_returns_shared_handle_for_equal_info")
+{
+  SamplerPool pool;
+  SamplerCache cache;
+  const auto info = linear_repeat();
+  CHECK(cache.find(info).empty());
+
+  const auto h = pool.insert(VkSampler{});
+  cache.insert(info, h);
+  CHECK(cache.find(info) == h);
+  CHECK(cache.size() == 1);
+
+  auto other = info;
+  other.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  CHECK(cache.find(other).empty());
+}
+
+TEST_CASE("sampler_cache_release_is_refcounted")
+{
+  SamplerPool pool;
+  SamplerCache cache;
+  const auto info = linear_repeat();
+  const auto h = pool.insert(VkSampler{});
+  cache.insert(info, h);
+  CHECK(cache.find(info) == h);
+
+  CHECK_FALSE(cache.release(h));
+  CHECK(cache.release(h));
+  CHECK(cache.size() == 0);
+  CHECK(cache.find(info).empty());
+}
+
+TEST_CASE("sampler_cache_skips_chained_create_infos")
+{
+  SamplerPool pool;
+  SamplerCache cache;
+  auto info = linear_repeat();
+  const int chained{};
+  info.pNext = &chained;
+  const auto h = pool.insert(VkSampler{});
+  cache.insert(info, h);
+  CHECK(cache.find(info).empty());
+  CHECK(cache.release(h));
+}
@@ -0,0 +1,100 @@
+#include "doctest/doctest.h"
+#include "sv/shader/include_cache.hpp"
+#include "sv/shader/shader_archive.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace sv;
+
+TEST_CASE("shader_archive_round_trips_entries")
+{
+  const auto directory =
+    std::filesystem::temp_directory_path() / "sv_shader_archive_tests";
+  std::filesystem::remove_all(directory);
+  const auto file = directory / "shaders.svpack";
+
+  ShaderArchive archive;
+  archive.add({
+    .name = "grid.shader",
+    .source_hash = 42,
+    .includes = { { .name = "include/ubo.glsl", .hash = 7 } },
+    .stages = {
+      { .stage = ShaderStage::vertex,
+        .spirv = { 0x03, 0x02, 0x23, 0x07 },
+        .push_constant_size = 16 },
+      { .stage = ShaderStage::fragment,
+        .spirv = { 0x03, 0x02, 0x23, 0x07, 0x00, 0x00, 0x01, 0x00 } },
+    },
+  });
+  archive.add({ .name = "include/blur.glsl", .has_variants = true });
+  REQUIRE(archive.write(file));
+
+  const auto loaded = ShaderArchive::read(file);
+  REQUIRE(loaded.has_value());
+  REQUIRE(loaded->get_entries().size() == 2);
+
+  const auto* grid = loaded->find(directory / "grid.shader");
+  REQUIRE(grid != nullptr);
+  CHECK_FALSE(grid->has_variants);
+  CHECK(grid->source_hash == 42);
+  REQUIRE(grid->includes.size() == 1);
+  CHECK(grid->includes[0].name == "include/ubo.glsl");
+  CHECK(grid->includes[0].hash == 7);
+  REQUIRE(grid->stages.size() == 2);
+  CHECK(grid->stages[0].stage == ShaderStage::vertex);
+  CHECK(grid->stages[0].entry_name == "main");
+  CHECK(grid->stages[0].push_constant_size == 16);
+  CHECK(grid->stages[1].spirv.size() == 8);
+
+  const auto* blur = loaded->find(directory / "include" / ".." / "include" /
+                                  "blur.glsl");
+  REQUIRE(blur != nullptr);
+  CHECK(blur->has_variants);
+  CHECK(loaded->find(directory / "missing.shader") == nullptr);
+
+  std::ofstream{ file, std::ios::binary | std::ios::trunc } << "SVSA";
+  CHECK_FALSE(ShaderArchive::read(file).has_value());
+  CHECK_FALSE(ShaderArchive::read(directory / "absent.svpack").has_value());
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("shader_archive_rejects_entries_with_edited_sources")
+{
+  const auto directory =
+    std::filesystem::temp_directory_path() / "sv_shader_archive_stale_tests";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory / "include");
+  const auto write = [](const std::filesystem::path& file,
+                        std::string_view contents) {
+    std::ofstream{ file, std::ios::binary | std::ios::trunc } << contents;
+  };
+  write(directory / "grid.shader", "#include <ubo.glsl>\n");
+  write(directory / "include" / "ubo.glsl", "layout(set = 0) uniform A;\n");
+
+  IncludeCache includes{ directory / "include" };
+  const auto source = includes.get(directory / "grid.shader");
+  const auto ubo = includes.get(directory / "include" / "ubo.glsl");
+  REQUIRE(source != nullptr);
+  REQUIRE(ubo != nullptr);
+
+  ShaderArchive archive{ directory };
+  archive.add({
+    .name = "grid.shader",
+    .source_hash = source->hash,
+    .includes = { { .name = "include/ubo.glsl", .hash = ubo->hash } },
+  });
+  const auto* entry = archive.find(directory / "grid.shader");
+  REQUIRE(entry != nullptr);
+  CHECK(archive.is_current(*entry, includes));
+
+  write(directory / "include" / "ubo.glsl", "layout(set = 1) uniform Changed;\n");
+  includes.refresh(directory / "include" / "ubo.glsl");
+  CHECK_FALSE(archive.is_current(*entry, includes));
+
+  std::filesystem::remove(directory / "include" / "ubo.glsl");
+  CHECK_FALSE(archive.is_current(*entry, includes));
+
+  std::filesystem::remove_all(directory);
+}
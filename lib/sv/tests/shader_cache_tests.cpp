@@ -0,0 +1,50 @@
+#include "doctest/doctest.h"
+#include "sv/shader/shader_cache.hpp"
+
+#include <filesystem>
+
+using namespace sv;
+
+TEST_CASE("shader_cache_key_covers_source_stage_and_compiler")
+{
+  const auto key =
+    ShaderCache::make_key("void main(){}", ShaderStage::vertex, "a");
+  CHECK(key ==
+        ShaderCache::make_key("void main(){}", ShaderStage::vertex, "a"));
+  CHECK(key !=
+        ShaderCache::make_key("void main(){ }", ShaderStage::vertex, "a"));
+  CHECK(key !=
+        ShaderCache::make_key("void main(){}", ShaderStage::fragment, "a"));
+  CHECK(key !=
+        ShaderCache::make_key("void main(){}", ShaderStage::vertex, "b"));
+}
+
+TEST_CASE("shader_cache_round_trips_stages_on_disk")
+{
+  const auto directory =
+    std::filesystem::temp_directory_path() / "sv_shader_cache_tests";
+  std::filesystem::remove_all(directory);
+
+  const ShaderCache::Stage stage{
+    .spirv = { 0x03, 0x02, 0x23, 0x07, 0x00, 0x00, 0x01, 0x00 },
+    .push_constant_size = 64,
+  };
+  {
+    ShaderCache cache{ directory };
+    CHECK_FALSE(cache.load(1).has_value());
+    CHECK(cache.store(1, stage));
+  }
+
+  ShaderCache cache{ directory };
+  const auto loaded = cache.load(1);
+  REQUIRE(loaded.has_value());
+  CHECK(loaded->spirv == stage.spirv);
+  CHECK(loaded->push_constant_size == 64);
+  CHECK_FALSE(cache.load(2).has_value());
+
+  ShaderCache disabled{ {} };
+  CHECK_FALSE(disabled.store(1, stage));
+  CHECK_FALSE(disabled.load(1).has_value());
+
+  std::filesystem::remove_all(directory);
+}
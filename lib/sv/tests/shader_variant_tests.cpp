@@ -0,0 +1,60 @@
+#include "doctest/doctest.h"
+#include "sv/shader/compilation.hpp"
+
+using namespace sv;
+
+namespace {
+constexpr std::string_view source = R"(#pragma variant ALPHA_TEST : 0, 1
+#pragma variant CASCADES : 4, 2, 1
+
+#pragma stage : vertex
+void main() {}
+
+#pragma stage : fragment
+#if ALPHA_TEST
+#endif
+void main() {}
+)";
+}
+
+TEST_CASE("shader_parser_reads_variant_declarations")
+{
+  const auto parsed = ShaderParser::parse(source);
+  REQUIRE(parsed.has_value());
+  REQUIRE(parsed->variants.size() == 2);
+  CHECK(parsed->variants[0].name == "ALPHA_TEST");
+  CHECK(parsed->variants[0].values == std::vector<std::string>{ "0", "1" });
+  CHECK(parsed->variants[1].values ==
+        std::vector<std::string>{ "4", "2", "1" });
+  REQUIRE(parsed->entries.size() == 2);
+  CHECK(parsed->entries[0].source_code == "void main() {}");
+
+  CHECK_FALSE(ShaderParser::parse("#pragma variant A\n#pragma stage : vertex\n")
+                .has_value());
+  CHECK_FALSE(ShaderParser::parse("#pragma variant A : 0, 0\n"
+                                  "#pragma stage : vertex\n")
+                .has_value());
+  CHECK_FALSE(ShaderParser::parse("#pragma variant A : 0\n"
+                                  "#pragma variant A : 1\n"
+                                  "#pragma stage : vertex\n")
+                .has_value());
+}
+
+TEST_CASE("shader_parser_normalises_variant_keys")
+{
+  auto parsed = ShaderParser::parse(source);
+  REQUIRE(parsed.has_value());
+
+  CHECK(ShaderParser::select_variant(*parsed, "").value() ==
+        "ALPHA_TEST=0,CASCADES=4");
+  CHECK(ShaderParser::select_variant(*parsed, "CASCADES=2, ALPHA_TEST=1")
+          .value() == "ALPHA_TEST=1,CASCADES=2");
+  CHECK_FALSE(ShaderParser::select_variant(*parsed, "CASCADES=3").has_value());
+  CHECK_FALSE(ShaderParser::select_variant(*parsed, "SHADOW=1").has_value());
+  CHECK_FALSE(
+    ShaderParser::select_variant(*parsed, "CASCADES=2,CASCADES=1").has_value());
+
+  ShaderParser::define_variant(*parsed, "ALPHA_TEST=1,CASCADES=2");
+  CHECK(parsed->entries[1].source_code.starts_with(
+    "#define ALPHA_TEST 1\n#define CASCADES 2\n#if ALPHA_TEST"));
+}
@@ -0,0 +1,49 @@
+#include "doctest/doctest.h"
+#include "sv/worker_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+using namespace sv;
+
+TEST_CASE("worker_pool_runs_every_job_on_its_own_threads")
+{
+  WorkerPool pool{ 2 };
+  CHECK(pool.thread_count() == 2);
+
+  std::vector<std::future<std::thread::id>> futures;
+  for (auto i = 0; i < 64; ++i) {
+    futures.push_back(pool.submit([] { return std::this_thread::get_id(); }));
+  }
+
+  std::vector<std::thread::id> ids;
+  for (auto& future : futures) {
+    const auto id = future.get();
+    CHECK(id != std::this_thread::get_id());
+    if (std::ranges::find(ids, id) == ids.end()) {
+      ids.push_back(id);
+    }
+  }
+  CHECK(ids.size() <= 2);
+}
+
+TEST_CASE("worker_pool_finishes_queued_jobs_on_destruction")
+{
+  std::atomic<int> ran{ 0 };
+  std::vector<std::future<int>> futures;
+  {
+    WorkerPool pool{ 1 };
+    for (auto i = 0; i < 16; ++i) {
+      futures.push_back(pool.submit([&ran, i] {
+        ran++;
+        return i;
+      }));
+    }
+  }
+  CHECK(ran == 16);
+  for (auto i = 0; i < 16; ++i) {
+    CHECK(futures[static_cast<std::size_t>(i)].get() == i);
+  }
+}
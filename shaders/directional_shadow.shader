@@ -21,9 +21,9 @@ layout(buffer_reference) readonly buffer ShadowUboRef
 
 struct InstanceData
 {
-  mat4 model;
+  vec4 model_rows[3];
+  uint normal_columns[3];
   uint material_index;
-  uint pad0, pad1, pad2;
 };
 layout(buffer_reference, std430) readonly buffer InstancesRef
 {
@@ -42,9 +42,13 @@ pc;
 void
 main()
 {
-  uint idx = gl_BaseInstance + gl_InstanceIndex;
-  InstanceData d = pc.instances.data[idx];
-  vec4 wp = d.model * vec4(in_pos, 1.0);
+  // Includes the draw's firstInstance.
+  InstanceData d = pc.instances.data[gl_InstanceIndex];
+  vec4 p = vec4(in_pos, 1.0);
+  vec4 wp = vec4(dot(d.model_rows[0], p),
+                 dot(d.model_rows[1], p),
+                 dot(d.model_rows[2], p),
+                 1.0);
   gl_Position = pc.ubo.cascades[pc.cascade_index].vp * wp;
 }
 
@@ -17,23 +17,27 @@ layout(push_constant) uniform PC
 {
   UboRef ubo;
   InstancesRef instances;
+  DrawMaterialsRef draw_materials;
+  uint first_command; // gl_DrawID is relative to it
+  uint _pad;
 }
 pc;
 
 void
 main()
 {
-  uint idx = gl_BaseInstance + gl_InstanceIndex;
-  InstanceData d = pc.instances.data[idx];
+  // Includes the draw's firstInstance.
+  InstanceData d = pc.instances.data[gl_InstanceIndex];
 
-  vec4 wp = d.model * vec4(in_pos, 1.0);
+  vec4 wp = vec4(instance_world_position(d, in_pos), 1.0);
   v_world_pos = wp.xyz;
 
-  mat3 nrm_m = mat3(transpose(inverse(d.model)));
-  v_world_nrm = normalize(nrm_m * in_normals.xyz);
+  v_world_nrm = normalize(instance_normal_matrix(d) * in_normals.xyz);
 
   v_uv = in_tex_coords.xy;
-  v_material_index = d.material_index;
+  v_material_index =
+    d.material_index +
+    pc.draw_materials.material_index[pc.first_command + gl_DrawID];
 
   gl_Position = pc.ubo.u.view_proj * wp;
 }
@@ -55,6 +59,9 @@ layout(push_constant) uniform PC
 {
   UboRef ubo;
   InstancesRef instances;
+  DrawMaterialsRef draw_materials;
+  uint first_command; // gl_DrawID is relative to it
+  uint _pad;
 }
 pc;
 
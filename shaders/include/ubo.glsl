@@ -20,9 +20,9 @@ layout(buffer_reference, std430) readonly buffer UboRef
 
 struct InstanceData
 {
-  mat4 model;
+  vec4 model_rows[3];
+  uint normal_columns[3]; // A2B10G10R10 snorm, scaled to fit
   uint material_index;
-  uint pad0, pad1, pad2;
 };
 
 layout(buffer_reference, std430) readonly buffer InstancesRef
@@ -30,4 +30,37 @@ layout(buffer_reference, std430) readonly buffer InstancesRef
   InstanceData data[];
 };
 
+// Per indirect command: the file material index of the submesh it draws.
+layout(buffer_reference, std430) readonly buffer DrawMaterialsRef
+{
+  uint material_index[];
+};
+
+vec3
+instance_world_position(InstanceData d, vec3 p)
+{
+  vec4 h = vec4(p, 1.0);
+  return vec3(dot(d.model_rows[0], h),
+              dot(d.model_rows[1], h),
+              dot(d.model_rows[2], h));
+}
+
+vec3
+unpack_snorm_3x10(uint v)
+{
+  ivec3 bits = ivec3(bitfieldExtract(int(v), 0, 10),
+                     bitfieldExtract(int(v), 10, 10),
+                     bitfieldExtract(int(v), 20, 10));
+  return max(vec3(bits) / 511.0, -1.0);
+}
+
+// Scaled, so normalise what it transforms.
+mat3
+instance_normal_matrix(InstanceData d)
+{
+  return mat3(unpack_snorm_3x10(d.normal_columns[0]),
+              unpack_snorm_3x10(d.normal_columns[1]),
+              unpack_snorm_3x10(d.normal_columns[2]));
+}
+
 #endif
\ No newline at end of file
@@ -218,6 +218,7 @@ run(std::span<const std::string_view> args)
   auto maybe_ctx = VulkanContext::create(app.get_window(),
                                          {
                                            .abort_on_validation_error = false,
+                                           .hot_reload_shaders = true,
                                          });
   if (!maybe_ctx)
     return 1;
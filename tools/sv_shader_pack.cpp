@@ -0,0 +1,72 @@
+// Compiles every shader file directly under a directory into the
+// ShaderArchive VulkanShader::create loads before touching GLSL:
+//
+//   sv_shader_pack <shader directory> <archive> [SPIR-V cache directory]
+//
+// Uses the runtime's parser, preamble and glslang settings, so the packed
+// SPIR-V is what the application would otherwise compile at startup.
+
+#include "sv/shader/include_cache.hpp"
+#include "sv/shader/shader.hpp"
+#include "sv/shader/shader_archive.hpp"
+#include "sv/shader/shader_cache.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <vector>
+
+int
+main(int argc, char** argv)
+{
+  if (argc < 3) {
+    std::cerr << std::format(
+      "usage: {} <shader directory> <archive> [cache directory]\n", argv[0]);
+    return 2;
+  }
+
+  const std::filesystem::path directory{ argv[1] };
+  const std::filesystem::path output{ argv[2] };
+
+  std::vector<std::filesystem::path> files;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+    const auto extension = entry.path().extension();
+    if (entry.is_regular_file() &&
+        (extension == ".glsl" || extension == ".shader")) {
+      files.push_back(entry.path());
+    }
+  }
+  if (ec) {
+    std::cerr << std::format(
+      "Could not read {}: {}\n", directory.string(), ec.message());
+    return 1;
+  }
+  std::ranges::sort(files);
+
+  sv::ShaderCache cache{ argc > 3 ? std::filesystem::path{ argv[3] }
+                                  : std::filesystem::path{} };
+  sv::IncludeCache includes{ directory / "include" };
+  sv::ShaderArchive archive;
+  auto failed = false;
+  for (const auto& file : files) {
+    auto entry =
+      sv::VulkanShader::compile_offline(file, directory, cache, includes);
+    if (!entry) {
+      std::cerr << std::format("File {} - ", file.filename().string())
+                << entry.error().error << "\n";
+      failed = true;
+      continue;
+    }
+    archive.add(std::move(*entry));
+  }
+
+  if (failed || !archive.write(output)) {
+    std::filesystem::remove(output, ec);
+    return 1;
+  }
+  std::cout << std::format(
+    "Packed {} shaders into {}\n", files.size(), output.string());
+  return 0;
+}